@@ -0,0 +1,145 @@
+#define _GNU_SOURCE // for pthread_rwlockattr_setkind_np of glibc.
+#include <stdlib.h>
+#include <stdbool.h>
+#include "ConcurrentRBTree.h"
+
+
+/**
+ * initialize a reader-writer lock. the default lock of glibc prefers readers, so with many readers a writer may
+ * wait forever; with glibc the lock is made to prefer a waiting writer (other systems keep their default).
+ * @return: true on success, false on failure.
+ */
+bool initWriterPreferringLock(pthread_rwlock_t *lock)
+{
+#ifdef __GLIBC__
+    pthread_rwlockattr_t attributes;
+    if (pthread_rwlockattr_init(&attributes) != 0)
+    {
+        return false;
+    }
+    bool initialized = pthread_rwlockattr_setkind_np(&attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP) == 0 &&
+                       pthread_rwlock_init(lock, &attributes) == 0;
+    pthread_rwlockattr_destroy(&attributes);
+    return initialized;
+#else
+    return pthread_rwlock_init(lock, NULL) == 0;
+#endif
+}
+
+
+/**
+ * constructs a new ConcurrentRBTree with the given CompareFunc.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free the items of the tree.
+ * @return: the new tree, NULL on failure.
+ */
+ConcurrentRBTree *newConcurrentRBTree(CompareFunc compFunc, FreeFunc freeFunc)
+{
+    ConcurrentRBTree *tree = (ConcurrentRBTree *) malloc(sizeof(ConcurrentRBTree));
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    if ((tree->tree = newRBTree(compFunc, freeFunc)) == NULL)
+    {
+        free(tree);
+        return NULL;
+    }
+    if (!initWriterPreferringLock(&tree->lock))
+    {
+        freeRBTree(&tree->tree);
+        free(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+
+/**
+ * add an item to the tree, exclusively.
+ * @param tree: the tree to add an item to.
+ * @param data: item to add to the tree.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToConcurrentRBTree(ConcurrentRBTree *tree, void *data)
+{
+    if (tree == NULL || pthread_rwlock_wrlock(&tree->lock) != 0)
+    {
+        return false;
+    }
+    int result = insertToRBTree(tree->tree, data);
+    pthread_rwlock_unlock(&tree->lock);
+    return result;
+}
+
+
+/**
+ * remove an item from the tree, exclusively.
+ * @param tree: the tree to remove an item from.
+ * @param data: item to remove from the tree.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromConcurrentRBTree(ConcurrentRBTree *tree, void *data)
+{
+    if (tree == NULL || pthread_rwlock_wrlock(&tree->lock) != 0)
+    {
+        return false;
+    }
+    int result = deleteFromRBTree(tree->tree, data);
+    pthread_rwlock_unlock(&tree->lock);
+    return result;
+}
+
+
+/**
+ * check whether the tree contains this item, in parallel with other readers.
+ * @param tree: the tree to check an item in.
+ * @param data: item to check.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int ConcurrentRBTreeContains(ConcurrentRBTree *tree, const void *data)
+{
+    if (tree == NULL || pthread_rwlock_rdlock(&tree->lock) != 0)
+    {
+        return false;
+    }
+    int result = RBTreeContains(tree->tree, data);
+    pthread_rwlock_unlock(&tree->lock);
+    return result;
+}
+
+
+/**
+ * Activate a function on each item of the tree in ascending order, in parallel with other readers.
+ * @param tree: the tree with all the items.
+ * @param func: the function to activate on all items.
+ * @param args: more optional arguments to the function.
+ * @return: 0 on failure, other on success.
+ */
+int forEachConcurrentRBTree(ConcurrentRBTree *tree, forEachFunc func, void *args)
+{
+    if (tree == NULL || pthread_rwlock_rdlock(&tree->lock) != 0)
+    {
+        return false;
+    }
+    int result = forEachRBTree(tree->tree, func, args);
+    pthread_rwlock_unlock(&tree->lock);
+    return result;
+}
+
+
+/**
+ * free all memory of the data structure.
+ * @param tree: pointer to the tree to free.
+ */
+void freeConcurrentRBTree(ConcurrentRBTree **tree)
+{
+    if (tree == NULL || (*tree) == NULL)
+    {
+        return;
+    }
+    freeRBTree(&(*tree)->tree);
+    pthread_rwlock_destroy(&(*tree)->lock);
+    free(*tree);
+    (*tree) = NULL;
+}
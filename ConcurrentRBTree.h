@@ -0,0 +1,58 @@
+#ifndef RBTREE_CONCURRENTRBTREE_H
+#define RBTREE_CONCURRENTRBTREE_H
+
+#include <pthread.h>
+#include "RBTree.h"
+
+/**
+ * an RBTree that many threads can use at once. lookups and traversals take a shared (read) lock, so
+ * they run in parallel and do not block each other; inserts and deletes take the exclusive (write) lock,
+ * so they are serialized. with glibc a waiting writer is preferred over new readers, so a steady stream of
+ * lookups does not starve the writer.
+ */
+typedef struct ConcurrentRBTree
+{
+	RBTree *tree;
+	pthread_rwlock_t lock;
+} ConcurrentRBTree;
+
+/**
+ * constructs a new ConcurrentRBTree with the given CompareFunc.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free the items of the tree.
+ * @return: the new tree, NULL on failure.
+ */
+ConcurrentRBTree *newConcurrentRBTree(CompareFunc compFunc, FreeFunc freeFunc);
+
+/**
+ * add an item to the tree, exclusively.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToConcurrentRBTree(ConcurrentRBTree *tree, void *data);
+
+/**
+ * remove an item from the tree, exclusively.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromConcurrentRBTree(ConcurrentRBTree *tree, void *data);
+
+/**
+ * check whether the tree contains this item, in parallel with other readers.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int ConcurrentRBTreeContains(ConcurrentRBTree *tree, const void *data);
+
+/**
+ * Activate a function on each item of the tree in ascending order, in parallel with other readers.
+ * writers wait until the traversal ends, so func must not change the tree.
+ * @return: 0 on failure, other on success.
+ */
+int forEachConcurrentRBTree(ConcurrentRBTree *tree, forEachFunc func, void *args);
+
+/**
+ * free all memory of the data structure. no other thread may use the tree any more.
+ * @param tree: pointer to the tree to free.
+ */
+void freeConcurrentRBTree(ConcurrentRBTree **tree);
+
+#endif //RBTREE_CONCURRENTRBTREE_H
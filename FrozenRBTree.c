@@ -0,0 +1,230 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdbool.h>
+#include "FrozenRBTree.h"
+
+/**
+ * number of items of a frozen tree in a cache line.
+ */
+#define ITEMS_PER_LINE (FROZEN_ALIGNMENT / sizeof(void *))
+
+
+/**
+ * @return: the index of the smallest item of the sub tree of index k, in a frozen tree of size items.
+ */
+size_t leftmostIndex(size_t k, size_t size)
+{
+    while (2 * k <= size)
+    {
+        k = 2 * k;
+    }
+    return k;
+}
+
+
+/**
+ * @return: the index of the item after the item of index k in ascending order, 0 if it is the last one.
+ */
+size_t nextIndex(size_t k, size_t size)
+{
+    if (2 * k + 1 <= size)
+    {
+        return leftmostIndex(2 * k + 1, size);
+    }
+    while (k & 1) // climb up while k is a right child.
+    {
+        k >>= 1;
+    }
+    return k >> 1;
+}
+
+
+/**
+ * the state of freezeRBTree while it places the items.
+ */
+typedef struct FreezeState
+{
+    void **items;
+    size_t index, size;
+} FreezeState;
+
+
+/**
+ * ForEach function of freezeRBTree: place the next item in ascending order.
+ */
+int placeItem(const void *data, void *pState)
+{
+    FreezeState *state = (FreezeState *) pState;
+    if (state->index == 0)
+    {
+        return false;
+    }
+    state->items[state->index] = (void *) data;
+    state->index = nextIndex(state->index, state->size);
+    return true;
+}
+
+
+/**
+ * make a frozen copy of the order of the items of a tree, in O(n).
+ * @param tree: the tree to freeze.
+ * @return: the frozen tree, NULL on failure.
+ */
+FrozenRBTree *freezeRBTree(const RBTree *tree)
+{
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    FrozenRBTree *frozen = (FrozenRBTree *) malloc(sizeof(FrozenRBTree));
+    if (frozen == NULL)
+    {
+        return NULL;
+    }
+    frozen->size = tree->size;
+    frozen->compFunc = tree->compFunc;
+    void *items = NULL;
+    if (posix_memalign(&items, FROZEN_ALIGNMENT, (frozen->size + 1) * sizeof(void *)) != 0)
+    {
+        free(frozen);
+        return NULL;
+    }
+    frozen->items = (void **) items;
+    FreezeState state = {frozen->items, leftmostIndex(1, frozen->size), frozen->size};
+    if (frozen->size > 0 && !forEachRBTree(tree, placeItem, &state))
+    {
+        freeFrozenRBTree(&frozen);
+        return NULL;
+    }
+    return frozen;
+}
+
+
+/**
+ * @return: the index of the first item of tree that is not smaller than data, 0 if there is none.
+ */
+size_t lowerBoundIndex(const FrozenRBTree *tree, const void *data)
+{
+    size_t k = 1;
+    while (k <= tree->size)
+    {
+        __builtin_prefetch(tree->items + ITEMS_PER_LINE * k);
+        k = 2 * k + (tree->compFunc(tree->items[k], data) < 0);
+    }
+    // the last step to the left is the lower bound: drop the steps to the right after it, and then it.
+    while (k & 1)
+    {
+        k >>= 1;
+    }
+    return k >> 1;
+}
+
+
+/**
+ * check whether the frozen tree contains this item.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int FrozenRBTreeContains(const FrozenRBTree *tree, const void *data)
+{
+    if (tree == NULL || data == NULL)
+    {
+        return false;
+    }
+    size_t k = lowerBoundIndex(tree, data);
+    return k != 0 && tree->compFunc(tree->items[k], data) == 0;
+}
+
+
+/**
+ * place iterator at the first item of tree that is not smaller than data (lower bound).
+ * @return: 0 if there is no such item (the iterator is invalid), other otherwise.
+ */
+int FrozenRBTreeLowerBound(const FrozenRBTree *tree, const void *data, FrozenIterator *iterator)
+{
+    if (iterator == NULL)
+    {
+        return false;
+    }
+    iterator->tree = tree;
+    iterator->index = (tree == NULL || data == NULL) ? 0 : lowerBoundIndex(tree, data);
+    return iterator->index != 0;
+}
+
+
+/**
+ * place iterator at the smallest item of tree.
+ * @return: 0 if the tree is empty (the iterator is invalid), other otherwise.
+ */
+int FrozenRBTreeBegin(const FrozenRBTree *tree, FrozenIterator *iterator)
+{
+    if (iterator == NULL)
+    {
+        return false;
+    }
+    iterator->tree = tree;
+    iterator->index = (tree == NULL || tree->size == 0) ? 0 : leftmostIndex(1, tree->size);
+    return iterator->index != 0;
+}
+
+
+/**
+ * move iterator to the next item in ascending order.
+ * @return: 0 if there is no next item (the iterator becomes invalid), other otherwise.
+ */
+int FrozenIteratorNext(FrozenIterator *iterator)
+{
+    if (iterator == NULL || iterator->index == 0)
+    {
+        return false;
+    }
+    iterator->index = nextIndex(iterator->index, iterator->tree->size);
+    return iterator->index != 0;
+}
+
+
+/**
+ * @return: the item iterator points at, NULL if the iterator is invalid.
+ */
+void *FrozenIteratorData(const FrozenIterator *iterator)
+{
+    return (iterator == NULL || iterator->index == 0) ? NULL : iterator->tree->items[iterator->index];
+}
+
+
+/**
+ * Activate a function on each item of the frozen tree in ascending order. if one of the activations of the
+ * function returns 0, the process stops.
+ * @return: 0 on failure, other on success.
+ */
+int forEachFrozenRBTree(const FrozenRBTree *tree, forEachFunc func, void *args)
+{
+    if (tree == NULL || func == NULL)
+    {
+        return false;
+    }
+    FrozenIterator iterator;
+    for (int valid = FrozenRBTreeBegin(tree, &iterator); valid; valid = FrozenIteratorNext(&iterator))
+    {
+        if (!func(FrozenIteratorData(&iterator), args))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * free the frozen tree (not its items, which belong to the RBTree).
+ * @param tree: pointer to the tree to free.
+ */
+void freeFrozenRBTree(FrozenRBTree **tree)
+{
+    if (tree == NULL || (*tree) == NULL)
+    {
+        return;
+    }
+    free((*tree)->items);
+    free(*tree);
+    (*tree) = NULL;
+}
@@ -0,0 +1,84 @@
+#ifndef RBTREE_FROZENRBTREE_H
+#define RBTREE_FROZENRBTREE_H
+
+#include <stddef.h>
+#include "RBTree.h"
+
+/**
+ * the alignment of the array of a frozen tree (a cache line).
+ */
+#define FROZEN_ALIGNMENT 64
+
+/**
+ * an immutable search structure over the items of an RBTree, made by freezeRBTree. the items are kept in one
+ * array in Eytzinger (breadth first) order: the children of items[k] are items[2k] and items[2k + 1], so a search
+ * reads the array from its start downwards, and the next levels of the search are prefetched together (the 8
+ * descendants 3 levels below items[k] share a cache line). the items still belong to the RBTree, which must not
+ * change or be freed while the frozen tree is used.
+ */
+typedef struct FrozenRBTree
+{
+	void **items; // items[1] to items[size], items[0] is not used.
+	size_t size;
+	CompareFunc compFunc;
+} FrozenRBTree;
+
+/**
+ * a cursor on the items of a frozen tree, in ascending order.
+ */
+typedef struct FrozenIterator
+{
+	const FrozenRBTree *tree;
+	size_t index; // 0 if the iterator is invalid.
+} FrozenIterator;
+
+/**
+ * make a frozen copy of the order of the items of a tree, in O(n).
+ * @param tree: the tree to freeze.
+ * @return: the frozen tree, NULL on failure.
+ */
+FrozenRBTree *freezeRBTree(const RBTree *tree);
+
+/**
+ * check whether the frozen tree contains this item.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int FrozenRBTreeContains(const FrozenRBTree *tree, const void *data);
+
+/**
+ * place iterator at the first item of tree that is not smaller than data (lower bound).
+ * @return: 0 if there is no such item (the iterator is invalid), other otherwise.
+ */
+int FrozenRBTreeLowerBound(const FrozenRBTree *tree, const void *data, FrozenIterator *iterator);
+
+/**
+ * place iterator at the smallest item of tree.
+ * @return: 0 if the tree is empty (the iterator is invalid), other otherwise.
+ */
+int FrozenRBTreeBegin(const FrozenRBTree *tree, FrozenIterator *iterator);
+
+/**
+ * move iterator to the next item in ascending order.
+ * @return: 0 if there is no next item (the iterator becomes invalid), other otherwise.
+ */
+int FrozenIteratorNext(FrozenIterator *iterator);
+
+/**
+ * @return: the item iterator points at, NULL if the iterator is invalid.
+ */
+void *FrozenIteratorData(const FrozenIterator *iterator);
+
+/**
+ * Activate a function on each item of the frozen tree in ascending order. if one of the activations of the
+ * function returns 0, the process stops.
+ * @return: 0 on failure, other on success.
+ */
+int forEachFrozenRBTree(const FrozenRBTree *tree, forEachFunc func, void *args);
+
+/**
+ * free the frozen tree (not its items, which belong to the RBTree).
+ * @param tree: pointer to the tree to free.
+ */
+void freeFrozenRBTree(FrozenRBTree **tree);
+
+#endif //RBTREE_FROZENRBTREE_H
@@ -0,0 +1,404 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "MappedRBTree.h"
+
+
+/**
+ * the state of saveRBTree while it writes the items.
+ */
+typedef struct SaveState
+{
+    FILE *file;
+    MappedKind kind;
+    uint64_t *offsets;
+    size_t count;
+    uint64_t position; // the offset in the file of the next item.
+} SaveState;
+
+
+/**
+ * ForEach function of saveRBTree: write one item and keep its offset.
+ */
+int saveItem(const void *data, void *pState)
+{
+    SaveState *state = (SaveState *) pState;
+    state->offsets[state->count++] = state->position;
+    if (state->kind == MAPPED_STRINGS)
+    {
+        size_t bytes = strlen((const char *) data) + 1;
+        state->position += bytes;
+        return fwrite(data, 1, bytes, state->file) == bytes;
+    }
+    const Vector *v = (const Vector *) data;
+    int64_t len = v->len;
+    state->position += sizeof(int64_t) + (size_t) len * sizeof(double);
+    return fwrite(&len, sizeof(int64_t), 1, state->file) == 1 &&
+           fwrite(v->vector, sizeof(double), (size_t) len, state->file) == (size_t) len;
+}
+
+
+/**
+ * write the items of a tree of strings or of Vectors to a snapshot file, in ascending order.
+ * @param tree: the tree to write.
+ * @param kind: the kind of the items of the tree.
+ * @param path: the file to write, replaced if it exists.
+ * @return: 0 on failure, other on success.
+ */
+int saveRBTree(const RBTree *tree, MappedKind kind, const char *path)
+{
+    if (tree == NULL || path == NULL || (kind != MAPPED_STRINGS && kind != MAPPED_VECTORS))
+    {
+        return false;
+    }
+    size_t indexBytes = tree->size * sizeof(uint64_t);
+    SaveState state = {fopen(path, "wb"), kind, (uint64_t *) malloc(indexBytes == 0 ? 1 : indexBytes), 0,
+                       sizeof(MappedHeader) + indexBytes};
+    MappedHeader header;
+    memset(&header, 0, sizeof(header));
+    bool saved = state.file != NULL && state.offsets != NULL &&
+                 fseek(state.file, (long) state.position, SEEK_SET) == 0 &&
+                 forEachRBTree(tree, saveItem, &state) && state.count == tree->size;
+    if (saved)
+    {
+        memcpy(header.magic, MAPPED_MAGIC, sizeof(header.magic));
+        header.kind = kind;
+        header.itemBytesCheck = sizeof(double);
+        header.count = state.count;
+        header.fileBytes = state.position;
+        saved = fseek(state.file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, state.file) == 1 &&
+                fwrite(state.offsets, sizeof(uint64_t), state.count, state.file) == state.count;
+    }
+    if (state.file != NULL && fclose(state.file) != 0)
+    {
+        saved = false;
+    }
+    if (!saved && state.file != NULL)
+    {
+        remove(path);
+    }
+    free(state.offsets);
+    return saved;
+}
+
+
+/**
+ * check that a mapped file is a valid snapshot: its header, and that its index and its items fit in it.
+ */
+bool validSnapshot(const unsigned char *map, size_t mapBytes)
+{
+    if (mapBytes < sizeof(MappedHeader))
+    {
+        return false;
+    }
+    const MappedHeader *header = (const MappedHeader *) map;
+    if (memcmp(header->magic, MAPPED_MAGIC, sizeof(header->magic)) != 0 ||
+        (header->kind != MAPPED_STRINGS && header->kind != MAPPED_VECTORS) ||
+        header->itemBytesCheck != sizeof(double) || header->fileBytes != mapBytes ||
+        header->count > (mapBytes - sizeof(MappedHeader)) / sizeof(uint64_t) || header->count > ULONG_MAX)
+    {
+        return false;
+    }
+    // the strings are stored one after the other, so each one ends in the file if the last one does.
+    return header->kind != MAPPED_STRINGS || header->count == 0 || map[mapBytes - 1] == '\0';
+}
+
+
+/**
+ * map a snapshot file to memory, in O(1). the file must not change while it is mapped.
+ * @param path: a file written by saveRBTree.
+ * @param compFunc: the CompareFunc of the tree that was saved (the items must be in ascending order by it).
+ * @param freeFunc: the FreeFunc of the items of the tree after the first write.
+ * @return: the new tree, NULL on failure (including a file that is not a valid snapshot).
+ */
+MappedRBTree *loadMappedRBTree(const char *path, CompareFunc compFunc, FreeFunc freeFunc)
+{
+    if (path == NULL || compFunc == NULL)
+    {
+        return NULL;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    struct stat status;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        map = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd); // the mapping keeps the file.
+    if (map == MAP_FAILED)
+    {
+        return NULL;
+    }
+    MappedRBTree *tree = (MappedRBTree *) malloc(sizeof(MappedRBTree));
+    if (tree == NULL || !validSnapshot((const unsigned char *) map, (size_t) status.st_size))
+    {
+        munmap(map, (size_t) status.st_size);
+        free(tree);
+        return NULL;
+    }
+    const MappedHeader *header = (const MappedHeader *) map;
+    tree->map = (const unsigned char *) map;
+    tree->mapBytes = (size_t) status.st_size;
+    tree->kind = (MappedKind) header->kind;
+    tree->offsets = (const uint64_t *) (tree->map + sizeof(MappedHeader));
+    tree->compFunc = compFunc;
+    tree->freeFunc = freeFunc;
+    tree->size = (long unsigned) header->count;
+    tree->tree = NULL;
+    return tree;
+}
+
+
+/**
+ * find the i-th item of a mapped file, in place.
+ * @param view: holds the item if it is a Vector, its elements are in the file.
+ * @return: the item, NULL if its offset is outside of the file.
+ */
+const void *mappedItem(const MappedRBTree *tree, size_t i, Vector *view)
+{
+    uint64_t offset = tree->offsets[i], itemsStart = sizeof(MappedHeader) + tree->size * sizeof(uint64_t);
+    if (offset < itemsStart || offset >= tree->mapBytes)
+    {
+        return NULL;
+    }
+    if (tree->kind == MAPPED_STRINGS)
+    {
+        return tree->map + offset;
+    }
+    int64_t len;
+    if (tree->mapBytes - offset < sizeof(int64_t))
+    {
+        return NULL;
+    }
+    memcpy(&len, tree->map + offset, sizeof(int64_t));
+    if (len < 0 || len > INT_MAX || (uint64_t) len > (tree->mapBytes - offset - sizeof(int64_t)) / sizeof(double))
+    {
+        return NULL;
+    }
+    view->len = (int) len;
+    view->vector = (double *) (tree->map + offset + sizeof(int64_t));
+    return view;
+}
+
+
+/**
+ * check whether the tree contains this item. no copy of the items is made.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int MappedRBTreeContains(const MappedRBTree *tree, const void *data)
+{
+    if (tree == NULL || data == NULL)
+    {
+        return false;
+    }
+    if (tree->tree != NULL)
+    {
+        return RBTreeContains(tree->tree, data);
+    }
+    size_t low = 0, high = tree->size;
+    Vector view;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        const void *item = mappedItem(tree, middle, &view);
+        if (item == NULL)
+        {
+            return false;
+        }
+        int result = tree->compFunc(data, item);
+        if (result == 0)
+        {
+            return true;
+        }
+        result < 0 ? (high = middle) : (low = middle + 1);
+    }
+    return false;
+}
+
+
+/**
+ * Activate a function on each item of the tree in ascending order. if one of the activations of the function
+ * returns 0, the process stops.
+ * @return: 0 on failure, other on success.
+ */
+int forEachMappedRBTree(const MappedRBTree *tree, forEachFunc func, void *args)
+{
+    if (tree == NULL || func == NULL)
+    {
+        return false;
+    }
+    if (tree->tree != NULL)
+    {
+        return forEachRBTree(tree->tree, func, args);
+    }
+    Vector view;
+    for (size_t i = 0; i < tree->size; ++i)
+    {
+        const void *item = mappedItem(tree, i, &view);
+        if (item == NULL || !func(item, args))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * copy an item of a mapped file, allocated like the items freeString and freeVector free.
+ * @return: the copy, NULL on failure.
+ */
+void *copyMappedItem(MappedKind kind, const void *item)
+{
+    if (kind == MAPPED_STRINGS)
+    {
+        size_t bytes = strlen((const char *) item) + 1;
+        char *copy = (char *) malloc(bytes);
+        if (copy != NULL)
+        {
+            memcpy(copy, item, bytes);
+        }
+        return copy;
+    }
+    const Vector *v = (const Vector *) item;
+    Vector *copy = (Vector *) malloc(sizeof(Vector));
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    copy->len = v->len;
+    copy->vector = (double *) malloc((v->len > 0 ? (size_t) v->len : 1) * sizeof(double));
+    if (copy->vector == NULL)
+    {
+        free(copy);
+        return NULL;
+    }
+    memcpy(copy->vector, v->vector, (size_t) v->len * sizeof(double));
+    return copy;
+}
+
+
+/**
+ * free the first n items of a copy of a mapped file, and the array.
+ */
+void freeMappedCopies(const MappedRBTree *tree, void **items, size_t n)
+{
+    for (size_t i = 0; i < n && tree->freeFunc != NULL; ++i)
+    {
+        tree->freeFunc(items[i]);
+    }
+    free(items);
+}
+
+
+/**
+ * the regular RBTree of a mapped tree: on the first call the items are copied from the file, in linear time.
+ * @return: the tree (owned by the mapped tree), NULL on failure.
+ */
+RBTree *mutableRBTree(MappedRBTree *tree)
+{
+    if (tree == NULL || tree->tree != NULL)
+    {
+        return tree == NULL ? NULL : tree->tree;
+    }
+    void **items = (void **) malloc((tree->size == 0 ? 1 : tree->size) * sizeof(void *));
+    if (items == NULL)
+    {
+        return NULL;
+    }
+    Vector view;
+    for (size_t i = 0; i < tree->size; ++i)
+    {
+        const void *item = mappedItem(tree, i, &view);
+        if (item == NULL || (items[i] = copyMappedItem(tree->kind, item)) == NULL)
+        {
+            freeMappedCopies(tree, items, i);
+            return NULL;
+        }
+    }
+    // the file is sorted, so the tree is built in linear time (and a file that is not sorted is rejected).
+    if ((tree->tree = newRBTreeFromSorted(items, tree->size, tree->compFunc, tree->freeFunc)) == NULL)
+    {
+        freeMappedCopies(tree, items, tree->size);
+        return NULL;
+    }
+    free(items);
+    munmap((void *) tree->map, tree->mapBytes);
+    tree->map = NULL;
+    tree->offsets = NULL;
+    return tree->tree;
+}
+
+
+/**
+ * add an item to the tree (see mutableRBTree). the items are copied from the file only if data is not in it.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToMappedRBTree(MappedRBTree *tree, void *data)
+{
+    if (tree != NULL && tree->tree == NULL && MappedRBTreeContains(tree, data))
+    {
+        return false; // already in the tree, so the items are not copied.
+    }
+    RBTree *mutableTree = mutableRBTree(tree);
+    if (mutableTree == NULL || !insertToRBTree(mutableTree, data))
+    {
+        return false;
+    }
+    tree->size = mutableTree->size;
+    return true;
+}
+
+
+/**
+ * remove an item from the tree (see mutableRBTree). the items are copied from the file only if data is in it.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromMappedRBTree(MappedRBTree *tree, void *data)
+{
+    if (tree != NULL && tree->tree == NULL && !MappedRBTreeContains(tree, data))
+    {
+        return false; // nothing to delete, so the items are not copied.
+    }
+    RBTree *mutableTree = mutableRBTree(tree);
+    if (mutableTree == NULL || !deleteFromRBTree(mutableTree, data))
+    {
+        return false;
+    }
+    tree->size = mutableTree->size;
+    return true;
+}
+
+
+/**
+ * unmap the file and free all memory of the tree.
+ * @param tree: pointer to the tree to free.
+ */
+void freeMappedRBTree(MappedRBTree **tree)
+{
+    if (tree == NULL || (*tree) == NULL)
+    {
+        return;
+    }
+    if ((*tree)->tree != NULL)
+    {
+        freeRBTree(&(*tree)->tree);
+    }
+    if ((*tree)->map != NULL)
+    {
+        munmap((void *) (*tree)->map, (*tree)->mapBytes);
+    }
+    free(*tree);
+    (*tree) = NULL;
+}
@@ -0,0 +1,111 @@
+#ifndef RBTREE_MAPPEDRBTREE_H
+#define RBTREE_MAPPEDRBTREE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "RBTree.h"
+#include "Structs.h"
+
+/**
+ * the first bytes of every snapshot file.
+ */
+#define MAPPED_MAGIC "RBTMAP01"
+
+/**
+ * the kind of the items of a snapshot file.
+ */
+typedef enum MappedKind
+{
+	MAPPED_STRINGS = 1, MAPPED_VECTORS = 2
+} MappedKind;
+
+/*
+ * the header of a snapshot file. it is followed by the index (count offsets from the start of the file, one
+ * for each item in ascending order) and then by the items: a string is its bytes and a "\0", a vector is its
+ * length as an int64_t followed by its elements. all the numbers are in the byte order of the machine.
+ */
+typedef struct MappedHeader
+{
+	char magic[8];
+	uint32_t kind;
+	uint32_t itemBytesCheck; // sizeof(double), so a file is not read by a machine it was not made for.
+	uint64_t count;
+	uint64_t fileBytes;
+} MappedHeader;
+
+/**
+ * a tree loaded from a snapshot file (see saveRBTree) by mapping it to memory. contains and ordered iteration
+ * read the items in place with a binary search over the index, so loading is O(1) and only touches the pages
+ * that are read. the first write copies the items into a regular RBTree (in linear time) and unmaps the file;
+ * from then on all the operations go to that tree.
+ */
+typedef struct MappedRBTree
+{
+	const unsigned char *map; // NULL once the items were copied to tree.
+	size_t mapBytes;
+	MappedKind kind;
+	const uint64_t *offsets;
+	CompareFunc compFunc;
+	FreeFunc freeFunc;
+	long unsigned size;
+	RBTree *tree; // NULL until the first write.
+} MappedRBTree;
+
+/**
+ * write the items of a tree of strings or of Vectors to a snapshot file, in ascending order.
+ * @param tree: the tree to write.
+ * @param kind: the kind of the items of the tree.
+ * @param path: the file to write, replaced if it exists.
+ * @return: 0 on failure, other on success.
+ */
+int saveRBTree(const RBTree *tree, MappedKind kind, const char *path);
+
+/**
+ * map a snapshot file to memory, in O(1). the file must not change while it is mapped.
+ * @param path: a file written by saveRBTree.
+ * @param compFunc: the CompareFunc of the tree that was saved (the items must be in ascending order by it).
+ * @param freeFunc: the FreeFunc of the items of the tree after the first write. the items copied from the file
+ * are allocated like the items freeString and freeVector free.
+ * @return: the new tree, NULL on failure (including a file that is not a valid snapshot).
+ */
+MappedRBTree *loadMappedRBTree(const char *path, CompareFunc compFunc, FreeFunc freeFunc);
+
+/**
+ * check whether the tree contains this item. no copy of the items is made.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int MappedRBTreeContains(const MappedRBTree *tree, const void *data);
+
+/**
+ * Activate a function on each item of the tree in ascending order. if one of the activations of the function
+ * returns 0, the process stops. before the first write the function gets the strings in the mapped file, and
+ * Vectors that live only during its call.
+ * @return: 0 on failure, other on success.
+ */
+int forEachMappedRBTree(const MappedRBTree *tree, forEachFunc func, void *args);
+
+/**
+ * the regular RBTree of a mapped tree: on the first call the items are copied from the file, in linear time.
+ * @return: the tree (owned by the mapped tree), NULL on failure.
+ */
+RBTree *mutableRBTree(MappedRBTree *tree);
+
+/**
+ * add an item to the tree (see mutableRBTree). the items are copied from the file only if data is not in it.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToMappedRBTree(MappedRBTree *tree, void *data);
+
+/**
+ * remove an item from the tree (see mutableRBTree). the items are copied from the file only if data is in it.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromMappedRBTree(MappedRBTree *tree, void *data);
+
+/**
+ * unmap the file and free all memory of the tree.
+ * @param tree: pointer to the tree to free.
+ */
+void freeMappedRBTree(MappedRBTree **tree);
+
+#endif //RBTREE_MAPPEDRBTREE_H
@@ -0,0 +1,103 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "NodePool.h"
+
+
+/**
+ * constructs a new empty NodePool.
+ * @param nodesPerSlab: number of nodes to allocate in each slab, 0 for DEFAULT_NODES_PER_SLAB.
+ * @return: the new pool, NULL on failure (including a slab too large to allocate).
+ */
+NodePool *newNodePool(size_t nodesPerSlab)
+{
+    if (nodesPerSlab > (SIZE_MAX - sizeof(NodeSlab)) / sizeof(Node))
+    {
+        return NULL; // the bytes of a slab would overflow a size_t.
+    }
+    NodePool *pool = (NodePool *) malloc(sizeof(NodePool));
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+    pool->slabs = NULL;
+    pool->freeList = NULL;
+    pool->nodesPerSlab = nodesPerSlab == 0 ? DEFAULT_NODES_PER_SLAB : nodesPerSlab;
+    return pool;
+}
+
+
+/**
+ * add a new slab in front of the slabs list of pool.
+ * @param pool: the pool to add a slab to.
+ * @return: the new slab, NULL on failure.
+ */
+NodeSlab *addSlab(NodePool *pool)
+{
+    NodeSlab *slab = (NodeSlab *) malloc(sizeof(NodeSlab) + pool->nodesPerSlab * sizeof(Node));
+    if (slab == NULL)
+    {
+        return NULL;
+    }
+    slab->used = 0;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    return slab;
+}
+
+
+/**
+ * take a node from the pool. the fields of the node are not initialized.
+ * @param pool: the pool to allocate from.
+ * @return: an unused node, NULL on failure.
+ */
+Node *allocateFromNodePool(NodePool *pool)
+{
+    if (pool->freeList != NULL)
+    {
+        Node *node = pool->freeList;
+        pool->freeList = node->left;
+        return node;
+    }
+    NodeSlab *slab = pool->slabs;
+    if ((slab == NULL || slab->used == pool->nodesPerSlab) && (slab = addSlab(pool)) == NULL)
+    {
+        return NULL;
+    }
+    return &slab->nodes[slab->used++];
+}
+
+
+/**
+ * return a node to the freelist of the pool it was allocated from.
+ * @param pool: the pool the node was allocated from.
+ * @param node: the node to return.
+ */
+void releaseToNodePool(NodePool *pool, Node *node)
+{
+    node->data = NULL;
+    node->right = NULL;
+    node->left = pool->freeList;
+    pool->freeList = node;
+}
+
+
+/**
+ * free all the slabs of the pool at once. all nodes allocated from it become invalid.
+ * @param pool: pointer to the pool to free.
+ */
+void freeNodePool(NodePool **pool)
+{
+    if (pool == NULL || (*pool) == NULL)
+    {
+        return;
+    }
+    NodeSlab *slab = (*pool)->slabs;
+    while (slab != NULL)
+    {
+        NodeSlab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    free(*pool);
+    (*pool) = NULL;
+}
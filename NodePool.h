@@ -0,0 +1,60 @@
+#ifndef RBTREE_NODEPOOL_H
+#define RBTREE_NODEPOOL_H
+
+#include <stddef.h>
+#include "RBTree.h"
+
+/**
+ * number of nodes in each slab when newNodePool gets 0.
+ */
+#define DEFAULT_NODES_PER_SLAB 4096
+
+/*
+ * a slab of nodes, allocated in one malloc.
+ */
+typedef struct NodeSlab
+{
+	struct NodeSlab *next;
+	size_t used;
+	Node nodes[];
+} NodeSlab;
+
+/**
+ * a slab/arena allocator for tree nodes. deleted nodes go to a freelist (linked through their left
+ * pointer) and are reused before a new slab is touched. all the slabs are released together.
+ */
+typedef struct NodePool
+{
+	NodeSlab *slabs;
+	Node *freeList;
+	size_t nodesPerSlab;
+} NodePool;
+
+/**
+ * constructs a new empty NodePool.
+ * @param nodesPerSlab: number of nodes to allocate in each slab, 0 for DEFAULT_NODES_PER_SLAB.
+ * @return: the new pool, NULL on failure (including a slab too large to allocate).
+ */
+NodePool *newNodePool(size_t nodesPerSlab);
+
+/**
+ * take a node from the pool. the fields of the node are not initialized.
+ * @param pool: the pool to allocate from.
+ * @return: an unused node, NULL on failure.
+ */
+Node *allocateFromNodePool(NodePool *pool);
+
+/**
+ * return a node to the freelist of the pool it was allocated from.
+ * @param pool: the pool the node was allocated from.
+ * @param node: the node to return.
+ */
+void releaseToNodePool(NodePool *pool, Node *node);
+
+/**
+ * free all the slabs of the pool at once. all nodes allocated from it become invalid.
+ * @param pool: pointer to the pool to free.
+ */
+void freeNodePool(NodePool **pool);
+
+#endif //RBTREE_NODEPOOL_H
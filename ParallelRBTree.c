@@ -0,0 +1,213 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "ParallelRBTree.h"
+#include "RBTreeInternal.h"
+
+/**
+ * the top levels of the tree are split into about this many ranges for each thread, before the ranges are
+ * grouped into one range for each thread.
+ */
+#define RANGES_PER_THREAD 8
+
+/**
+ * the range of items one thread goes over.
+ */
+typedef struct ForEachRange
+{
+    Node *first; // the first node of the range, NULL if the range is empty.
+    Node *end; // the first node after the range, NULL for the end of the tree.
+    forEachFunc func;
+    void *args;
+    int *stop; // shared by all the threads, set when one activation of func fails.
+    int result;
+} ForEachRange;
+
+
+/**
+ * the number of items of a sub tree: exact with RBTREE_ORDER_STATISTICS. otherwise it is estimated from the
+ * black height h of the sub tree as 2^h - 1, the least number of nodes a sub tree of black height h has, so
+ * that sub trees of different heights get weights in proportion to their sizes.
+ * @param node: the root of the sub tree, may be NULL.
+ * @return: the (estimated) number of items.
+ */
+double estimateSubtreeSize(const Node *node)
+{
+#ifdef RBTREE_ORDER_STATISTICS
+    return (double) subtreeSize(node);
+#else
+    double size = 1;
+    for (; node != NULL; node = node->left)
+    {
+        size *= nodeColor(node) == BLACK ? 2 : 1;
+    }
+    return size - 1;
+#endif
+}
+
+
+/**
+ * collect the nodes of the top levels of a sub tree in ascending order, with the (estimated) number of items
+ * before each of them. the items between two consecutive collected nodes form a sub tree below maxDepth.
+ * @param node: the root of the sub tree.
+ * @param depth: the depth of node.
+ * @param maxDepth: the depth of the deepest nodes to collect.
+ * @param nodes: the array to fill.
+ * @param ranks: the array to fill with the number of items before each node.
+ * @param count: the number of nodes already in the array, updated.
+ * @param items: the number of items before the sub tree, updated to the number of items up to its end.
+ */
+void collectTopNodes(Node *node, unsigned int depth, unsigned int maxDepth, Node **nodes, double *ranks,
+                     size_t *count, double *items)
+{
+    if (node == NULL || depth > maxDepth)
+    {
+        *items += estimateSubtreeSize(node);
+        return;
+    }
+    collectTopNodes(node->left, depth + 1, maxDepth, nodes, ranks, count, items);
+    ranks[*count] = *items;
+    nodes[(*count)++] = node;
+    *items += 1;
+    collectTopNodes(node->right, depth + 1, maxDepth, nodes, ranks, count, items);
+}
+
+
+/**
+ * the function of a thread: activate the function on each item of one range, until the range ends or one of
+ * the threads fails.
+ * @param arg: the ForEachRange to go over.
+ * @return: NULL.
+ */
+void *forEachInNodeRange(void *arg)
+{
+    ForEachRange *range = (ForEachRange *) arg;
+    range->result = true;
+    for (Node *node = range->first; node != range->end; node = successorNode(node))
+    {
+        if (__atomic_load_n(range->stop, __ATOMIC_RELAXED))
+        {
+            range->result = false;
+            break;
+        }
+        if (!range->func(node->data, range->args))
+        {
+            __atomic_store_n(range->stop, true, __ATOMIC_RELAXED);
+            range->result = false;
+            break;
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * split the tree into nthreads ranges of consecutive items of roughly equal size: range i starts at the first
+ * top node with at least i / nthreads of the (estimated) items before it. if the tree is too small, the last
+ * ranges are empty.
+ * @param tree: the tree to split.
+ * @param ranges: nthreads ranges to set the first and end nodes of.
+ * @param nthreads: the number of ranges.
+ * @return: false on allocation failure, true otherwise.
+ */
+bool splitToRanges(const RBTree *tree, ForEachRange *ranges, size_t nthreads)
+{
+    unsigned int maxDepth = 0;
+    while (maxDepth < 24 && (((size_t) 1) << maxDepth) < nthreads * RANGES_PER_THREAD)
+    {
+        maxDepth++;
+    }
+    Node **nodes = (Node **) malloc((((size_t) 2) << maxDepth) * sizeof(Node *));
+    double *ranks = (double *) malloc((((size_t) 2) << maxDepth) * sizeof(double));
+    if (nodes == NULL || ranks == NULL)
+    {
+        free(nodes);
+        free(ranks);
+        return false;
+    }
+    size_t count = 0, next = 0;
+    double items = 0;
+    collectTopNodes(tree->root, 0, maxDepth, nodes, ranks, &count, &items);
+    ranges[0].first = minimumNode(tree->root);
+    for (size_t i = 1; i < nthreads; ++i)
+    {
+        // the first range starts at the minimum, so the others start after at least one item (a rank above 0).
+        double target = items * (double) i / (double) nthreads;
+        while (next < count && (ranks[next] < target || ranks[next] == 0))
+        {
+            next++;
+        }
+        ranges[i].first = next < count ? nodes[next++] : NULL;
+        ranges[i - 1].end = ranges[i].first;
+    }
+    ranges[nthreads - 1].end = NULL;
+    free(nodes);
+    free(ranks);
+    return true;
+}
+
+
+/**
+ * Activate a function on each item of the tree using nthreads threads, each on a range of consecutive items,
+ * and merge the args of the threads with combine.
+ * @param tree: the tree with all the items.
+ * @param func: the function to activate on all items.
+ * @param args: nthreads arguments, one for each thread.
+ * @param nthreads: number of threads to use, including the calling thread.
+ * @param combine: the function that merges the args of the threads, may be NULL.
+ * @return: 0 on failure, other on success.
+ */
+int parallelForEachRBTree(const RBTree *tree, forEachFunc func, void **args, size_t nthreads, CombineFunc combine)
+{
+    if (tree == NULL || func == NULL || args == NULL || nthreads == 0)
+    {
+        return false;
+    }
+    ForEachRange *ranges = (ForEachRange *) malloc(nthreads * sizeof(ForEachRange));
+    pthread_t *threads = (pthread_t *) malloc(nthreads * sizeof(pthread_t));
+    bool *running = (bool *) calloc(nthreads, sizeof(bool));
+    if (ranges == NULL || threads == NULL || running == NULL || !splitToRanges(tree, ranges, nthreads))
+    {
+        free(ranges);
+        free(threads);
+        free(running);
+        return false;
+    }
+    int stop = false;
+    for (size_t i = 0; i < nthreads; ++i)
+    {
+        ranges[i].func = func;
+        ranges[i].args = args[i];
+        ranges[i].stop = &stop;
+        ranges[i].result = true;
+    }
+    for (size_t i = 1; i < nthreads && ranges[i].first != NULL; ++i)
+    {
+        running[i] = pthread_create(&threads[i], NULL, forEachInNodeRange, &ranges[i]) == 0;
+    }
+    for (size_t i = 0; i < nthreads; ++i) // the range of this thread, and ranges no thread could be started for
+    {
+        if (!running[i] && ranges[i].first != NULL)
+        {
+            forEachInNodeRange(&ranges[i]);
+        }
+    }
+    int result = true;
+    for (size_t i = 0; i < nthreads; ++i)
+    {
+        if (running[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+        result = result && ranges[i].result;
+    }
+    for (size_t i = 1; result && combine != NULL && i < nthreads; ++i)
+    {
+        result = combine(args[0], args[i]);
+    }
+    free(ranges);
+    free(threads);
+    free(running);
+    return result;
+}
@@ -0,0 +1,34 @@
+#ifndef RBTREE_PARALLELRBTREE_H
+#define RBTREE_PARALLELRBTREE_H
+
+#include <stddef.h>
+#include "RBTree.h"
+
+/**
+ * pointer to a function that merges the result one thread of parallelForEachRBTree collected in its args
+ * into the args of another thread.
+ * @into: the args to merge into.
+ * @from: the args to merge from.
+ * @return: 0 on failure, other on success.
+ */
+typedef int (*CombineFunc)(void *into, const void *from);
+
+/**
+ * Activate a function on each item of the tree using nthreads threads. the tree is split into nthreads
+ * ranges of consecutive items of roughly equal size (by the sizes of the sub trees with RBTREE_ORDER_STATISTICS,
+ * otherwise by estimates from their black heights, so the ranges may differ by a small factor), and thread i
+ * activates func on the items of range i in ascending order with args[i]. when all threads are done,
+ * combine(args[0], args[i]) is called for i = 1 .. nthreads - 1 in this order, so args[0] holds the result of
+ * the whole tree. if one of the activations of func returns 0, all the threads stop (soon) and combine is not
+ * called.
+ * the tree must not be changed while this function runs.
+ * @param tree: the tree with all the items.
+ * @param func: the function to activate on all items. it runs on several threads at once.
+ * @param args: nthreads arguments, one for each thread.
+ * @param nthreads: number of threads to use, including the calling thread.
+ * @param combine: the function that merges the args of the threads, NULL if there is nothing to merge.
+ * @return: 0 on failure, other on success.
+ */
+int parallelForEachRBTree(const RBTree *tree, forEachFunc func, void **args, size_t nthreads, CombineFunc combine);
+
+#endif //RBTREE_PARALLELRBTREE_H
@@ -0,0 +1,819 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include "PersistentRBTree.h"
+
+/**
+ * the most nodes one write can copy or create.
+ */
+#define SPARE_NODES (2 * PERSISTENT_MAX_DEPTH + 2)
+
+/**
+ * enum created identify easily if a Node is the right \ left child of its parent.
+ */
+typedef enum Direction
+{
+    LEFT, RIGHT
+} Direction;
+
+
+/**
+ * constructs a new PersistentRBTree with the given CompareFunc.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free the items of the tree.
+ * @return: the new tree, NULL on failure.
+ */
+PersistentRBTree *newPersistentRBTree(CompareFunc compFunc, FreeFunc freeFunc)
+{
+    PersistentRBTree *tree = (PersistentRBTree *) malloc(sizeof(PersistentRBTree));
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    if (pthread_mutex_init(&tree->lock, NULL) != 0)
+    {
+        free(tree);
+        return NULL;
+    }
+    tree->root = NULL;
+    tree->compFunc = compFunc;
+    tree->freeFunc = freeFunc;
+    tree->size = 0;
+    tree->version = 1;
+    tree->sharedVersion = 0;
+    tree->views = NULL;
+    tree->retired = NULL;
+    tree->retiredCount = 0;
+    tree->retiredCapacity = 0;
+    tree->spareNodes = NULL;
+    tree->spareCount = 0;
+    tree->closing = false;
+    return tree;
+}
+
+
+/**
+ * allocate in advance everything a single write may need, so that the write itself cannot fail half way.
+ * @param tree: the tree that is about to be written.
+ * @return: false on allocation failure, true otherwise.
+ */
+bool reserveForWrite(PersistentRBTree *tree)
+{
+    while (tree->spareCount < SPARE_NODES)
+    {
+        PersistentNode *node = (PersistentNode *) malloc(sizeof(PersistentNode));
+        if (node == NULL)
+        {
+            return false;
+        }
+        node->left = tree->spareNodes;
+        tree->spareNodes = node;
+        tree->spareCount++;
+    }
+    if (tree->retiredCount + SPARE_NODES + 1 > tree->retiredCapacity)
+    {
+        size_t capacity = 2 * tree->retiredCapacity + SPARE_NODES + 1;
+        RetiredPointer *retired = (RetiredPointer *) realloc(tree->retired, capacity * sizeof(RetiredPointer));
+        if (retired == NULL)
+        {
+            return false;
+        }
+        tree->retired = retired;
+        tree->retiredCapacity = capacity;
+    }
+    return true;
+}
+
+
+/**
+ * take one of the nodes reserved by reserveForWrite.
+ * @param tree: the tree being written.
+ * @return: an uninitialized node.
+ */
+PersistentNode *takeSpareNode(PersistentRBTree *tree)
+{
+    PersistentNode *node = tree->spareNodes;
+    tree->spareNodes = node->left;
+    tree->spareCount--;
+    return node;
+}
+
+
+/**
+ * remember a pointer that live views may still see, to free it once they are released.
+ * @param tree: the tree the pointer was removed from.
+ * @param pointer: the node or item.
+ * @param isData: true for an item, false for a node.
+ * @param firstVersion: the oldest version that can see the pointer.
+ */
+void retire(PersistentRBTree *tree, void *pointer, bool isData, long unsigned firstVersion)
+{
+    RetiredPointer *retired = &tree->retired[tree->retiredCount++];
+    retired->pointer = pointer;
+    retired->isData = isData;
+    retired->firstVersion = firstVersion;
+    retired->lastVersion = tree->sharedVersion;
+}
+
+
+/**
+ * free a node that was removed from the current version, or retire it if a view may see it.
+ */
+void discardNode(PersistentRBTree *tree, PersistentNode *node)
+{
+    if (node->version <= tree->sharedVersion)
+    {
+        retire(tree, node, false, node->version);
+    }
+    else
+    {
+        free(node);
+    }
+}
+
+
+/**
+ * free an item that was removed from the current version, or retire it if a view may see it.
+ */
+void discardData(PersistentRBTree *tree, void *data)
+{
+    if (tree->sharedVersion > 0)
+    {
+        retire(tree, data, true, 0);
+    }
+    else
+    {
+        tree->freeFunc(data);
+    }
+}
+
+
+/**
+ * get a version of node that the current write may change: the node itself if no view can see it,
+ * otherwise a copy (and the original is retired).
+ * @param tree: the tree being written.
+ * @param node: a node of the current version.
+ * @return: the node to change.
+ */
+PersistentNode *writableNode(PersistentRBTree *tree, PersistentNode *node)
+{
+    if (node->version > tree->sharedVersion)
+    {
+        return node;
+    }
+    PersistentNode *copy = takeSpareNode(tree);
+    *copy = *node;
+    copy->version = tree->version;
+    retire(tree, node, false, node->version);
+    return copy;
+}
+
+
+/**
+ * @return: the child of node in direction.
+ */
+PersistentNode *childOf(const PersistentNode *node, Direction direction)
+{
+    return direction == LEFT ? node->left : node->right;
+}
+
+
+/**
+ * set the child of node in direction.
+ */
+void setChild(PersistentNode *node, Direction direction, PersistentNode *child)
+{
+    direction == LEFT ? (node->left = child) : (node->right = child);
+}
+
+
+/**
+ * make the child of a writable node writable, and link the writable version to the node.
+ * @param tree: the tree being written.
+ * @param node: a writable node.
+ * @param direction: the direction of the child.
+ * @return: the writable child, NULL if there is no child.
+ */
+PersistentNode *writableChild(PersistentRBTree *tree, PersistentNode *node, Direction direction)
+{
+    PersistentNode *child = childOf(node, direction);
+    if (child == NULL)
+    {
+        return NULL;
+    }
+    child = writableNode(tree, child);
+    setChild(node, direction, child);
+    return child;
+}
+
+
+/**
+ * replace the child oldChild of parent (or the root, if parent is NULL) by newChild.
+ */
+void replaceChild(PersistentRBTree *tree, PersistentNode *parent, PersistentNode *oldChild, PersistentNode *newChild)
+{
+    if (parent == NULL)
+    {
+        tree->root = newChild;
+    }
+    else
+    {
+        setChild(parent, parent->left == oldChild ? LEFT : RIGHT, newChild);
+    }
+}
+
+
+/**
+ * rotate the child of node in direction above node. node, the child and parent must be writable.
+ * @param tree: the tree being written.
+ * @param parent: the parent of node, NULL if node is the root.
+ * @param node: the node to rotate.
+ * @param direction: the direction of the child that goes up.
+ * @return: the child, now in the place of node.
+ */
+PersistentNode *rotateChildUp(PersistentRBTree *tree, PersistentNode *parent, PersistentNode *node,
+                              Direction direction)
+{
+    PersistentNode *child = childOf(node, direction);
+    setChild(node, direction, childOf(child, !direction));
+    setChild(child, !direction, node);
+    replaceChild(tree, parent, node, child);
+    return child;
+}
+
+
+/**
+ * replace each node of a path from the root by its writable version.
+ * @param tree: the tree being written.
+ * @param path: the nodes of the path, path[0] is the root.
+ * @param directions: directions[i] is the direction from path[i] to path[i + 1].
+ * @param depth: the number of nodes in the path.
+ */
+void copyPath(PersistentRBTree *tree, PersistentNode **path, const Direction *directions, size_t depth)
+{
+    for (size_t i = 0; i < depth; ++i)
+    {
+        path[i] = writableNode(tree, path[i]);
+        if (i == 0)
+        {
+            tree->root = path[i];
+        }
+        else
+        {
+            setChild(path[i - 1], directions[i - 1], path[i]);
+        }
+    }
+}
+
+
+/**
+ * fix a red node whose parent may be red, going up the (writable) path.
+ * @param tree: the tree being written.
+ * @param path: the writable path from the root to the node.
+ * @param directions: directions[i] is the direction from path[i] to path[i + 1].
+ * @param i: the index of the red node in path.
+ */
+void fixInsertion(PersistentRBTree *tree, PersistentNode **path, const Direction *directions, size_t i)
+{
+    while (i >= 2 && path[i - 1]->color == RED)
+    {
+        PersistentNode *parent = path[i - 1], *grandparent = path[i - 2];
+        Direction parentSide = directions[i - 2];
+        PersistentNode *uncle = childOf(grandparent, !parentSide);
+        if (uncle != NULL && uncle->color == RED)
+        {
+            uncle = writableChild(tree, grandparent, !parentSide);
+            parent->color = BLACK;
+            uncle->color = BLACK;
+            grandparent->color = RED;
+            i -= 2;
+            continue;
+        }
+        if (directions[i - 1] != parentSide) // the node is an inner grandchild, rotate it to the outside
+        {
+            parent = rotateChildUp(tree, grandparent, parent, directions[i - 1]);
+        }
+        rotateChildUp(tree, i >= 3 ? path[i - 3] : NULL, grandparent, parentSide);
+        parent->color = BLACK;
+        grandparent->color = RED;
+        return;
+    }
+}
+
+
+/**
+ * fix a missing black node under path[i] (a double black position), going up the (writable) path.
+ * @param tree: the tree being written.
+ * @param path: the writable path from the root to the parent of the double black position.
+ * @param directions: directions[i] is the direction from path[i] to the double black position, and to
+ * path[i + 1] for the nodes above.
+ * @param i: the index of the parent of the double black position in path.
+ */
+void fixDeletion(PersistentRBTree *tree, PersistentNode **path, Direction *directions, size_t i)
+{
+    while (true)
+    {
+        PersistentNode *parent = path[i];
+        Direction side = directions[i];
+        PersistentNode *sibling = writableChild(tree, parent, !side);
+        if (sibling->color == RED)
+        {
+            rotateChildUp(tree, i > 0 ? path[i - 1] : NULL, parent, !side);
+            sibling->color = BLACK;
+            parent->color = RED;
+            path[i] = sibling;
+            path[i + 1] = parent;
+            directions[i + 1] = side;
+            i++;
+            continue;
+        }
+        PersistentNode *far = childOf(sibling, !side), *near = childOf(sibling, side);
+        bool farRed = far != NULL && far->color == RED, nearRed = near != NULL && near->color == RED;
+        if (!farRed && !nearRed)
+        {
+            sibling->color = RED;
+            if (parent->color == RED || i == 0)
+            {
+                parent->color = BLACK;
+                return;
+            }
+            i--;
+            continue;
+        }
+        if (!farRed)
+        {
+            near = writableChild(tree, sibling, side);
+            rotateChildUp(tree, parent, sibling, side);
+            near->color = BLACK;
+            sibling->color = RED;
+            sibling = near;
+        }
+        far = writableChild(tree, sibling, !side);
+        sibling->color = parent->color;
+        parent->color = BLACK;
+        far->color = BLACK;
+        rotateChildUp(tree, i > 0 ? path[i - 1] : NULL, parent, !side);
+        return;
+    }
+}
+
+
+/**
+ * make sure the root of the current version is black.
+ */
+void blackenPersistentRoot(PersistentRBTree *tree)
+{
+    if (tree->root != NULL && tree->root->color == RED)
+    {
+        tree->root = writableNode(tree, tree->root);
+        tree->root->color = BLACK;
+    }
+}
+
+
+/**
+ * add an item to the tree, copying the path to it.
+ * @param tree: the tree to add an item to.
+ * @param data: item to add to the tree.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToPersistentRBTree(PersistentRBTree *tree, void *data)
+{
+    if (tree == NULL || data == NULL || tree->compFunc == NULL || pthread_mutex_lock(&tree->lock) != 0)
+    {
+        return false;
+    }
+    if (!reserveForWrite(tree))
+    {
+        pthread_mutex_unlock(&tree->lock);
+        return false;
+    }
+    PersistentNode *path[PERSISTENT_MAX_DEPTH];
+    Direction directions[PERSISTENT_MAX_DEPTH];
+    size_t depth = 0;
+    for (PersistentNode *node = tree->root; node != NULL; depth++)
+    {
+        int result = tree->compFunc(node->data, data);
+        if (result == 0)
+        {
+            pthread_mutex_unlock(&tree->lock);
+            return false;
+        }
+        path[depth] = node;
+        directions[depth] = result > 0 ? LEFT : RIGHT;
+        node = childOf(node, directions[depth]);
+    }
+    if (depth > 0) // an empty tree has no path to copy.
+    {
+        copyPath(tree, path, directions, depth);
+    }
+    PersistentNode *node = takeSpareNode(tree);
+    node->left = NULL;
+    node->right = NULL;
+    node->color = RED;
+    node->data = data;
+    node->version = tree->version;
+    if (depth == 0)
+    {
+        tree->root = node;
+    }
+    else
+    {
+        setChild(path[depth - 1], directions[depth - 1], node);
+    }
+    path[depth] = node;
+    fixInsertion(tree, path, directions, depth);
+    blackenPersistentRoot(tree);
+    tree->size++;
+    pthread_mutex_unlock(&tree->lock);
+    return true;
+}
+
+
+/**
+ * unlink the last node of a writable path, which has at most one child, and fix the tree.
+ * @param tree: the tree being written.
+ * @param path: the writable path from the root to the node.
+ * @param directions: directions[i] is the direction from path[i] to path[i + 1].
+ * @param depth: the number of nodes in the path.
+ */
+void unlinkNode(PersistentRBTree *tree, PersistentNode **path, Direction *directions, size_t depth)
+{
+    PersistentNode *node = path[depth - 1];
+    PersistentNode *parent = depth >= 2 ? path[depth - 2] : NULL;
+    Direction side = depth >= 2 ? directions[depth - 2] : LEFT;
+    PersistentNode *child = node->left != NULL ? node->left : node->right;
+    if (parent == NULL)
+    {
+        tree->root = child;
+    }
+    else
+    {
+        setChild(parent, side, child);
+    }
+    if (node->color == RED)
+    {
+        return;
+    }
+    if (child != NULL) // a black node with a single child, which must be red
+    {
+        child = writableNode(tree, child);
+        parent == NULL ? (tree->root = child) : setChild(parent, side, child);
+        child->color = BLACK;
+    }
+    else if (parent != NULL)
+    {
+        fixDeletion(tree, path, directions, depth - 2);
+    }
+}
+
+
+/**
+ * remove an item from the tree, copying the path to it.
+ * @param tree: the tree to remove an item from.
+ * @param data: item to remove from the tree.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromPersistentRBTree(PersistentRBTree *tree, void *data)
+{
+    if (tree == NULL || data == NULL || tree->compFunc == NULL || tree->freeFunc == NULL ||
+        pthread_mutex_lock(&tree->lock) != 0)
+    {
+        return false;
+    }
+    if (!reserveForWrite(tree))
+    {
+        pthread_mutex_unlock(&tree->lock);
+        return false;
+    }
+    PersistentNode *path[PERSISTENT_MAX_DEPTH];
+    Direction directions[PERSISTENT_MAX_DEPTH];
+    size_t depth = 0;
+    PersistentNode *node = tree->root;
+    while (node != NULL)
+    {
+        int result = tree->compFunc(node->data, data);
+        path[depth] = node;
+        if (result == 0)
+        {
+            break;
+        }
+        directions[depth++] = result > 0 ? LEFT : RIGHT;
+        node = childOf(node, directions[depth - 1]);
+    }
+    if (node == NULL)
+    {
+        pthread_mutex_unlock(&tree->lock);
+        return false;
+    }
+    size_t found = depth++;
+    if (node->left != NULL && node->right != NULL) // the successor gives its item to node and is removed instead
+    {
+        directions[found] = RIGHT;
+        for (node = node->right; node != NULL; node = node->left)
+        {
+            path[depth] = node;
+            directions[depth++] = LEFT;
+        }
+    }
+    copyPath(tree, path, directions, depth);
+    void *removedData = path[found]->data;
+    PersistentNode *removed = path[depth - 1];
+    path[found]->data = removed->data;
+    unlinkNode(tree, path, directions, depth);
+    blackenPersistentRoot(tree);
+    discardNode(tree, removed);
+    discardData(tree, removedData);
+    tree->size--;
+    pthread_mutex_unlock(&tree->lock);
+    return true;
+}
+
+
+/**
+ * check whether the sub tree of root contains this item.
+ */
+bool persistentNodesContain(const PersistentNode *node, CompareFunc compFunc, const void *data)
+{
+    while (node != NULL)
+    {
+        int result = compFunc(node->data, data);
+        if (result == 0)
+        {
+            return true;
+        }
+        node = result > 0 ? node->left : node->right;
+    }
+    return false;
+}
+
+
+/**
+ * Activate a function on each item of a sub tree in ascending order, with an explicit stack.
+ * @return: true if all the activations succeeded, false otherwise.
+ */
+bool forEachPersistentNode(PersistentNode *node, forEachFunc func, void *args)
+{
+    PersistentNode *stack[PERSISTENT_MAX_DEPTH];
+    size_t depth = 0;
+    while (node != NULL || depth > 0)
+    {
+        while (node != NULL)
+        {
+            stack[depth++] = node;
+            node = node->left;
+        }
+        node = stack[--depth];
+        if (!func(node->data, args))
+        {
+            return false;
+        }
+        node = node->right;
+    }
+    return true;
+}
+
+
+/**
+ * check whether the current version of the tree contains this item.
+ * @param tree: the tree to check an item in.
+ * @param data: item to check.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int PersistentRBTreeContains(PersistentRBTree *tree, const void *data)
+{
+    if (tree == NULL || tree->compFunc == NULL || data == NULL || pthread_mutex_lock(&tree->lock) != 0)
+    {
+        return false;
+    }
+    int result = persistentNodesContain(tree->root, tree->compFunc, data);
+    pthread_mutex_unlock(&tree->lock);
+    return result;
+}
+
+
+/**
+ * Activate a function on each item of the current version of the tree, in ascending order.
+ * @param tree: the tree with all the items.
+ * @param func: the function to activate on all items.
+ * @param args: more optional arguments to the function.
+ * @return: 0 on failure, other on success.
+ */
+int forEachPersistentRBTree(PersistentRBTree *tree, forEachFunc func, void *args)
+{
+    if (tree == NULL || func == NULL || pthread_mutex_lock(&tree->lock) != 0)
+    {
+        return false;
+    }
+    int result = forEachPersistentNode(tree->root, func, args);
+    pthread_mutex_unlock(&tree->lock);
+    return result;
+}
+
+
+/**
+ * check whether a live view can see a pointer retired with the given versions.
+ */
+bool viewCanSee(const PersistentRBTree *tree, const RetiredPointer *retired)
+{
+    for (const RBTreeView *view = tree->views; view != NULL; view = view->next)
+    {
+        if (retired->firstVersion <= view->version && view->version <= retired->lastVersion)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * free the retired nodes and items that no live view can see.
+ * @param tree: the tree to reclaim memory of, locked.
+ */
+void reclaim(PersistentRBTree *tree)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < tree->retiredCount; ++i)
+    {
+        RetiredPointer *retired = &tree->retired[i];
+        if (viewCanSee(tree, retired))
+        {
+            tree->retired[kept++] = *retired;
+        }
+        else if (retired->isData)
+        {
+            tree->freeFunc(retired->pointer);
+        }
+        else
+        {
+            free(retired->pointer);
+        }
+    }
+    tree->retiredCount = kept;
+}
+
+
+/**
+ * free the nodes and the items of a sub tree.
+ */
+void freePersistentNodes(PersistentNode *node, FreeFunc freeFunc)
+{
+    while (node != NULL)
+    {
+        PersistentNode *right = node->right;
+        freePersistentNodes(node->left, freeFunc);
+        freeFunc(node->data);
+        free(node);
+        node = right;
+    }
+}
+
+
+/**
+ * free all the memory of a tree that has no live views.
+ */
+void destroyPersistentRBTree(PersistentRBTree *tree)
+{
+    reclaim(tree);
+    freePersistentNodes(tree->root, tree->freeFunc);
+    while (tree->spareNodes != NULL)
+    {
+        free(takeSpareNode(tree));
+    }
+    free(tree->retired);
+    pthread_mutex_destroy(&tree->lock);
+    free(tree);
+}
+
+
+/**
+ * free all memory of the tree, now or when its last view is released.
+ * @param tree: pointer to the tree to free.
+ */
+void freePersistentRBTree(PersistentRBTree **tree)
+{
+    if (tree == NULL || (*tree) == NULL || (*tree)->freeFunc == NULL || pthread_mutex_lock(&(*tree)->lock) != 0)
+    {
+        return;
+    }
+    bool hasViews = (*tree)->views != NULL;
+    (*tree)->closing = true;
+    pthread_mutex_unlock(&(*tree)->lock);
+    if (!hasViews)
+    {
+        destroyPersistentRBTree(*tree);
+    }
+    (*tree) = NULL;
+}
+
+
+/**
+ * take an immutable snapshot of the current version of the tree, in O(1).
+ * @param tree: the tree to take a snapshot of.
+ * @return: the snapshot, NULL on failure.
+ */
+RBTreeView *RBTreeSnapshot(PersistentRBTree *tree)
+{
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    RBTreeView *view = (RBTreeView *) malloc(sizeof(RBTreeView));
+    if (view == NULL || pthread_mutex_lock(&tree->lock) != 0)
+    {
+        free(view);
+        return NULL;
+    }
+    view->root = tree->root;
+    view->compFunc = tree->compFunc;
+    view->size = tree->size;
+    view->version = tree->version;
+    view->tree = tree;
+    view->previous = NULL;
+    view->next = tree->views;
+    if (tree->views != NULL)
+    {
+        tree->views->previous = view;
+    }
+    tree->views = view;
+    tree->sharedVersion = tree->version++;
+    pthread_mutex_unlock(&tree->lock);
+    return view;
+}
+
+
+/**
+ * check whether the snapshot contains this item.
+ * @param view: the snapshot to check an item in.
+ * @param data: item to check.
+ * @return: 0 if the item is not in the snapshot, other if it is.
+ */
+int RBTreeViewContains(const RBTreeView *view, const void *data)
+{
+    if (view == NULL || view->compFunc == NULL || data == NULL)
+    {
+        return false;
+    }
+    return persistentNodesContain(view->root, view->compFunc, data);
+}
+
+
+/**
+ * Activate a function on each item of the snapshot in ascending order.
+ * @param view: the snapshot with all the items.
+ * @param func: the function to activate on all items.
+ * @param args: more optional arguments to the function.
+ * @return: 0 on failure, other on success.
+ */
+int forEachRBTreeView(const RBTreeView *view, forEachFunc func, void *args)
+{
+    if (view == NULL || func == NULL)
+    {
+        return false;
+    }
+    return forEachPersistentNode(view->root, func, args);
+}
+
+
+/**
+ * release a snapshot, and free the nodes and items only it could still see.
+ * @param view: pointer to the snapshot to release.
+ */
+void releaseRBTreeView(RBTreeView **view)
+{
+    if (view == NULL || (*view) == NULL)
+    {
+        return;
+    }
+    PersistentRBTree *tree = (*view)->tree;
+    if (pthread_mutex_lock(&tree->lock) != 0)
+    {
+        return;
+    }
+    if ((*view)->previous != NULL)
+    {
+        (*view)->previous->next = (*view)->next;
+    }
+    else
+    {
+        tree->views = (*view)->next;
+    }
+    if ((*view)->next != NULL)
+    {
+        (*view)->next->previous = (*view)->previous;
+    }
+    free(*view);
+    (*view) = NULL;
+    tree->sharedVersion = 0;
+    for (RBTreeView *other = tree->views; other != NULL; other = other->next)
+    {
+        tree->sharedVersion = other->version > tree->sharedVersion ? other->version : tree->sharedVersion;
+    }
+    reclaim(tree);
+    bool destroy = tree->closing && tree->views == NULL;
+    pthread_mutex_unlock(&tree->lock);
+    if (destroy)
+    {
+        destroyPersistentRBTree(tree);
+    }
+}
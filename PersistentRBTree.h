@@ -0,0 +1,141 @@
+#ifndef RBTREE_PERSISTENTRBTREE_H
+#define RBTREE_PERSISTENTRBTREE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "RBTree.h"
+
+/**
+ * the maximal depth of a PersistentRBTree (2 * log2 of the maximal size, plus one).
+ */
+#define PERSISTENT_MAX_DEPTH 130
+
+/*
+ * a node of a persistent tree. a node that is part of a snapshot is never changed, writes copy it instead.
+ * there are no parent pointers, as they would force every copy to copy its children too.
+ */
+typedef struct PersistentNode
+{
+	struct PersistentNode *left, *right;
+	Color color;
+	void *data;
+	long unsigned version; // the version of the tree the node was created in.
+} PersistentNode;
+
+/*
+ * a node or an item that was removed from the tree while snapshots could still see it. it is freed once no
+ * snapshot with a version in [firstVersion, lastVersion] is alive.
+ */
+typedef struct RetiredPointer
+{
+	void *pointer;
+	bool isData; // an item to free with the FreeFunc of the tree, otherwise a PersistentNode.
+	long unsigned firstVersion, lastVersion;
+} RetiredPointer;
+
+struct PersistentRBTree;
+
+/**
+ * an immutable point in time view of a PersistentRBTree, made by RBTreeSnapshot. it can be read from any
+ * thread without locks while the tree keeps changing, until it is released.
+ */
+typedef struct RBTreeView
+{
+	PersistentNode *root;
+	CompareFunc compFunc;
+	long unsigned size;
+	long unsigned version;
+	struct PersistentRBTree *tree;
+	struct RBTreeView *next, *previous; // the list of live views of the tree.
+} RBTreeView;
+
+/**
+ * an RBTree whose inserts and deletes copy only the O(log n) nodes they change (path copying), so that
+ * taking a snapshot is O(1). writes, snapshots and releases are serialized by the lock of the tree.
+ */
+typedef struct PersistentRBTree
+{
+	PersistentNode *root;
+	CompareFunc compFunc;
+	FreeFunc freeFunc;
+	long unsigned size;
+	long unsigned version; // the version of the nodes written now, larger than the version of every view.
+	long unsigned sharedVersion; // the version of the newest live view, 0 if there is none.
+	RBTreeView *views;
+	RetiredPointer *retired;
+	size_t retiredCount, retiredCapacity;
+	PersistentNode *spareNodes; // allocated before each write, so a write never fails half way.
+	size_t spareCount;
+	bool closing; // freePersistentRBTree was called while views were alive.
+	pthread_mutex_t lock;
+} PersistentRBTree;
+
+/**
+ * constructs a new PersistentRBTree with the given CompareFunc.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free the items of the tree.
+ * @return: the new tree, NULL on failure.
+ */
+PersistentRBTree *newPersistentRBTree(CompareFunc compFunc, FreeFunc freeFunc);
+
+/**
+ * add an item to the tree. snapshots taken before do not see it.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToPersistentRBTree(PersistentRBTree *tree, void *data);
+
+/**
+ * remove an item from the tree. snapshots taken before still see it; it is freed when the last of them is
+ * released.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromPersistentRBTree(PersistentRBTree *tree, void *data);
+
+/**
+ * check whether the current version of the tree contains this item.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int PersistentRBTreeContains(PersistentRBTree *tree, const void *data);
+
+/**
+ * Activate a function on each item of the current version of the tree, in ascending order. if one of the
+ * activations of the function returns 0, the process stops. writers wait until it ends.
+ * @return: 0 on failure, other on success.
+ */
+int forEachPersistentRBTree(PersistentRBTree *tree, forEachFunc func, void *args);
+
+/**
+ * free all memory of the tree. if snapshots of the tree are still alive, the memory they can see is freed
+ * when the last of them is released. the tree may not be used after this call.
+ * @param tree: pointer to the tree to free.
+ */
+void freePersistentRBTree(PersistentRBTree **tree);
+
+/**
+ * take an immutable snapshot of the current version of the tree, in O(1).
+ * @param tree: the tree to take a snapshot of.
+ * @return: the snapshot, to release with releaseRBTreeView. NULL on failure.
+ */
+RBTreeView *RBTreeSnapshot(PersistentRBTree *tree);
+
+/**
+ * check whether the snapshot contains this item. may run in any thread, with no locks.
+ * @return: 0 if the item is not in the snapshot, other if it is.
+ */
+int RBTreeViewContains(const RBTreeView *view, const void *data);
+
+/**
+ * Activate a function on each item of the snapshot in ascending order. if one of the activations of the
+ * function returns 0, the process stops. may run in any thread, with no locks.
+ * @return: 0 on failure, other on success.
+ */
+int forEachRBTreeView(const RBTreeView *view, forEachFunc func, void *args);
+
+/**
+ * release a snapshot, and free the nodes and items only it could still see.
+ * @param view: pointer to the snapshot to release.
+ */
+void releaseRBTreeView(RBTreeView **view);
+
+#endif //RBTREE_PERSISTENTRBTREE_H
@@ -1,566 +1,2193 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdbool.h>
-#include "RBTree.h"
-
-/**
- * enum created identify easily if a Node is the right \ left child of its parent.
- */
-typedef enum Direction
-{
-    LEFT, RIGHT
-} Direction;
-
-
-/**
- * constructs a new RBTree with the given CompareFunc.
- * comp: a function two compare two variables.
- */
-RBTree *newRBTree(CompareFunc compFunc, FreeFunc freeFunc)
-{
-    RBTree * tree = NULL;
-    tree = (RBTree *) malloc (sizeof(RBTree));
-    if (tree == NULL)
-    {
-        return NULL;
-    }
-    tree->root = NULL;
-    tree->compFunc = compFunc;
-    tree->freeFunc = freeFunc;
-    tree->size = 0;
-    return tree;
-}
-
-
-/**
- * find node that contian data in it if exist, if not the parent of such node in a BST similar to our tree.
- * @param tree: RBTree to search for data in.
- * @param data: data to search for in tree.
- * @return node that contian data in it if exist, if not the parent of such node in a BST similar to our tree.
- */
-Node * findNodeLocation(const RBTree * tree, const void * data)
-{
-    Node * node = tree->root;
-    while(node != NULL)
-    {
-        int result = tree->compFunc(node->data, data);
-        if (result > 0)
-        {
-            if (node->left == NULL)
-            {
-                break;
-            }
-            node = node->left;
-            continue;
-        }
-        if (result < 0)
-        {
-            if (node->right == NULL)
-            {
-                break;
-            }
-            node = node->right;
-            continue;
-        }
-        return node;
-    }
-    return node;
-}
-
-
-/**
- * find location for data in tree.
- * @param tree: RBTree to place node in.
- * @param node: node to place in tree.
- * @return: false if the data is already in the tree, true otherwise.
- */
-bool placeNode(RBTree * tree, Node * node)
-{
-    Node * parent = findNodeLocation(tree, node->data);
-    int result = tree->compFunc(parent->data, node->data);
-    if (result == 0)
-    {
-        return false;
-    }
-    if (result > 0) { // todo go over with lab support help (switching to ? :)
-        parent->left = node;
-    } else {
-        parent->right = node;
-    }
-    node->parent = parent;
-    tree->size++;
-    return true;
-}
-
-
-/**
- * check the direction of node compared to its parent.
- * @param node: the node its direction required.
- * @return: LEFT if node is the left child of its parent, RIGHT otherwise.
- */
-Direction nodeDirection(Node *node)
-{
-    return node->data == node->parent->left->data ? LEFT : RIGHT;
-}
-
-
-/**
- * check the color of the node sibling.
- * @param node: the sibling of the node, its color required.
- * @return: RED if the color of node sibling is RED, BLACK otherwise.
- */
-Color siblingColor(Node *node)
-{
-    Node *sibling = nodeDirection(node) == RIGHT ? node->parent->left : node->parent->right;
-    return (sibling != NULL && sibling->color == RED) ? RED : BLACK;
-}
-
-
-/**
- * recolor the parent and the uncle and the grandparent of node if the node, its parent and its uncle are RED.
- * @param node: a red Node with a red parent which require recoloring.
- * @return: NULL if rotation isn't required, otherwise the Node require rotation.
- */
-Node * recolor(Node *node)
-{
-    while (node->parent != NULL)
-    {
-        node->color = RED;
-        if (node->parent->color == BLACK)
-        {
-            return NULL;
-        }
-        if (siblingColor(node->parent) == BLACK)
-        {
-            return node;
-        }
-        node = node->parent->parent;
-        node->left->color = BLACK;
-        node->right->color = BLACK;
-    }
-    return NULL;
-}
-
-
-/**
- * set newParent as the parent of node.
- * @param node: the Node require resetting its parent.
- * @param newParent: the new parent of node.
- */
-void setParent(Node *node, Node * newParent)
-{
-    node->parent = newParent;
-}
-
-
- /**
-  * set newChild as the left child of node.
-  * @param node: the Node require resetting its left child.
-  * @param newChild: the new left child of node.
-  */
-void setLeftChild(Node * node, Node *newChild)
-{
-    node->left = newChild;
-}
-
-
-/**
- * set newChild as the right child of node.
- * @param node: the Node require resetting its right child.
- * @param newChild: the new right child of node.
- */
-void setRightChild(Node * node, Node *newChild)
-{
-    node->right = newChild;
-}
-
-
-/**
- * set node as the new root of tree.
- * @param tree: the RBTree require resetting its root.
- * @param node: the new root of tree.
- */
-void setRoot(RBTree *tree, Node *node)
-{
-    setParent(node, NULL);
-    node->color = BLACK;
-    tree->root = node;
-}
-
-
-/**
- * switching the colors of node1 and node2.
- * @param node1: a Node object.
- * @param node2: a Node object.
- */
-void switchColors(Node *node1, Node * node2)
-{
-    Color temp = node1->color;
-    node1->color = node2->color;
-    node2->color = temp;
-}
-
-
-/**
- * rotate parent to the direction in rotationDirection.
- * @param tree: the RBTree containing the Nodes node and parent.
- * @param parent: the node required rotation.
- * @param node: a child of the node required rotation in the opposite direction then rotationDirection.
- * @param rotationDirection: the direction of the rotation.
- */
-void rotate(RBTree *tree, Node *parent, Node *node, Direction rotationDirection)
-{
-    if (parent->parent == NULL)
-    {
-        tree->root = node;
-    }
-    else
-    {
-        nodeDirection(parent) == LEFT ? setLeftChild(parent->parent, node) : setRightChild(parent->parent, node);
-    }
-    setParent(node, parent->parent);
-
-    Node * child = rotationDirection == LEFT ? node->left : node->right;
-    rotationDirection == LEFT ? setRightChild(parent, child) : setLeftChild(parent, child);
-    if (child != NULL)
-    {
-        setParent(child, parent);
-    }
-
-    setParent(parent, node);
-    rotationDirection == LEFT ? setLeftChild(node, parent) : setRightChild(node, parent);
-}
-
-
-/**
- * implement the right rotation by the directions of node and its parent.
- * @param tree: a tree containing node.
- * @param node: the Node required rotation.
- */
-void rotation(RBTree *tree, Node *node)
-{
-    if (nodeDirection(node) == LEFT && nodeDirection(node->parent) == LEFT) // Left Left Case
-    {
-        node = node->parent;
-        rotate(tree, node->parent, node, RIGHT);
-        switchColors(node, node->right);
-    }
-    else if (nodeDirection(node) == LEFT) // Right Left Case
-    {
-        rotate(tree, node->parent, node, RIGHT);
-        rotate(tree, node->parent, node, LEFT);
-        switchColors(node, node->left);
-    }
-    else if (nodeDirection(node) == RIGHT && nodeDirection(node->parent) == RIGHT) // Right Right Case
-    {
-        node = node->parent;
-        rotate(tree, node->parent, node, LEFT);
-        switchColors(node, node->left);
-    }
-    else if (nodeDirection(node) == RIGHT) // Left Right Case
-    {
-        rotate(tree, node->parent, node, LEFT);
-        rotate(tree, node->parent, node, RIGHT);
-        switchColors(node, node->right);
-    }
-}
-
-
-Node * getNewNode(void *data)
-{
-    Node * node = NULL;
-    node = (Node *) malloc(sizeof(Node));
-    if (node == NULL)
-    {
-        free(node);
-        return NULL;
-    }
-    node->data = data;
-    node->parent = NULL;
-    node->left = NULL;
-    node->right = NULL;
-    return node;
-}
-
-
-/**
- * add an item to the tree
- * @param tree: the tree to add an item to.
- * @param data: item to add to the tree.
- * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
- */
-int insertToRBTree(RBTree *tree, void *data)
-{
-    if (tree == NULL || data == NULL || tree->compFunc == NULL || (tree->root != NULL && tree->size != sizeof(*data)))
-    {
-        return false;
-    }
-    Node * node = getNewNode(data);
-    if (node == NULL)
-    {
-        return false;
-    }
-    if (tree->root == NULL) // empty tree
-    {
-        setRoot(tree, node);
-        tree->size++;
-        return true;
-    }
-    node->color = RED;
-    if (!placeNode(tree, node))
-    {
-        return false;
-    }
-    if (node->parent->color == BLACK) // black parent
-    {
-        return true;
-    }
-    if ((node = recolor(node)) == NULL) // black parent after recolor
-    {
-        return true;
-    }
-    rotation(tree, node); // rotating the subtree
-    return true;
-}
-
-
-/**
- * remove a red Node with at most one child from the tree by linking its parent to its child.
- * @param node: the node to remove from the tree.
- * @param child: the child of node if one exist, if not null.
- */
-void removeRedNode(Node *node, Node *child)
-{
-    nodeDirection(node) == LEFT ? setLeftChild(node->parent, child) : setRightChild(node->parent, child);
-    if (child != NULL)
-    {
-        setParent(child, node->parent);
-    }
-}
-
-
-/**
- * handle case where one of the Nodes in an RBTree is a double black node.
- * @param tree: a RBTree that contain a double black Node.
- * @param node: the double black node in tree.
- * @param direction: the direction from node to one of is existing children.
- */
-void doubleBlackNode(RBTree *tree, Node *node, Direction direction)
-{
-    Node * child = direction == LEFT ? node->left : node->right;
-    if (child->color == RED)
-    {
-        rotate(tree, node, child, !direction);
-        doubleBlackNode(tree, node, direction);
-    }
-    else if ((direction == LEFT ? child->right : child->left) != NULL)
-    {
-        child->color = node->color;
-        node->color = BLACK;
-        (direction == LEFT ? child->left : child->right)->color = BLACK;
-        rotate(tree, node, child, !direction);
-    }
-    else if ((direction == LEFT ? child->left : child->right) != NULL)
-    {
-        rotate(tree, node, child, direction);
-        doubleBlackNode(tree, node, direction);
-    }
-    else if (node->color == RED)
-    {
-        node->color = BLACK;
-        child->color = RED;
-    }
-}
-
-
-
-/**
- * remove a black Node with at most one child and a parent from the tree by linking its parent to its child.
- * @param tree: a RBTree that contain node and child.
- * @param node: the node to remove from the tree.
- * @param child: a child of node if exist one, if not null.
- */
-void removeBlackNode(RBTree *tree, Node *node, Node *child)
-{
-    Direction direction = nodeDirection(node);
-    direction == LEFT ? setLeftChild(node->parent, child) : setRightChild(node->parent, child);
-    if (child != NULL)
-    {
-        setParent(child, node->parent);
-    }
-    doubleBlackNode(tree, node->parent, direction);
-}
-
-
-/**
- * remove the node from the RBTree tree and delete it.
- * @param tree: a RBTree tree containing node.
- * @param node: a Node contained in tree to remove from it and than delete it.
- */
-void deleteNode(RBTree *tree, Node * node)
-{
-    Node * successor = node;
-    if (node->left != NULL && node->right != NULL)
-    {
-        successor = node->right;
-        while (successor->left != NULL)
-        {
-            successor = successor->left;
-        }
-        node->data = successor->data;
-    }
-    Node * child = node->left == NULL ? node->right : node->left;
-    if (successor->color == RED)
-    {
-        removeRedNode(successor, child);
-    }
-    else if (successor->parent == NULL)
-    {
-        child == NULL ? tree->root = NULL : setRoot(tree, child);
-    }
-    else if (child->color == RED)
-    {
-        child->color = BLACK;
-        removeRedNode(successor, child);
-    }
-    else
-    {
-        removeBlackNode(tree, successor, child);
-    }
-    free(successor);
-}
-
-
-/**
- * remove an item from the tree
- * @param tree: the tree to remove an item from.
- * @param data: item to remove from the tree.
- * @return: 0 on failure, other on success. (if data is not in the tree - failure).
- */
-int deleteFromRBTree(RBTree *tree, void *data)
-{
-    if (tree == NULL || tree->root == NULL || tree->compFunc == NULL || tree->freeFunc == NULL || data == NULL)
-    {
-        return false;
-    }
-    Node * node = findNodeLocation(tree, data);
-    if (tree->compFunc(node->data, data) != 0)
-    {
-        return false;
-    }
-    tree->freeFunc(node->data);
-    deleteNode(tree, node);
-    tree->size--;
-    return true;
-}
-
-
-/**
- * check whether the tree RBTree Contains this item.
- * @param tree: the tree to check an item in.
- * @param data: item to check.
- * @return: 0 if the item is not in the tree, other if it is.
- */
-int RBTreeContains(const RBTree *tree, const void *data)
-{
-    if (tree == NULL || tree->compFunc == NULL || data == NULL)
-    {
-        return false;
-    }
-    return tree->compFunc(findNodeLocation(tree, data)->data, data) == 0;
-}
-
-
-/**
- * doing operation on the data in a sub tree by going over it recursively,
- * first the left child then the node itself and finely the right child.
- * @param node: the root of the sub tree.
- * @param func: the operation to do on the data in the tree.
- * @param args: an argument that func might need to operate right.
- * @return: true if the operation was successful, false otherwise.
- */
-bool forEachElementInTree(const Node *node, forEachFunc func, void *args)
-{
-    if (node == NULL)
-    {
-        return true;
-    }
-    if (!forEachElementInTree(node->left, func, args))
-    {
-        return false;
-    }
-    if (!func(node->data, args))
-    {
-        return false;
-    }
-    if (!forEachElementInTree(node->right, func, args))
-    {
-        return false;
-    }
-    return true;
-}
-
-
-/**
- * Activate a function on each item of the tree. the order is an ascending order. if one of the activations of the
- * function returns 0, the process stops.
- * @param tree: the tree with all the items.
- * @param func: the function to activate on all items.
- * @param args: more optional arguments to the function (may be null if the given function support it).
- * @return: 0 on failure, other on success.
- */
-int forEachRBTree(const RBTree *tree, forEachFunc func, void *args)
-{
-    if (tree == NULL || func == NULL)
-    {
-        return false;
-    }
-    return forEachElementInTree(tree->root, func, args);
-}
-
-
-/**
- * this function free a single node.
- * @param node: a Node object to free.
- * @param func: the function to free the node data.
- */
-void freeNode(Node **node, FreeFunc func)
-{
-    func((*node)->data);
-    (*node)->data = NULL; (*node)->parent = NULL; (*node)->left = NULL; (*node)->right = NULL;
-    free(*node);
-    (*node) = NULL;
-}
-
-
-/**
- * free a sub tree by going over it recursively, first its children and the node itself.
- * @param node: the root of the sub tree.
- * @param func: the function to free the nodes data.
- */
-void deleteEachElementInTree(Node **node, FreeFunc func)
-{
-    if ((*node) == NULL)
-    {
-        return;
-    }
-    deleteEachElementInTree(&(*node)->left, func);
-    deleteEachElementInTree(&(*node)->right, func);
-    freeNode(node, func);
-}
-
-
-/**
- * free all memory of the data structure.
- * @param tree: pointer to the tree to free.
- */
-void freeRBTree(RBTree **tree)
-{
-    if (tree == NULL || (*tree) == NULL || (*tree)->freeFunc == NULL)
-    {
-        return;
-    }
-    deleteEachElementInTree(&(*tree)->root, (*tree)->freeFunc);
-    (*tree)->root = NULL;
-    free((*tree));
-}
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include "RBTree.h"
+#include "NodePool.h"
+#include "RBTreeInternal.h"
+
+/**
+ * enum created identify easily if a Node is the right \ left child of its parent.
+ */
+typedef enum Direction
+{
+    LEFT, RIGHT
+} Direction;
+
+
+#ifdef RBTREE_STATS
+/**
+ * count a search of the tree that compared data with depth nodes.
+ */
+void recordSearch(const RBTree *tree, long unsigned depth)
+{
+    RBTreeStats *stats = tree->stats;
+    __atomic_fetch_add(&stats->searches, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->comparisons, depth, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->totalSearchDepth, depth, __ATOMIC_RELAXED);
+    long unsigned max = __atomic_load_n(&stats->maxSearchDepth, __ATOMIC_RELAXED);
+    while (depth > max && !__atomic_compare_exchange_n(&stats->maxSearchDepth, &max, depth, true,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+
+/**
+ * @return: the time of a monotonic clock, in nanoseconds.
+ */
+long unsigned statsNow(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (long unsigned) time.tv_sec * 1000000000ul + (long unsigned) time.tv_nsec;
+}
+
+
+/**
+ * count an operation of the tree that started at start in the latency histogram of the operation.
+ */
+void recordLatency(const RBTree *tree, RBTreeOperation operation, long unsigned start)
+{
+    long unsigned nanoseconds = statsNow() - start;
+    int bucket = nanoseconds == 0 ? 0 : (int) (sizeof(long unsigned) * 8 - 1) - __builtin_clzl(nanoseconds);
+    bucket = bucket < RBTREE_LATENCY_BUCKETS ? bucket : RBTREE_LATENCY_BUCKETS - 1;
+    __atomic_fetch_add(&tree->stats->latency[operation][bucket], 1, __ATOMIC_RELAXED);
+}
+#endif
+
+
+/**
+ * constructs a new RBTree with the given CompareFunc.
+ * comp: a function two compare two variables.
+ */
+RBTree *newRBTree(CompareFunc compFunc, FreeFunc freeFunc)
+{
+    RBTree * tree = NULL;
+    tree = (RBTree *) malloc (sizeof(RBTree));
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    tree->root = NULL;
+    tree->compFunc = compFunc;
+    tree->freeFunc = freeFunc;
+    tree->size = 0;
+    tree->pool = NULL;
+    tree->sizeFunc = NULL;
+    tree->dataBytes = 0;
+    tree->finger = NULL;
+    tree->sequential = false;
+#ifdef RBTREE_MAX_WEIGHT
+    tree->weightFunc = NULL;
+#endif
+#ifdef RBTREE_STATS
+    tree->stats = (RBTreeStats *) calloc(1, sizeof(RBTreeStats));
+    if (tree->stats == NULL)
+    {
+        free(tree);
+        return NULL;
+    }
+#endif
+    return tree;
+}
+
+
+/**
+ * constructs a new RBTree that allocates its nodes from pool instead of malloc.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free the items of the tree.
+ * @param pool: the NodePool to allocate nodes from, owned by the tree from now on.
+ * @return: the new tree, NULL on failure.
+ */
+RBTree *newRBTreeWithPool(CompareFunc compFunc, FreeFunc freeFunc, NodePool *pool)
+{
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+    RBTree *tree = newRBTree(compFunc, freeFunc);
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    tree->pool = pool;
+    return tree;
+}
+
+
+/**
+ * find node that contian data in it if exist, if not the parent of such node, in the sub tree of node.
+ * @param depth: the number of comparisons made before, counted with the ones of the sub tree.
+ * @param result: set to the result of comparing the data of the returned node with data (1 if it is NULL).
+ */
+Node * findNodeBelow(const RBTree * tree, Node * node, const void * data, long unsigned depth, int *result)
+{
+    *result = 1;
+    while(node != NULL)
+    {
+        int comparison = tree->compFunc(node->data, data);
+        depth++;
+        Node * next = comparison > 0 ? node->left : node->right;
+        if (comparison == 0 || next == NULL)
+        {
+            *result = comparison;
+            break;
+        }
+        node = next;
+    }
+    STATS_SEARCH(tree, depth);
+    return node;
+}
+
+
+/**
+ * find node that contian data in it if exist, if not the parent of such node in a BST similar to our tree.
+ * @param tree: RBTree to search for data in.
+ * @param data: data to search for in tree.
+ * @param result: set to the result of comparing the data of the returned node with data (1 if it is NULL).
+ * @return node that contian data in it if exist, if not the parent of such node in a BST similar to our tree.
+ */
+Node * findNodeLocation(const RBTree * tree, const void * data, int *result)
+{
+    return findNodeBelow(tree, tree->root, data, 0, result);
+}
+
+
+/**
+ * like findNodeLocation, but the search starts at hint, a node of the tree near data (finger search): if data
+ * falls between hint and its neighbour the place is found in O(1) amortized, otherwise the search climbs from
+ * the neighbour through the parent pointers to the lowest sub tree that holds the place of data, and goes down
+ * from there, in O(log d) for d items between hint and data.
+ * @param hint: a node of tree.
+ */
+Node * findNodeNear(const RBTree * tree, Node * hint, const void * data, int *result)
+{
+    if (hint == tree->root)
+    {
+        return findNodeLocation(tree, data, result);
+    }
+    int comparison = tree->compFunc(hint->data, data);
+    if (comparison == 0)
+    {
+        *result = 0;
+        STATS_SEARCH(tree, 1);
+        return hint;
+    }
+    Direction direction = comparison < 0 ? RIGHT : LEFT; // the direction from hint to data.
+    Node * neighbour = direction == RIGHT ? successorNode(hint) : predecessorNode(hint);
+    int neighbourComparison = neighbour == NULL ? 0 : tree->compFunc(neighbour->data, data);
+    long unsigned depth = neighbour == NULL ? 1 : 2;
+    if (neighbour != NULL && neighbourComparison == 0)
+    {
+        *result = 0;
+        STATS_SEARCH(tree, depth);
+        return neighbour;
+    }
+    if (neighbour == NULL || (neighbourComparison < 0) != (comparison < 0))
+    {
+        // data is between hint and its neighbour: its place is the free child of one of them.
+        Node * child = direction == RIGHT ? hint->right : hint->left;
+        *result = child == NULL ? comparison : neighbourComparison;
+        STATS_SEARCH(tree, depth);
+        return child == NULL ? hint : neighbour;
+    }
+    Node * node = neighbour;
+    for (Node * parent = nodeParent(node); parent != NULL; node = parent, parent = nodeParent(node))
+    {
+        if (direction == RIGHT ? node == parent->right : node == parent->left)
+        {
+            continue; // parent is on the side of hint, so data is beyond it too.
+        }
+        int parentComparison = tree->compFunc(parent->data, data);
+        depth++;
+        if (parentComparison == 0)
+        {
+            *result = 0;
+            STATS_SEARCH(tree, depth);
+            return parent;
+        }
+        if ((parentComparison < 0) != (comparison < 0))
+        {
+            break; // parent is beyond data, so the place of data is in the sub tree of node.
+        }
+    }
+    return findNodeBelow(tree, node, data, depth, result);
+}
+
+
+/**
+ * get the number of nodes in a sub tree.
+ * @param node: the root of the sub tree, may be NULL.
+ * @return: the number of nodes in the sub tree.
+ */
+long unsigned subtreeSize(const Node *node)
+{
+#ifdef RBTREE_ORDER_STATISTICS
+    return node == NULL ? 0 : node->subtreeSize;
+#else
+    (void) node;
+    return 0;
+#endif
+}
+
+
+/**
+ * recompute the fields of node that summarize its sub tree, from the fields of its children.
+ * @param node: the node to update.
+ */
+void updateNode(Node *node)
+{
+#ifdef RBTREE_ORDER_STATISTICS
+    node->subtreeSize = subtreeSize(node->left) + subtreeSize(node->right) + 1;
+#endif
+#ifdef RBTREE_MAX_WEIGHT
+    // strictly heavier only, so that the first heaviest node in ascending order is kept.
+    Node * heaviest = node->left == NULL ? node : node->left->maxWeightNode;
+    if (node->weight > heaviest->weight)
+    {
+        heaviest = node;
+    }
+    if (node->right != NULL && node->right->maxWeightNode->weight > heaviest->weight)
+    {
+        heaviest = node->right->maxWeightNode;
+    }
+    node->maxWeightNode = heaviest;
+#endif
+#ifndef RBTREE_AUGMENTED
+    (void) node;
+#endif
+}
+
+
+/**
+ * update node and all of its ancestors after a node was linked or unlinked under node.
+ * @param node: the lowest node whose sub tree changed, may be NULL.
+ */
+void updatePathToRoot(Node *node)
+{
+    for (; node != NULL; node = nodeParent(node))
+    {
+        updateNode(node);
+    }
+}
+
+
+/**
+ * check the direction of node compared to its parent.
+ * @param node: the node its direction required.
+ * @return: LEFT if node is the left child of its parent, RIGHT otherwise.
+ */
+Direction nodeDirection(Node *node)
+{
+    return node == nodeParent(node)->left ? LEFT : RIGHT;
+}
+
+
+/**
+ * check the color of the node sibling.
+ * @param node: the sibling of the node, its color required.
+ * @return: RED if the color of node sibling is RED, BLACK otherwise.
+ */
+Color siblingColor(Node *node)
+{
+    Node *sibling = nodeDirection(node) == RIGHT ? nodeParent(node)->left : nodeParent(node)->right;
+    return (sibling != NULL && nodeColor(sibling) == RED) ? RED : BLACK;
+}
+
+
+/**
+ * recolor the parent and the uncle and the grandparent of node if the node, its parent and its uncle are RED.
+ * @param tree: the tree containing node.
+ * @param node: a red Node with a red parent which require recoloring.
+ * @return: NULL if rotation isn't required, otherwise the Node require rotation.
+ */
+Node * recolor(const RBTree *tree, Node *node)
+{
+    while (nodeParent(node) != NULL)
+    {
+        setNodeColor(node, RED);
+        if (nodeColor(nodeParent(node)) == BLACK)
+        {
+            return NULL;
+        }
+        if (siblingColor(nodeParent(node)) == BLACK)
+        {
+            return node;
+        }
+        STATS_ADD(tree, recolors, 1);
+        node = nodeParent(nodeParent(node));
+        setNodeColor(node->left, BLACK);
+        setNodeColor(node->right, BLACK);
+    }
+    return NULL;
+}
+
+
+/**
+ * set newParent as the parent of node.
+ * @param node: the Node require resetting its parent.
+ * @param newParent: the new parent of node.
+ */
+void setParent(Node *node, Node * newParent)
+{
+    setNodeParent(node, newParent);
+}
+
+
+ /**
+  * set newChild as the left child of node.
+  * @param node: the Node require resetting its left child.
+  * @param newChild: the new left child of node.
+  */
+void setLeftChild(Node * node, Node *newChild)
+{
+    node->left = newChild;
+}
+
+
+/**
+ * set newChild as the right child of node.
+ * @param node: the Node require resetting its right child.
+ * @param newChild: the new right child of node.
+ */
+void setRightChild(Node * node, Node *newChild)
+{
+    node->right = newChild;
+}
+
+
+/**
+ * set node as the new root of tree.
+ * @param tree: the RBTree require resetting its root.
+ * @param node: the new root of tree.
+ */
+void setRoot(RBTree *tree, Node *node)
+{
+    setParent(node, NULL);
+    setNodeColor(node, BLACK);
+    tree->root = node;
+}
+
+
+/**
+ * link node as a child of parent, which was found by findNodeLocation.
+ * @param tree: RBTree to link node in.
+ * @param parent: the parent of the new node.
+ * @param node: the node to link.
+ * @param result: the result of comparing the data of parent with the data of node (not 0).
+ */
+void linkNode(RBTree * tree, Node * parent, Node * node, int result)
+{
+    result > 0 ? setLeftChild(parent, node) : setRightChild(parent, node);
+    setParent(node, parent);
+#ifdef RBTREE_AUGMENTED
+    updatePathToRoot(parent);
+#endif
+    tree->size++;
+}
+
+
+/**
+ * switching the colors of node1 and node2.
+ * @param node1: a Node object.
+ * @param node2: a Node object.
+ */
+void switchColors(Node *node1, Node * node2)
+{
+    Color temp = nodeColor(node1);
+    setNodeColor(node1, nodeColor(node2));
+    setNodeColor(node2, temp);
+}
+
+
+/**
+ * rotate parent to the direction in rotationDirection.
+ * @param tree: the RBTree containing the Nodes node and parent.
+ * @param parent: the node required rotation.
+ * @param node: a child of the node required rotation in the opposite direction then rotationDirection.
+ * @param rotationDirection: the direction of the rotation.
+ */
+void rotate(RBTree *tree, Node *parent, Node *node, Direction rotationDirection)
+{
+    STATS_ADD(tree, rotations, 1);
+    Node * grandparent = nodeParent(parent);
+    if (grandparent == NULL)
+    {
+        tree->root = node;
+    }
+    else
+    {
+        nodeDirection(parent) == LEFT ? setLeftChild(grandparent, node) : setRightChild(grandparent, node);
+    }
+    setParent(node, grandparent);
+
+    Node * child = rotationDirection == LEFT ? node->left : node->right;
+    rotationDirection == LEFT ? setRightChild(parent, child) : setLeftChild(parent, child);
+    if (child != NULL)
+    {
+        setParent(child, parent);
+    }
+
+    setParent(parent, node);
+    rotationDirection == LEFT ? setLeftChild(node, parent) : setRightChild(node, parent);
+    updateNode(parent);
+    updateNode(node);
+}
+
+
+/**
+ * implement the right rotation by the directions of node and its parent.
+ * @param tree: a tree containing node.
+ * @param node: the Node required rotation.
+ */
+void rotation(RBTree *tree, Node *node)
+{
+    if (nodeDirection(node) == LEFT && nodeDirection(nodeParent(node)) == LEFT) // Left Left Case
+    {
+        node = nodeParent(node);
+        rotate(tree, nodeParent(node), node, RIGHT);
+        switchColors(node, node->right);
+    }
+    else if (nodeDirection(node) == LEFT) // Right Left Case
+    {
+        rotate(tree, nodeParent(node), node, RIGHT);
+        rotate(tree, nodeParent(node), node, LEFT);
+        switchColors(node, node->left);
+    }
+    else if (nodeDirection(node) == RIGHT && nodeDirection(nodeParent(node)) == RIGHT) // Right Right Case
+    {
+        node = nodeParent(node);
+        rotate(tree, nodeParent(node), node, LEFT);
+        switchColors(node, node->left);
+    }
+    else if (nodeDirection(node) == RIGHT) // Left Right Case
+    {
+        rotate(tree, nodeParent(node), node, LEFT);
+        rotate(tree, nodeParent(node), node, RIGHT);
+        switchColors(node, node->right);
+    }
+}
+
+
+/**
+ * allocate a new node for data, from the pool of tree if it has one.
+ * @param tree: the tree the node is allocated for.
+ * @param data: the data of the new node.
+ * @return: the new node, NULL on failure.
+ */
+Node * getNewNode(RBTree *tree, void *data)
+{
+    Node * node = NULL;
+    node = tree->pool == NULL ? (Node *) malloc(sizeof(Node)) : allocateFromNodePool(tree->pool);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    STATS_ADD(tree, allocations, 1);
+    if (tree->sizeFunc != NULL)
+    {
+        tree->dataBytes += tree->sizeFunc(data);
+    }
+    node->data = data;
+    setNodeParentAndColor(node, NULL, RED);
+    node->left = NULL;
+    node->right = NULL;
+#ifdef RBTREE_MAX_WEIGHT
+    node->weight = tree->weightFunc == NULL ? 0 : tree->weightFunc(data);
+#endif
+    updateNode(node);
+    return node;
+}
+
+
+/**
+ * release a node that is no longer linked to tree, to the pool of tree if it has one.
+ * @param tree: the tree the node was allocated for.
+ * @param node: the node to release, its data not freed yet.
+ */
+void releaseNode(RBTree *tree, Node *node)
+{
+    if (tree->sizeFunc != NULL)
+    {
+        tree->dataBytes -= tree->sizeFunc(node->data);
+    }
+    if (tree->finger == node)
+    {
+        tree->finger = NULL;
+    }
+    tree->pool == NULL ? free(node) : releaseToNodePool(tree->pool, node);
+}
+
+
+/**
+ * link a new node to the tree and fix the colors of the tree.
+ * @param tree: the tree to add the node to.
+ * @param parent: the parent of the new node found by findNodeLocation, NULL if the tree is empty.
+ * @param node: a new node that is not in the tree.
+ * @param result: the result of comparing the data of parent with the data of node (not 0).
+ */
+void insertNode(RBTree *tree, Node *parent, Node *node, int result)
+{
+    if (parent == NULL) // empty tree
+    {
+        setRoot(tree, node);
+        tree->size++;
+        return;
+    }
+    setNodeColor(node, RED);
+    linkNode(tree, parent, node, result);
+    fixRedNode(tree, node);
+}
+
+
+/**
+ * fix the colors of the tree after a red node was linked under a parent that is not the root.
+ * @param tree: the tree containing node.
+ * @param node: the red node.
+ */
+void fixRedNode(RBTree *tree, Node *node)
+{
+    if (nodeColor(nodeParent(node)) == BLACK) // black parent
+    {
+        return;
+    }
+    if ((node = recolor(tree, node)) == NULL) // black parent after recolor
+    {
+        return;
+    }
+    rotation(tree, node); // rotating the subtree
+}
+
+
+/**
+ * insertNode, and make the new node the finger of the tree (see sequentialFinger).
+ * @param parent: the parent of the new node found by findNodeLocation or findNodeNear.
+ */
+void insertNodeWithFinger(RBTree *tree, Node *parent, Node *node, int result)
+{
+    insertNode(tree, parent, node, result);
+    // in ascending (descending) order each new node is the right (left) child of the one before.
+    tree->sequential = tree->finger != NULL && parent == tree->finger;
+    tree->finger = node;
+}
+
+
+/**
+ * find the node of the item of the tree that is equal to data, or add data to the tree in a new node, without
+ * measuring the latency.
+ * @param hint: the node to start the search from (see findNodeNear), NULL to start from the root.
+ * @param inserted: set to whether data was added.
+ * @return: the node of data or of the item equal to it, NULL on failure.
+ */
+Node * findOrInsertItem(RBTree *tree, void *data, Node *hint, bool *inserted)
+{
+    *inserted = false;
+    if (tree == NULL || data == NULL || tree->compFunc == NULL)
+    {
+        return NULL;
+    }
+    int result;
+    Node * parent = hint == NULL ? findNodeLocation(tree, data, &result) : findNodeNear(tree, hint, data, &result);
+    if (result == 0)
+    {
+        return parent;
+    }
+    Node * node = getNewNode(tree, data);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    insertNodeWithFinger(tree, parent, node, result);
+    *inserted = true;
+    return node;
+}
+
+
+/**
+ * findOrInsertItem, counted in the latency histogram of inserts.
+ */
+Node * findOrInsertWithLatency(RBTree *tree, void *data, Node *hint, bool *inserted)
+{
+#ifdef RBTREE_STATS
+    long unsigned start = statsNow();
+    Node * node = findOrInsertItem(tree, data, hint, inserted);
+    if (tree != NULL)
+    {
+        recordLatency(tree, RBTREE_INSERT, start);
+    }
+    return node;
+#else
+    return findOrInsertItem(tree, data, hint, inserted);
+#endif
+}
+
+
+/**
+ * @return: the node the next insert to tree starts from: the last inserted node while the inserts are
+ * sequential, NULL (the root) otherwise.
+ */
+Node * sequentialFinger(const RBTree *tree)
+{
+    return tree != NULL && tree->sequential ? tree->finger : NULL;
+}
+
+
+/**
+ * add an item to the tree
+ * @param tree: the tree to add an item to.
+ * @param data: item to add to the tree.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToRBTree(RBTree *tree, void *data)
+{
+    bool inserted;
+    findOrInsertWithLatency(tree, data, sequentialFinger(tree), &inserted);
+    return inserted;
+}
+
+
+/**
+ * add an item to the tree, searching for its place from hint instead of from the root (see findNodeNear).
+ * @param tree: the tree to add an item to.
+ * @param data: item to add to the tree.
+ * @param hint: a node of tree. NULL for the last inserted node (or the root if there is none).
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToRBTreeWithHint(RBTree *tree, void *data, const Node *hint)
+{
+    bool inserted;
+    findOrInsertWithLatency(tree, data, (Node *) (hint != NULL || tree == NULL ? hint : tree->finger), &inserted);
+    return inserted;
+}
+
+
+/**
+ * find the item of the tree that is equal to data, or add data to the tree if there is none, with one search.
+ * @param tree: the tree to search in.
+ * @param data: item to find or add.
+ * @param existing: set to the item of the tree equal to data, which is data itself if it was added.
+ * @return: 0 on failure (existing is set to NULL and data is not added), other on success.
+ */
+int RBTreeFindOrInsert(RBTree *tree, void *data, void **existing)
+{
+    if (existing == NULL)
+    {
+        return false;
+    }
+    bool inserted;
+    Node * node = findOrInsertWithLatency(tree, data, sequentialFinger(tree), &inserted);
+    *existing = node == NULL ? NULL : node->data;
+    return node != NULL;
+}
+
+
+/**
+ * merge data into the item of node with mergeFunc, measure the item again and free data.
+ * @return: false if mergeFunc failed (data is not freed), true otherwise.
+ */
+bool mergeIntoNode(RBTree *tree, Node *node, void *data, MergeFunc mergeFunc)
+{
+    if (tree->sizeFunc != NULL)
+    {
+        tree->dataBytes -= tree->sizeFunc(node->data);
+    }
+    bool merged = mergeFunc(node->data, data);
+    if (tree->sizeFunc != NULL)
+    {
+        tree->dataBytes += tree->sizeFunc(node->data);
+    }
+    if (!merged)
+    {
+        return false;
+    }
+#ifdef RBTREE_MAX_WEIGHT
+    node->weight = tree->weightFunc == NULL ? 0 : tree->weightFunc(node->data);
+    updatePathToRoot(node);
+#endif
+    tree->freeFunc(data);
+    return true;
+}
+
+
+/**
+ * add data to the tree, or merge it into the item of the tree that is equal to it, with one search.
+ * @param tree: the tree to add the item to.
+ * @param data: item to add, owned by the tree on success (freed if it was merged).
+ * @param mergeFunc: merges data into the equal item of the tree.
+ * @return: 0 on failure, other on success.
+ */
+int RBTreeUpsert(RBTree *tree, void *data, MergeFunc mergeFunc)
+{
+    if (mergeFunc == NULL || tree == NULL || tree->freeFunc == NULL)
+    {
+        return false;
+    }
+    bool inserted;
+    Node * node = findOrInsertWithLatency(tree, data, sequentialFinger(tree), &inserted);
+    return node != NULL && (inserted || mergeIntoNode(tree, node, data, mergeFunc));
+}
+
+
+/**
+ * merge the sorted ranges items[low..middle) and items[middle..high) using buffer, moving indices (if not
+ * NULL) along with their items.
+ */
+void mergeItems(void **items, size_t *indices, void **itemsBuffer, size_t *indicesBuffer, size_t low,
+                size_t middle, size_t high, CompareFunc compFunc)
+{
+    size_t i = low, j = middle, k = 0;
+    while (i < middle || j < high)
+    {
+        size_t from = (j == high || (i < middle && compFunc(items[i], items[j]) <= 0)) ? i++ : j++;
+        itemsBuffer[k] = items[from];
+        if (indices != NULL)
+        {
+            indicesBuffer[k] = indices[from];
+        }
+        k++;
+    }
+    for (k = 0; k < high - low; ++k)
+    {
+        items[low + k] = itemsBuffer[k];
+        if (indices != NULL)
+        {
+            indices[low + k] = indicesBuffer[k];
+        }
+    }
+}
+
+
+/**
+ * stable bottom up merge sort of items in ascending order.
+ * @param items: the items to sort.
+ * @param indices: array that is permuted along with items, may be NULL.
+ * @param n: number of items.
+ * @param compFunc: the function to compare items with.
+ * @return: false on allocation failure (items are left unchanged), true otherwise.
+ */
+bool sortItems(void **items, size_t *indices, size_t n, CompareFunc compFunc)
+{
+    if (n < 2)
+    {
+        return true;
+    }
+    void **itemsBuffer = (void **) malloc(n * sizeof(void *));
+    size_t *indicesBuffer = indices == NULL ? NULL : (size_t *) malloc(n * sizeof(size_t));
+    if (itemsBuffer == NULL || (indices != NULL && indicesBuffer == NULL))
+    {
+        free(itemsBuffer);
+        free(indicesBuffer);
+        return false;
+    }
+    for (size_t width = 1; width < n; width *= 2)
+    {
+        for (size_t low = 0; low + width < n; low += 2 * width)
+        {
+            size_t high = low + 2 * width < n ? low + 2 * width : n;
+            mergeItems(items, indices, itemsBuffer, indicesBuffer, low, low + width, high, compFunc);
+        }
+    }
+    free(itemsBuffer);
+    free(indicesBuffer);
+    return true;
+}
+
+
+/**
+ * link nodes that are sorted in ascending order into a balanced sub tree, splitting at the middle. all the
+ * levels but the last are full, so the nodes of an incomplete last level are colored RED and all the others
+ * BLACK.
+ * @param nodes: the sorted nodes.
+ * @param n: number of nodes.
+ * @param parent: the parent of the sub tree.
+ * @param depth: the depth of the root of the sub tree.
+ * @param redDepth: the depth of the last level if it is incomplete, otherwise a depth that is never reached.
+ * @return: the root of the sub tree.
+ */
+Node * linkSortedNodes(Node **nodes, size_t n, Node *parent, unsigned int depth, unsigned int redDepth)
+{
+    if (n == 0)
+    {
+        return NULL;
+    }
+    size_t middle = n / 2;
+    Node * node = nodes[middle];
+    setNodeParent(node, parent);
+    setNodeColor(node, depth == redDepth ? RED : BLACK);
+    node->left = linkSortedNodes(nodes, middle, node, depth + 1, redDepth);
+    node->right = linkSortedNodes(nodes + middle + 1, n - middle - 1, node, depth + 1, redDepth);
+    updateNode(node);
+    return node;
+}
+
+
+/**
+ * replace the content of tree by the sorted nodes, in linear time.
+ * @param tree: the tree to link the nodes into.
+ * @param nodes: nodes in strictly ascending order of their data.
+ * @param n: number of nodes.
+ */
+void setSortedNodes(RBTree *tree, Node **nodes, size_t n)
+{
+    unsigned int levels = 0;
+    while (levels < sizeof(size_t) * 8 && (((size_t) 1) << levels) - 1 < n)
+    {
+        levels++;
+    }
+    bool perfect = levels == sizeof(size_t) * 8 ? false : (((size_t) 1) << levels) - 1 == n;
+    tree->root = linkSortedNodes(nodes, n, NULL, 0, perfect ? levels : levels - 1);
+    if (tree->root != NULL)
+    {
+        setNodeColor(tree->root, BLACK);
+    }
+    tree->size = n;
+}
+
+
+/**
+ * fill an empty tree with items that are sorted in strictly ascending order, in linear time and without
+ * comparing items more than once. on success the tree owns the items.
+ * @param tree: an empty tree.
+ * @param items: the sorted items.
+ * @param n: number of items.
+ * @return: 0 on failure (the tree is not empty, items are not strictly ascending or allocation failed - the
+ * tree stays empty), other on success.
+ */
+int buildRBTreeFromSorted(RBTree *tree, void **items, size_t n)
+{
+    if (tree == NULL || tree->compFunc == NULL || tree->root != NULL || (items == NULL && n > 0))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (items[i] == NULL || (i > 0 && tree->compFunc(items[i - 1], items[i]) >= 0))
+        {
+            return false;
+        }
+    }
+    Node **nodes = (Node **) malloc((n == 0 ? 1 : n) * sizeof(Node *));
+    if (nodes == NULL)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        if ((nodes[i] = getNewNode(tree, items[i])) == NULL)
+        {
+            while (i > 0)
+            {
+                releaseNode(tree, nodes[--i]);
+            }
+            free(nodes);
+            return false;
+        }
+    }
+    setSortedNodes(tree, nodes, n);
+    free(nodes);
+    return true;
+}
+
+
+/**
+ * constructs a new RBTree holding items that are sorted in strictly ascending order, in linear time.
+ * @param items: the sorted items, owned by the tree on success.
+ * @param n: number of items.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free the items of the tree.
+ * @return: the new tree, NULL on failure (items are not strictly ascending or allocation failed).
+ */
+RBTree *newRBTreeFromSorted(void **items, size_t n, CompareFunc compFunc, FreeFunc freeFunc)
+{
+    RBTree * tree = newRBTree(compFunc, freeFunc);
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    if (!buildRBTreeFromSorted(tree, items, n))
+    {
+#ifdef RBTREE_STATS
+        free(tree->stats);
+#endif
+        free(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+
+/**
+ * constructs a new RBTree holding items in any order, by sorting them first (in place) with compFunc and
+ * building the tree from the sorted array in O(n log n).
+ * @param items: the items, owned by the tree on success.
+ * @param n: number of items.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free the items of the tree.
+ * @return: the new tree, NULL on failure (two of the items are equal or allocation failed).
+ */
+RBTree *newRBTreeFromUnsorted(void **items, size_t n, CompareFunc compFunc, FreeFunc freeFunc)
+{
+    if (compFunc == NULL || (items == NULL && n > 0) || !sortItems(items, NULL, n, compFunc))
+    {
+        return NULL;
+    }
+    return newRBTreeFromSorted(items, n, compFunc, freeFunc);
+}
+
+
+/**
+ * remove a red Node with at most one child from the tree by linking its parent to its child.
+ * @param node: the node to remove from the tree.
+ * @param child: the child of node if one exist, if not null.
+ */
+void removeRedNode(Node *node, Node *child)
+{
+    Node * parent = nodeParent(node);
+    nodeDirection(node) == LEFT ? setLeftChild(parent, child) : setRightChild(parent, child);
+    if (child != NULL)
+    {
+        setParent(child, parent);
+    }
+#ifdef RBTREE_AUGMENTED
+    updatePathToRoot(parent);
+#endif
+}
+
+
+/**
+ * handle case where one of the Nodes in an RBTree is a double black node.
+ * @param tree: a RBTree that contain a double black Node.
+ * @param node: the parent of the double black node in tree.
+ * @param direction: the direction from node to the double black node (which may be NULL).
+ */
+void doubleBlackNode(RBTree *tree, Node *node, Direction direction)
+{
+    STATS_ADD(tree, doubleBlackFixups, 1);
+    Node * sibling = direction == LEFT ? node->right : node->left;
+    Node * farNephew = direction == LEFT ? sibling->right : sibling->left;
+    Node * nearNephew = direction == LEFT ? sibling->left : sibling->right;
+    if (nodeColor(sibling) == RED)
+    {
+        rotate(tree, node, sibling, direction);
+        switchColors(node, sibling);
+        doubleBlackNode(tree, node, direction);
+    }
+    else if (farNephew != NULL && nodeColor(farNephew) == RED)
+    {
+        setNodeColor(sibling, nodeColor(node));
+        setNodeColor(node, BLACK);
+        setNodeColor(farNephew, BLACK);
+        rotate(tree, node, sibling, direction);
+    }
+    else if (nearNephew != NULL && nodeColor(nearNephew) == RED)
+    {
+        rotate(tree, sibling, nearNephew, !direction);
+        switchColors(sibling, nearNephew);
+        doubleBlackNode(tree, node, direction);
+    }
+    else
+    {
+        setNodeColor(sibling, RED);
+        if (nodeColor(node) == RED)
+        {
+            setNodeColor(node, BLACK);
+        }
+        else if (nodeParent(node) != NULL)
+        {
+            doubleBlackNode(tree, nodeParent(node), nodeDirection(node));
+        }
+    }
+}
+
+
+
+/**
+ * remove a black Node with at most one child and a parent from the tree by linking its parent to its child.
+ * @param tree: a RBTree that contain node and child.
+ * @param node: the node to remove from the tree.
+ * @param child: a child of node if exist one, if not null.
+ */
+void removeBlackNode(RBTree *tree, Node *node, Node *child)
+{
+    Direction direction = nodeDirection(node);
+    direction == LEFT ? setLeftChild(nodeParent(node), child) : setRightChild(nodeParent(node), child);
+    if (child != NULL)
+    {
+        setParent(child, nodeParent(node));
+    }
+#ifdef RBTREE_AUGMENTED
+    updatePathToRoot(nodeParent(node));
+#endif
+    doubleBlackNode(tree, nodeParent(node), direction);
+}
+
+
+/**
+ * swap the places of node and its successor in the tree (the links and the colors, not the data), so the
+ * nodes of all the other items stay where they are.
+ * @param tree: a RBTree tree containing node.
+ * @param node: a Node with two children.
+ * @param successor: the leftmost node in the right subtree of node.
+ */
+void swapWithSuccessor(RBTree *tree, Node *node, Node *successor)
+{
+    Node * parent = nodeParent(node), * left = node->left, * right = node->right;
+    Node * successorParent = nodeParent(successor), * successorRight = successor->right;
+    if (parent == NULL)
+    {
+        tree->root = successor;
+    }
+    else
+    {
+        nodeDirection(node) == LEFT ? setLeftChild(parent, successor) : setRightChild(parent, successor);
+    }
+    setParent(successor, parent);
+    setLeftChild(successor, left);
+    setParent(left, successor);
+    switchColors(node, successor);
+    if (successorParent == node)
+    {
+        setRightChild(successor, node);
+        setParent(node, successor);
+    }
+    else
+    {
+        setRightChild(successor, right);
+        setParent(right, successor);
+        setLeftChild(successorParent, node);
+        setParent(node, successorParent);
+    }
+    setLeftChild(node, NULL);
+    setRightChild(node, successorRight);
+    if (successorRight != NULL)
+    {
+        setParent(successorRight, node);
+    }
+}
+
+
+/**
+ * remove the node from the RBTree tree and delete it.
+ * @param tree: a RBTree tree containing node.
+ * @param node: a Node contained in tree to remove from it and than delete it.
+ */
+void deleteNode(RBTree *tree, Node * node)
+{
+    if (node->left != NULL && node->right != NULL)
+    {
+        Node * successor = node->right;
+        while (successor->left != NULL)
+        {
+            successor = successor->left;
+        }
+        swapWithSuccessor(tree, node, successor);
+    }
+    Node * child = node->left == NULL ? node->right : node->left;
+    if (nodeColor(node) == RED)
+    {
+        removeRedNode(node, child);
+    }
+    else if (nodeParent(node) == NULL)
+    {
+        child == NULL ? tree->root = NULL : setRoot(tree, child);
+    }
+    else if (child != NULL) // a black node with a single child, which must be red
+    {
+        setNodeColor(child, BLACK);
+        removeRedNode(node, child);
+    }
+    else
+    {
+        removeBlackNode(tree, node, child);
+    }
+    releaseNode(tree, node);
+}
+
+
+/**
+ * remove an item from the tree, without measuring the latency.
+ */
+int deleteItem(RBTree *tree, void *data)
+{
+    if (tree == NULL || tree->root == NULL || tree->compFunc == NULL || tree->freeFunc == NULL || data == NULL)
+    {
+        return false;
+    }
+    int result;
+    Node * node = findNodeLocation(tree, data, &result);
+    if (result != 0)
+    {
+        return false;
+    }
+    void *removedData = node->data;
+    deleteNode(tree, node);
+    tree->size--;
+    tree->freeFunc(removedData);
+    return true;
+}
+
+
+/**
+ * remove an item from the tree
+ * @param tree: the tree to remove an item from.
+ * @param data: item to remove from the tree.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromRBTree(RBTree *tree, void *data)
+{
+#ifdef RBTREE_STATS
+    long unsigned start = statsNow();
+    int deleted = deleteItem(tree, data);
+    if (tree != NULL)
+    {
+        recordLatency(tree, RBTREE_DELETE, start);
+    }
+    return deleted;
+#else
+    return deleteItem(tree, data);
+#endif
+}
+
+
+/**
+ * check whether the tree contains this item, without measuring the latency.
+ */
+int containsItem(const RBTree *tree, const void *data)
+{
+    if (tree == NULL || tree->compFunc == NULL || data == NULL)
+    {
+        return false;
+    }
+    int result;
+    Node * node = findNodeLocation(tree, data, &result);
+    return node != NULL && result == 0;
+}
+
+
+/**
+ * check whether the tree RBTree Contains this item.
+ * @param tree: the tree to check an item in.
+ * @param data: item to check.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int RBTreeContains(const RBTree *tree, const void *data)
+{
+#ifdef RBTREE_STATS
+    long unsigned start = statsNow();
+    int found = containsItem(tree, data);
+    if (tree != NULL)
+    {
+        recordLatency(tree, RBTREE_CONTAINS, start);
+    }
+    return found;
+#else
+    return containsItem(tree, data);
+#endif
+}
+
+
+/**
+ * find the leftmost node of a sub tree.
+ * @param node: the root of the sub tree.
+ * @return: the node with the smallest data in the sub tree, NULL if it is empty.
+ */
+Node * minimumNode(Node *node)
+{
+    while (node != NULL && node->left != NULL)
+    {
+        node = node->left;
+    }
+    return node;
+}
+
+
+/**
+ * find the rightmost node of a sub tree.
+ * @param node: the root of the sub tree.
+ * @return: the node with the largest data in the sub tree, NULL if it is empty.
+ */
+Node * maximumNode(Node *node)
+{
+    while (node != NULL && node->right != NULL)
+    {
+        node = node->right;
+    }
+    return node;
+}
+
+
+/**
+ * find the next node in ascending order, using the parent pointers.
+ * @param node: a node in a tree.
+ * @return: the node with the smallest data larger than the data of node, NULL if there is none.
+ */
+Node * successorNode(Node *node)
+{
+    if (node->right != NULL)
+    {
+        return minimumNode(node->right);
+    }
+    while (nodeParent(node) != NULL && node == nodeParent(node)->right)
+    {
+        node = nodeParent(node);
+    }
+    return nodeParent(node);
+}
+
+
+/**
+ * find the previous node in ascending order, using the parent pointers.
+ * @param node: a node in a tree.
+ * @return: the node with the largest data smaller than the data of node, NULL if there is none.
+ */
+Node * predecessorNode(Node *node)
+{
+    if (node->left != NULL)
+    {
+        return maximumNode(node->left);
+    }
+    while (nodeParent(node) != NULL && node == nodeParent(node)->left)
+    {
+        node = nodeParent(node);
+    }
+    return nodeParent(node);
+}
+
+
+/**
+ * find the first node whose data is not smaller than data (or larger than data if strict).
+ * @param tree: the tree to search in.
+ * @param data: the bound to search for.
+ * @param strict: true to skip a node equal to data.
+ * @return: the first node in the bound, NULL if there is none.
+ */
+Node * boundNode(const RBTree *tree, const void *data, bool strict)
+{
+    Node * node = tree->root, * bound = NULL;
+    long unsigned depth = 0;
+    for (; node != NULL; depth++)
+    {
+        int result = tree->compFunc(node->data, data);
+        if (result > 0 || (result == 0 && !strict))
+        {
+            bound = node;
+            node = node->left;
+        }
+        else
+        {
+            node = node->right;
+        }
+    }
+    STATS_SEARCH(tree, depth);
+    return bound;
+}
+
+
+/**
+ * set iterator to point at node of tree.
+ * @return: 0 if node is NULL (the iterator is past the end), other otherwise.
+ */
+int setIterator(RBTreeIterator *iterator, const RBTree *tree, Node *node)
+{
+    iterator->tree = tree;
+    iterator->node = node;
+    return node != NULL;
+}
+
+
+/**
+ * place iterator at the smallest item of tree.
+ * @param tree: the tree to iterate.
+ * @param iterator: the iterator to place.
+ * @return: 0 if the tree is empty, other otherwise.
+ */
+int RBTreeBegin(const RBTree *tree, RBTreeIterator *iterator)
+{
+    if (tree == NULL || iterator == NULL)
+    {
+        return false;
+    }
+    return setIterator(iterator, tree, minimumNode(tree->root));
+}
+
+
+/**
+ * place iterator at the largest item of tree.
+ * @param tree: the tree to iterate.
+ * @param iterator: the iterator to place.
+ * @return: 0 if the tree is empty, other otherwise.
+ */
+int RBTreeLast(const RBTree *tree, RBTreeIterator *iterator)
+{
+    if (tree == NULL || iterator == NULL)
+    {
+        return false;
+    }
+    return setIterator(iterator, tree, maximumNode(tree->root));
+}
+
+
+/**
+ * place iterator at the first item of tree that is not smaller than data.
+ * @param tree: the tree to search in.
+ * @param data: the bound.
+ * @param iterator: the iterator to place.
+ * @return: 0 if there is no such item, other otherwise.
+ */
+int RBTreeLowerBound(const RBTree *tree, const void *data, RBTreeIterator *iterator)
+{
+    if (tree == NULL || tree->compFunc == NULL || data == NULL || iterator == NULL)
+    {
+        return false;
+    }
+    return setIterator(iterator, tree, boundNode(tree, data, false));
+}
+
+
+/**
+ * place iterator at the first item of tree that is larger than data.
+ * @param tree: the tree to search in.
+ * @param data: the bound.
+ * @param iterator: the iterator to place.
+ * @return: 0 if there is no such item, other otherwise.
+ */
+int RBTreeUpperBound(const RBTree *tree, const void *data, RBTreeIterator *iterator)
+{
+    if (tree == NULL || tree->compFunc == NULL || data == NULL || iterator == NULL)
+    {
+        return false;
+    }
+    return setIterator(iterator, tree, boundNode(tree, data, true));
+}
+
+
+/**
+ * move iterator to the next item in ascending order.
+ * @param iterator: a valid iterator.
+ * @return: 0 if there is no next item (the iterator becomes invalid), other otherwise.
+ */
+int RBTreeIteratorNext(RBTreeIterator *iterator)
+{
+    if (iterator == NULL || iterator->node == NULL)
+    {
+        return false;
+    }
+    return setIterator(iterator, iterator->tree, successorNode(iterator->node));
+}
+
+
+/**
+ * move iterator to the previous item in ascending order.
+ * @param iterator: a valid iterator.
+ * @return: 0 if there is no previous item (the iterator becomes invalid), other otherwise.
+ */
+int RBTreeIteratorPrev(RBTreeIterator *iterator)
+{
+    if (iterator == NULL || iterator->node == NULL)
+    {
+        return false;
+    }
+    return setIterator(iterator, iterator->tree, predecessorNode(iterator->node));
+}
+
+
+/**
+ * get the item the iterator points at.
+ * @param iterator: the iterator.
+ * @return: the item, NULL if the iterator is invalid.
+ */
+void *RBTreeIteratorData(const RBTreeIterator *iterator)
+{
+    return (iterator == NULL || iterator->node == NULL) ? NULL : iterator->node->data;
+}
+
+
+/**
+ * Activate a function on each item of the tree. the order is an ascending order. if one of the activations of the
+ * function returns 0, the process stops.
+ * @param tree: the tree with all the items.
+ * @param func: the function to activate on all items.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success.
+ */
+int forEachRBTree(const RBTree *tree, forEachFunc func, void *args)
+{
+    if (tree == NULL || func == NULL)
+    {
+        return false;
+    }
+    for (Node * node = minimumNode(tree->root); node != NULL; node = successorNode(node))
+    {
+        if (!func(node->data, args))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Activate a function on each item of the tree in the range [low, high), in ascending order. if one of the
+ * activations of the function returns 0, the process stops.
+ * @param tree: the tree with all the items.
+ * @param low: the smallest item in the range, NULL to start at the smallest item of the tree.
+ * @param high: the first item after the range, NULL to go up to the largest item of the tree.
+ * @param func: the function to activate on the items.
+ * @param args: more optional arguments to the function.
+ * @return: 0 on failure, other on success.
+ */
+int forEachInRange(const RBTree *tree, const void *low, const void *high, forEachFunc func, void *args)
+{
+    if (tree == NULL || tree->compFunc == NULL || func == NULL)
+    {
+        return false;
+    }
+    Node * node = low == NULL ? minimumNode(tree->root) : boundNode(tree, low, false);
+    for (; node != NULL; node = successorNode(node))
+    {
+        if (high != NULL && tree->compFunc(node->data, high) >= 0)
+        {
+            break;
+        }
+        if (!func(node->data, args))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * put the nodes of a sub tree in an array, in ascending order.
+ * @param node: the root of the sub tree.
+ * @param nodes: the array to fill.
+ * @param count: the number of nodes already in the array, updated.
+ */
+void collectNodes(Node *node, Node **nodes, size_t *count)
+{
+    for (node = minimumNode(node); node != NULL; node = successorNode(node))
+    {
+        nodes[(*count)++] = node;
+    }
+}
+
+
+/**
+ * check whether merging a batch into tree (rebuilding it in linear time) is cheaper than handling the items
+ * one by one, each with its own descent.
+ * @param tree: the tree the batch goes into.
+ * @param n: the size of the batch.
+ * @return: true to merge, false to handle the items one by one.
+ */
+bool shouldMergeBatch(const RBTree *tree, size_t n)
+{
+    size_t depth = 0;
+    for (long unsigned size = tree->size; size > 0; size >>= 1)
+    {
+        depth++;
+    }
+    return n * depth >= tree->size;
+}
+
+
+/**
+ * copy the non NULL items of a batch with their indices and sort them.
+ * @param tree: the tree the batch goes into.
+ * @param items: the batch.
+ * @param n: the size of the batch.
+ * @param sorted: set to the sorted copy of the items.
+ * @param indices: set to the index in items of each item in sorted.
+ * @param count: set to the number of items in sorted.
+ * @return: false on allocation failure, true otherwise.
+ */
+bool sortBatch(const RBTree *tree, void **items, size_t n, void ***sorted, size_t **indices, size_t *count)
+{
+    *sorted = (void **) malloc((n == 0 ? 1 : n) * sizeof(void *));
+    *indices = (size_t *) malloc((n == 0 ? 1 : n) * sizeof(size_t));
+    if (*sorted == NULL || *indices == NULL)
+    {
+        free(*sorted);
+        free(*indices);
+        return false;
+    }
+    *count = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (items[i] != NULL)
+        {
+            (*sorted)[*count] = items[i];
+            (*indices)[(*count)++] = i;
+        }
+    }
+    if (!sortItems(*sorted, *indices, *count, tree->compFunc))
+    {
+        free(*sorted);
+        free(*indices);
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * merge sorted items into tree by rebuilding it from the merged sequence of its nodes and new nodes.
+ * @param tree: the tree to insert to.
+ * @param sorted: the items to insert, in ascending order.
+ * @param indices: the index in the original batch of each item.
+ * @param count: the number of items.
+ * @param results: results[indices[i]] is set to whether sorted[i] was inserted, may be NULL.
+ * @return: the number of inserted items, RBTREE_BATCH_FAILED on allocation failure (the tree is not changed).
+ */
+size_t mergeIntoTree(RBTree *tree, void **sorted, size_t *indices, size_t count, int *results)
+{
+    Node **nodes = (Node **) malloc((tree->size == 0 ? 1 : tree->size) * sizeof(Node *));
+    Node **merged = (Node **) malloc((tree->size + count == 0 ? 1 : tree->size + count) * sizeof(Node *));
+    if (nodes == NULL || merged == NULL)
+    {
+        free(nodes);
+        free(merged);
+        return RBTREE_BATCH_FAILED;
+    }
+    size_t size = 0, treeIndex = 0, mergedCount = 0, inserted = 0;
+    collectNodes(tree->root, nodes, &size);
+    for (size_t i = 0; i < count; ++i)
+    {
+        int result = 1;
+        while (treeIndex < size && (result = tree->compFunc(nodes[treeIndex]->data, sorted[i])) < 0)
+        {
+            merged[mergedCount++] = nodes[treeIndex++];
+        }
+        bool duplicate = (treeIndex < size && result == 0) ||
+                         (i > 0 && tree->compFunc(sorted[i - 1], sorted[i]) == 0);
+        Node * node = duplicate ? NULL : getNewNode(tree, sorted[i]);
+        if (!duplicate && node == NULL)
+        {
+            for (size_t j = 0, k = 0; j < mergedCount; ++j) // roll back: release only the new nodes
+            {
+                if (k < treeIndex && merged[j] == nodes[k])
+                {
+                    k++;
+                }
+                else
+                {
+                    releaseNode(tree, merged[j]);
+                }
+            }
+            setSortedNodes(tree, nodes, size);
+            free(nodes);
+            free(merged);
+            for (size_t j = 0; results != NULL && j < count; ++j)
+            {
+                results[indices[j]] = false;
+            }
+            return RBTREE_BATCH_FAILED;
+        }
+        if (node != NULL)
+        {
+            merged[mergedCount++] = node;
+            inserted++;
+        }
+        if (results != NULL)
+        {
+            results[indices[i]] = node != NULL;
+        }
+    }
+    while (treeIndex < size)
+    {
+        merged[mergedCount++] = nodes[treeIndex++];
+    }
+    setSortedNodes(tree, merged, mergedCount);
+    free(nodes);
+    free(merged);
+    return inserted;
+}
+
+
+/**
+ * add a batch of items to the tree. the batch is sorted with the CompareFunc of the tree, then either merged
+ * into the tree in one linear pass (when it is large compared to the tree) or inserted in ascending order.
+ * @param tree: the tree to add the items to.
+ * @param items: the items to add (the array is not changed).
+ * @param n: the number of items.
+ * @param results: if not NULL, results[i] is set to 0 if items[i] was not inserted (NULL, already in the tree,
+ * equal to an earlier item of the batch or not added because an allocation failed), other if it was.
+ * @return: the number of items inserted, RBTREE_BATCH_FAILED if an allocation failed.
+ */
+size_t insertManyToRBTree(RBTree *tree, void **items, size_t n, int *results)
+{
+    void **sorted = NULL;
+    size_t *indices = NULL, count = 0, inserted = 0;
+    for (size_t i = 0; results != NULL && i < n; ++i)
+    {
+        results[i] = false;
+    }
+    if (tree == NULL || tree->compFunc == NULL || items == NULL)
+    {
+        return 0;
+    }
+    if (!sortBatch(tree, items, n, &sorted, &indices, &count))
+    {
+        return RBTREE_BATCH_FAILED;
+    }
+    if (shouldMergeBatch(tree, count))
+    {
+        inserted = mergeIntoTree(tree, sorted, indices, count, results);
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            // the items are not NULL, so no node back means that the new node could not be allocated.
+            bool result;
+            if (findOrInsertWithLatency(tree, sorted[i], sequentialFinger(tree), &result) == NULL)
+            {
+                inserted = RBTREE_BATCH_FAILED;
+                break;
+            }
+            inserted += result ? 1 : 0;
+            if (results != NULL)
+            {
+                results[indices[i]] = result;
+            }
+        }
+    }
+    free(sorted);
+    free(indices);
+    return inserted;
+}
+
+
+/**
+ * remove sorted items from tree by rebuilding it from the nodes that are left.
+ * @param tree: the tree to remove from.
+ * @param sorted: the items to remove, in ascending order.
+ * @param indices: the index in the original batch of each item.
+ * @param count: the number of items.
+ * @param results: results[indices[i]] is set to whether sorted[i] was removed, may be NULL.
+ * @param removedData: filled with the data of the removed nodes, to be freed by the caller.
+ * @return: the number of removed items, RBTREE_BATCH_FAILED on allocation failure (the tree is not changed).
+ */
+size_t removeFromTree(RBTree *tree, void **sorted, size_t *indices, size_t count, int *results, void **removedData)
+{
+    Node **nodes = (Node **) malloc((tree->size == 0 ? 1 : tree->size) * sizeof(Node *));
+    if (nodes == NULL)
+    {
+        return RBTREE_BATCH_FAILED;
+    }
+    size_t size = 0, treeIndex = 0, kept = 0, removed = 0;
+    collectNodes(tree->root, nodes, &size);
+    for (size_t i = 0; i < count; ++i)
+    {
+        int result = 1;
+        while (treeIndex < size && (result = tree->compFunc(nodes[treeIndex]->data, sorted[i])) < 0)
+        {
+            nodes[kept++] = nodes[treeIndex++];
+        }
+        bool found = treeIndex < size && result == 0;
+        if (found)
+        {
+            removedData[removed++] = nodes[treeIndex]->data;
+            releaseNode(tree, nodes[treeIndex++]);
+        }
+        if (results != NULL)
+        {
+            results[indices[i]] = found;
+        }
+    }
+    while (treeIndex < size)
+    {
+        nodes[kept++] = nodes[treeIndex++];
+    }
+    setSortedNodes(tree, nodes, kept);
+    free(nodes);
+    return removed;
+}
+
+
+/**
+ * remove sorted items from tree one by one.
+ * @param tree: the tree to remove from.
+ * @param sorted: the items to remove, in ascending order.
+ * @param indices: the index in the original batch of each item.
+ * @param count: the number of items.
+ * @param results: results[indices[i]] is set to whether sorted[i] was removed, may be NULL.
+ * @param removedData: filled with the data of the removed nodes, to be freed by the caller.
+ * @return: the number of removed items.
+ */
+size_t removeEachFromTree(RBTree *tree, void **sorted, size_t *indices, size_t count, int *results,
+                          void **removedData)
+{
+    size_t removed = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        int result;
+        Node * node = findNodeLocation(tree, sorted[i], &result);
+        bool found = node != NULL && result == 0;
+        if (found)
+        {
+            removedData[removed++] = node->data;
+            deleteNode(tree, node);
+            tree->size--;
+        }
+        if (results != NULL)
+        {
+            results[indices[i]] = found;
+        }
+    }
+    return removed;
+}
+
+
+/**
+ * remove a batch of items from the tree. the batch is sorted with the CompareFunc of the tree, then either
+ * the tree is rebuilt without the removed items in one linear pass (when the batch is large compared to the
+ * tree) or the items are removed in ascending order.
+ * @param tree: the tree to remove the items from.
+ * @param items: the items to remove (the array is not changed).
+ * @param n: the number of items.
+ * @param results: if not NULL, results[i] is set to 0 if items[i] was not removed (NULL, not in the tree or
+ * equal to an earlier item of the batch), other if it was.
+ * @return: the number of items removed, RBTREE_BATCH_FAILED if an allocation failed (then nothing is removed and
+ * all the results are 0).
+ */
+size_t deleteManyFromRBTree(RBTree *tree, void **items, size_t n, int *results)
+{
+    void **sorted = NULL;
+    size_t *indices = NULL, count = 0, removed = 0;
+    for (size_t i = 0; results != NULL && i < n; ++i)
+    {
+        results[i] = false;
+    }
+    if (tree == NULL || tree->compFunc == NULL || tree->freeFunc == NULL || items == NULL)
+    {
+        return 0;
+    }
+    if (!sortBatch(tree, items, n, &sorted, &indices, &count))
+    {
+        return RBTREE_BATCH_FAILED;
+    }
+    // the data of removed items is freed only at the end, as items of the batch may be the removed data itself
+    void **removedData = (void **) malloc((count == 0 ? 1 : count) * sizeof(void *));
+    if (removedData == NULL)
+    {
+        removed = RBTREE_BATCH_FAILED;
+    }
+    else
+    {
+        removed = shouldMergeBatch(tree, count) ?
+                  removeFromTree(tree, sorted, indices, count, results, removedData) :
+                  removeEachFromTree(tree, sorted, indices, count, results, removedData);
+    }
+    for (size_t i = 0; removed != RBTREE_BATCH_FAILED && i < removed; ++i)
+    {
+        tree->freeFunc(removedData[i]);
+    }
+    free(removedData);
+    free(sorted);
+    free(indices);
+    return removed;
+}
+
+
+/**
+ * set the function that gives the sizes of the items, and measure the items already in the tree.
+ * @param tree: the tree to set the function of.
+ * @param sizeFunc: the function, NULL to stop tracking (dataBytes becomes 0).
+ * @return: 0 on failure, other on success.
+ */
+int setRBTreeSizeFunc(RBTree *tree, SizeFunc sizeFunc)
+{
+    if (tree == NULL)
+    {
+        return false;
+    }
+    tree->sizeFunc = sizeFunc;
+    tree->dataBytes = 0;
+    for (Node * node = minimumNode(tree->root); sizeFunc != NULL && node != NULL; node = successorNode(node))
+    {
+        tree->dataBytes += sizeFunc(node->data);
+    }
+    return true;
+}
+
+
+#ifdef RBTREE_ORDER_STATISTICS
+/**
+ * find the k-th smallest item of the tree, in O(log n).
+ * @param tree: the tree to search in.
+ * @param k: the rank of the item, from 0 (the smallest item) to size - 1.
+ * @return: the item, NULL if k is out of range.
+ */
+void *RBTreeSelect(const RBTree *tree, long unsigned k)
+{
+    if (tree == NULL || k >= tree->size)
+    {
+        return NULL;
+    }
+    Node * node = tree->root;
+    while (node != NULL)
+    {
+        long unsigned leftSize = subtreeSize(node->left);
+        if (k == leftSize)
+        {
+            return node->data;
+        }
+        if (k < leftSize)
+        {
+            node = node->left;
+        }
+        else
+        {
+            k -= leftSize + 1;
+            node = node->right;
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * count the items of the tree that are smaller than data, in O(log n).
+ * @param tree: the tree to search in.
+ * @param data: the item to rank (need not be in the tree).
+ * @return: the number of items smaller than data.
+ */
+long unsigned RBTreeRank(const RBTree *tree, const void *data)
+{
+    if (tree == NULL || tree->compFunc == NULL || data == NULL)
+    {
+        return 0;
+    }
+    long unsigned rank = 0;
+    Node * node = tree->root;
+    while (node != NULL)
+    {
+        int result = tree->compFunc(node->data, data);
+        if (result < 0)
+        {
+            rank += subtreeSize(node->left) + 1;
+            node = node->right;
+        }
+        else
+        {
+            if (result == 0)
+            {
+                return rank + subtreeSize(node->left);
+            }
+            node = node->left;
+        }
+    }
+    return rank;
+}
+
+
+/**
+ * find the lower median of the tree.
+ * @param tree: the tree to search in.
+ * @return: the item of rank (size - 1) / 2, NULL if the tree is empty.
+ */
+void *RBTreeMedian(const RBTree *tree)
+{
+    if (tree == NULL || tree->size == 0)
+    {
+        return NULL;
+    }
+    return RBTreeSelect(tree, (tree->size - 1) / 2);
+}
+#endif
+
+
+#ifdef RBTREE_MAX_WEIGHT
+/**
+ * weigh the items of a sub tree again, and update the heaviest node of each of its nodes.
+ * @param tree: the tree the sub tree belongs to.
+ * @param node: the root of the sub tree.
+ */
+void weighSubtree(const RBTree *tree, Node *node)
+{
+    if (node == NULL)
+    {
+        return;
+    }
+    weighSubtree(tree, node->left);
+    weighSubtree(tree, node->right);
+    node->weight = tree->weightFunc == NULL ? 0 : tree->weightFunc(node->data);
+    updateNode(node);
+}
+
+
+/**
+ * set the function that gives the weights of the items, and weigh the items already in the tree (in O(n)).
+ * @param tree: the tree to set the function of.
+ * @param weightFunc: the function, NULL to give every item the weight 0.
+ * @return: 0 on failure, other on success.
+ */
+int setRBTreeWeightFunc(RBTree *tree, WeightFunc weightFunc)
+{
+    if (tree == NULL)
+    {
+        return false;
+    }
+    tree->weightFunc = weightFunc;
+    weighSubtree(tree, tree->root);
+    return true;
+}
+
+
+/**
+ * find the heaviest item of the tree in O(1). of equally heavy items, the smallest one is returned.
+ * @param tree: the tree to search in.
+ * @return: the item with the largest weight, NULL if the tree is empty.
+ */
+void *RBTreeMaxWeight(const RBTree *tree)
+{
+    if (tree == NULL || tree->root == NULL)
+    {
+        return NULL;
+    }
+    return tree->root->maxWeightNode->data;
+}
+
+
+/**
+ * a part of the tree that may hold the next heaviest items: a whole sub tree, or a single node.
+ */
+typedef struct WeightCandidate
+{
+    Node *node;
+    bool single;
+    long double weight; // the weight of the heaviest node of the part.
+} WeightCandidate;
+
+
+/**
+ * add a part of the tree to a max heap of candidates, growing the heap if it is full.
+ * @return: false on allocation failure, true otherwise.
+ */
+bool pushCandidate(WeightCandidate **heap, size_t *count, size_t *capacity, Node *node, bool single)
+{
+    if (node == NULL)
+    {
+        return true;
+    }
+    if (*count == *capacity)
+    {
+        size_t larger = 2 * (*capacity);
+        WeightCandidate *grown = (WeightCandidate *) realloc(*heap, larger * sizeof(WeightCandidate));
+        if (grown == NULL)
+        {
+            return false;
+        }
+        *heap = grown;
+        *capacity = larger;
+    }
+    WeightCandidate candidate = {node, single, single ? node->weight : node->maxWeightNode->weight};
+    size_t i = (*count)++;
+    for (; i > 0 && (*heap)[(i - 1) / 2].weight < candidate.weight; i = (i - 1) / 2)
+    {
+        (*heap)[i] = (*heap)[(i - 1) / 2];
+    }
+    (*heap)[i] = candidate;
+    return true;
+}
+
+
+/**
+ * remove the heaviest candidate from a max heap of candidates.
+ * @return: the removed candidate.
+ */
+WeightCandidate popCandidate(WeightCandidate *heap, size_t *count)
+{
+    WeightCandidate top = heap[0], last = heap[--(*count)];
+    size_t i = 0;
+    while (2 * i + 1 < *count)
+    {
+        size_t child = 2 * i + 1;
+        if (child + 1 < *count && heap[child + 1].weight > heap[child].weight)
+        {
+            child++;
+        }
+        if (heap[child].weight <= last.weight)
+        {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+    return top;
+}
+
+
+/**
+ * find the k heaviest items of the tree, heaviest first. a max heap holds parts of the tree by the weight of
+ * their heaviest node; taking the heaviest node out of a sub tree splits the rest of it into the nodes on the
+ * path to that node and the sub trees hanging off the path, O(log n) new parts for each item found.
+ * @param tree: the tree to search in.
+ * @param k: the number of items to find.
+ * @param items: an array of at least k items, filled with the heaviest items.
+ * @return: the number of items found (less than k if the tree is smaller), 0 on failure.
+ */
+size_t RBTreeTopWeights(const RBTree *tree, size_t k, void **items)
+{
+    if (tree == NULL || items == NULL || k == 0)
+    {
+        return 0;
+    }
+    size_t count = 0, capacity = 64, found = 0;
+    WeightCandidate *heap = (WeightCandidate *) malloc(capacity * sizeof(WeightCandidate));
+    if (heap == NULL || !pushCandidate(&heap, &count, &capacity, tree->root, false))
+    {
+        free(heap);
+        return 0;
+    }
+    while (found < k && count > 0)
+    {
+        WeightCandidate candidate = popCandidate(heap, &count);
+        Node * heaviest = candidate.single ? candidate.node : candidate.node->maxWeightNode;
+        items[found++] = heaviest->data;
+        if (candidate.single)
+        {
+            continue;
+        }
+        bool pushed = pushCandidate(&heap, &count, &capacity, heaviest->left, false) &&
+                      pushCandidate(&heap, &count, &capacity, heaviest->right, false);
+        for (Node * node = heaviest; pushed && node != candidate.node; node = nodeParent(node))
+        {
+            Node * sibling = node == nodeParent(node)->left ? nodeParent(node)->right : nodeParent(node)->left;
+            pushed = pushCandidate(&heap, &count, &capacity, nodeParent(node), true) &&
+                     pushCandidate(&heap, &count, &capacity, sibling, false);
+        }
+        if (!pushed)
+        {
+            free(heap);
+            return 0;
+        }
+    }
+    free(heap);
+    return found;
+}
+#endif
+
+
+/**
+ * this function free a single node.
+ * @param tree: the tree the node belongs to.
+ * @param node: a Node object to free.
+ */
+void freeNode(RBTree *tree, Node **node)
+{
+    void *data = (*node)->data;
+    setNodeParent(*node, NULL); (*node)->left = NULL; (*node)->right = NULL;
+    releaseNode(tree, *node);
+    tree->freeFunc(data);
+    (*node) = NULL;
+}
+
+
+/**
+ * free a sub tree by going over it recursively, first its children and the node itself.
+ * @param tree: the tree the sub tree belongs to.
+ * @param node: the root of the sub tree.
+ */
+void deleteEachElementInTree(RBTree *tree, Node **node)
+{
+    if ((*node) == NULL)
+    {
+        return;
+    }
+    deleteEachElementInTree(tree, &(*node)->left);
+    deleteEachElementInTree(tree, &(*node)->right);
+    freeNode(tree, node);
+}
+
+
+/**
+ * free the data of all the nodes in a sub tree, without freeing the nodes themselves.
+ * @param node: the root of the sub tree.
+ * @param func: the function to free the nodes data.
+ */
+void deleteEachDataInTree(Node *node, FreeFunc func)
+{
+    while (node != NULL)
+    {
+        deleteEachDataInTree(node->left, func);
+        func(node->data);
+        node = node->right;
+    }
+}
+
+
+/**
+ * free all memory of the data structure.
+ * @param tree: pointer to the tree to free.
+ */
+void freeRBTree(RBTree **tree)
+{
+    if (tree == NULL || (*tree) == NULL || (*tree)->freeFunc == NULL)
+    {
+        return;
+    }
+    if ((*tree)->pool == NULL)
+    {
+        deleteEachElementInTree(*tree, &(*tree)->root);
+    }
+    else
+    {
+        deleteEachDataInTree((*tree)->root, (*tree)->freeFunc);
+        freeNodePool(&(*tree)->pool);
+    }
+    (*tree)->root = NULL;
+#ifdef RBTREE_STATS
+    free((*tree)->stats);
+#endif
+    free((*tree));
+    (*tree) = NULL;
+}
+
+
+#ifdef RBTREE_STATS
+/**
+ * copy the counters of the tree. may run while other threads read the tree.
+ * @param tree: the tree to get the counters of.
+ * @param stats: filled with the counters.
+ * @return: 0 on failure, other on success.
+ */
+int getRBTreeStats(const RBTree *tree, RBTreeStats *stats)
+{
+    if (tree == NULL || stats == NULL)
+    {
+        return false;
+    }
+    // RBTreeStats is made of long unsigned counters only.
+    const long unsigned *from = (const long unsigned *) tree->stats;
+    long unsigned *to = (long unsigned *) stats;
+    for (size_t i = 0; i < sizeof(RBTreeStats) / sizeof(long unsigned); ++i)
+    {
+        to[i] = __atomic_load_n(&from[i], __ATOMIC_RELAXED);
+    }
+    return true;
+}
+
+
+/**
+ * set all the counters of the tree to 0.
+ * @param tree: the tree to reset the counters of.
+ */
+void resetRBTreeStats(RBTree *tree)
+{
+    if (tree == NULL)
+    {
+        return;
+    }
+    long unsigned *counters = (long unsigned *) tree->stats;
+    for (size_t i = 0; i < sizeof(RBTreeStats) / sizeof(long unsigned); ++i)
+    {
+        __atomic_store_n(&counters[i], 0, __ATOMIC_RELAXED);
+    }
+}
+#endif
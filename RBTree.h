@@ -1,104 +1,451 @@
-#ifndef RBTREE_RBTREE_H
-#define RBTREE_RBTREE_H
-
-// a color of a Node.
-// enum defines a new data type (much like struct)
-// the enum names get a value, starting from 0. Each consecutive
-// name is +1 of the last. In this case, RED==0, BLACK==1.
-typedef enum Color
-{
-	RED, BLACK
-} Color;
-
-/**
- * pointer to a function that compares tree items.
- * @a, @b: two items.
- * @return: equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a.
- */
-typedef int (*CompareFunc)(const void *a, const void *b);
-
-/**
- * pointer to a function to apply on all tree items.
- * @object: a pointer to an item of the tree.
- * @args: pointer to other arguments for the function.
- * @return: 0 on failure, other on success.
- */
-typedef int (*forEachFunc)(const void *object, void *args);
-
-/**
- * pointer to a function that frees a data item
- * @object: a pointer to an item of the tree.
- */
-typedef void (*FreeFunc)(void *data);
-
-/*
- * a node of the tree.
- */
-typedef struct Node
-{
-	struct Node *parent, *left, *right;
-	Color color;
-	void *data;
-} Node;
-
-/**
- * represents the tree
- */
-typedef struct RBTree
-{
-	Node *root;
-	CompareFunc compFunc;
-	FreeFunc freeFunc;
-	long unsigned size;
-} RBTree;
-
-/**
- * constructs a new RBTree with the given CompareFunc.
- * comp: a function two compare two variables.
- */
-RBTree *newRBTree(CompareFunc compFunc, FreeFunc freeFunc); // implement it in RBTree.c
-
-/**
- * add an item to the tree
- * @param tree: the tree to add an item to.
- * @param data: item to add to the tree.
- * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
- */
-int insertToRBTree(RBTree *tree, void *data); // implement it in RBTree.c
-
-/**
- * remove an item from the tree
- * @param tree: the tree to remove an item from.
- * @param data: item to remove from the tree.
- * @return: 0 on failure, other on success. (if data is not in the tree - failure).
- */
-int deleteFromRBTree(RBTree *tree, void *data); // implement it in RBTree.c
-
-/**
- * check whether the tree RBTreeContains this item.
- * @param tree: the tree to check an item in.
- * @param data: item to check.
- * @return: 0 if the item is not in the tree, other if it is.
- */
-int RBTreeContains(const RBTree *tree, const void *data); // implement it in RBTree.c
-
-
-
-/**
- * Activate a function on each item of the tree. the order is an ascending order. if one of the activations of the
- * function returns 0, the process stops.
- * @param tree: the tree with all the items.
- * @param func: the function to activate on all items.
- * @param args: more optional arguments to the function (may be null if the given function support it).
- * @return: 0 on failure, other on success.
- */
-int forEachRBTree(const RBTree *tree, forEachFunc func, void *args); // implement it in RBTree.c
-
-/**
- * free all memory of the data structure.
- * @param tree: pointer to the tree to free.
- */
-void freeRBTree(RBTree **tree); // implement it in RBTree.c
-
-
-#endif //RBTREE_RBTREE_H
\ No newline at end of file
+#ifndef RBTREE_RBTREE_H
+#define RBTREE_RBTREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// compile with -DRBTREE_ORDER_STATISTICS (in every translation unit) to keep the size of the sub tree of
+// each node, which gives O(log n) RBTreeSelect, RBTreeRank and RBTreeMedian. without it the nodes carry
+// nothing extra.
+// compile with -DRBTREE_MAX_WEIGHT (in every translation unit) to keep the weight of each item (given by the
+// WeightFunc of the tree) and the heaviest node of the sub tree of each node, which gives O(1) RBTreeMaxWeight
+// and O(k log n) RBTreeTopWeights.
+#if defined(RBTREE_ORDER_STATISTICS) || defined(RBTREE_MAX_WEIGHT)
+#define RBTREE_AUGMENTED
+#endif
+
+// compile with -DRBTREE_COMPACT_NODE (in every translation unit) to keep the color of each node in the lowest
+// bit of its parent pointer, which takes 8 bytes off every node. the nodes are then read and written through
+// the accessors of RBTreeInternal.h.
+
+// compile with -DRBTREE_STATS (in every translation unit) to give each tree a block of counters and latency
+// histograms, read with getRBTreeStats. without it the trees carry and do nothing extra.
+
+// a color of a Node.
+// enum defines a new data type (much like struct)
+// the enum names get a value, starting from 0. Each consecutive
+// name is +1 of the last. In this case, RED==0, BLACK==1.
+typedef enum Color
+{
+	RED, BLACK
+} Color;
+
+/**
+ * pointer to a function that compares tree items.
+ * @a, @b: two items.
+ * @return: equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a.
+ */
+typedef int (*CompareFunc)(const void *a, const void *b);
+
+/**
+ * pointer to a function to apply on all tree items.
+ * @object: a pointer to an item of the tree.
+ * @args: pointer to other arguments for the function.
+ * @return: 0 on failure, other on success.
+ */
+typedef int (*forEachFunc)(const void *object, void *args);
+
+/**
+ * pointer to a function that frees a data item
+ * @object: a pointer to an item of the tree.
+ */
+typedef void (*FreeFunc)(void *data);
+
+/**
+ * pointer to a function that gives the size in bytes of a tree item (see setRBTreeSizeFunc).
+ * @data: a pointer to an item of the tree.
+ * @return: the size of the item.
+ */
+typedef size_t (*SizeFunc)(const void *data);
+
+/**
+ * pointer to a function that merges a new item into the equal item of the tree (see RBTreeUpsert).
+ * @existing: the item of the tree, to update. it must stay equal to data by the CompareFunc of the tree.
+ * @data: the new item.
+ * @return: 0 on failure, other on success.
+ */
+typedef int (*MergeFunc)(void *existing, const void *data);
+
+#ifdef RBTREE_MAX_WEIGHT
+/**
+ * pointer to a function that gives the weight of a tree item.
+ * @data: a pointer to an item of the tree.
+ * @return: the weight of the item.
+ */
+typedef long double (*WeightFunc)(const void *data);
+#endif
+
+/*
+ * a node of the tree.
+ */
+typedef struct Node
+{
+#ifdef RBTREE_COMPACT_NODE
+	uintptr_t parentAndColor; // the parent pointer, with the color in its lowest bit (nodes are aligned to 8).
+	struct Node *left, *right;
+#else
+	struct Node *parent, *left, *right;
+	Color color;
+#endif
+	void *data;
+#ifdef RBTREE_ORDER_STATISTICS
+	long unsigned subtreeSize;
+#endif
+#ifdef RBTREE_MAX_WEIGHT
+	long double weight; // computed once, when the node is created.
+	struct Node *maxWeightNode; // the first heaviest node of the sub tree, in ascending order.
+#endif
+} Node;
+
+struct NodePool;
+
+#ifdef RBTREE_STATS
+/**
+ * number of buckets of each latency histogram. bucket i counts the operations that took [2^i, 2^(i+1))
+ * nanoseconds, the last bucket counts all the slower ones.
+ */
+#define RBTREE_LATENCY_BUCKETS 32
+
+/**
+ * the operations with a latency histogram.
+ */
+typedef enum RBTreeOperation
+{
+	RBTREE_INSERT, RBTREE_DELETE, RBTREE_CONTAINS, RBTREE_OPERATIONS
+} RBTreeOperation;
+
+/**
+ * the counters of a tree, since it was created or since resetRBTreeStats. the average search depth is
+ * totalSearchDepth / searches.
+ */
+typedef struct RBTreeStats
+{
+	long unsigned comparisons; // calls to the CompareFunc by searches of the tree.
+	long unsigned rotations;
+	long unsigned recolors; // red uncles pushed up by insert.
+	long unsigned doubleBlackFixups; // steps of the fixup of a removed black node.
+	long unsigned allocations; // nodes allocated.
+	long unsigned searches, totalSearchDepth, maxSearchDepth;
+	long unsigned latency[RBTREE_OPERATIONS][RBTREE_LATENCY_BUCKETS];
+} RBTreeStats;
+#endif
+
+/**
+ * represents the tree
+ */
+typedef struct RBTree
+{
+	Node *root;
+	CompareFunc compFunc;
+	FreeFunc freeFunc;
+	long unsigned size;
+	struct NodePool *pool; // NULL if nodes are allocated with malloc.
+	SizeFunc sizeFunc; // NULL if the sizes of the items are not tracked.
+	size_t dataBytes; // the sum of the sizes of the items, by sizeFunc.
+	Node *finger; // the last inserted node, NULL if there is none or it was removed.
+	int sequential; // whether the last insert was next to the one before, so the next one starts at finger.
+#ifdef RBTREE_MAX_WEIGHT
+	WeightFunc weightFunc; // NULL gives every item the weight 0.
+#endif
+#ifdef RBTREE_STATS
+	RBTreeStats *stats; // a pointer, so that the const operations can count too.
+#endif
+} RBTree;
+
+/**
+ * a cursor on the items of a tree, in ascending order. it stays valid as long as the item it points at is
+ * not deleted from the tree.
+ */
+typedef struct RBTreeIterator
+{
+	const RBTree *tree;
+	Node *node; // NULL if the iterator is invalid.
+} RBTreeIterator;
+
+/**
+ * constructs a new RBTree with the given CompareFunc.
+ * comp: a function two compare two variables.
+ */
+RBTree *newRBTree(CompareFunc compFunc, FreeFunc freeFunc); // implement it in RBTree.c
+
+/**
+ * constructs a new RBTree that allocates its nodes from pool instead of malloc.
+ * the tree takes ownership of the pool: the pool is released (all at once) by freeRBTree, so it must
+ * not be shared with another tree.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free the items of the tree.
+ * @param pool: the NodePool (see NodePool.h) to allocate nodes from.
+ * @return: the new tree, NULL on failure.
+ */
+RBTree *newRBTreeWithPool(CompareFunc compFunc, FreeFunc freeFunc, struct NodePool *pool);
+
+/**
+ * constructs a new RBTree from items sorted in strictly ascending order by compFunc, in linear time
+ * (compFunc is only called to check that each item is greater than the one before it).
+ * @param items: the sorted items. on success the tree owns them (not the array itself).
+ * @param n: number of items.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free the items of the tree.
+ * @return: the new tree, NULL on failure (items not strictly ascending, or allocation failure).
+ */
+RBTree *newRBTreeFromSorted(void **items, size_t n, CompareFunc compFunc, FreeFunc freeFunc);
+
+/**
+ * constructs a new RBTree from items in any order. the array is sorted in place with compFunc first, then
+ * the tree is built like in newRBTreeFromSorted.
+ * @param items: the items. on success the tree owns them (not the array itself).
+ * @param n: number of items.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free the items of the tree.
+ * @return: the new tree, NULL on failure (two equal items, or allocation failure).
+ */
+RBTree *newRBTreeFromUnsorted(void **items, size_t n, CompareFunc compFunc, FreeFunc freeFunc);
+
+/**
+ * fill an empty tree (made by any of the constructors) from items sorted in strictly ascending order, in
+ * linear time.
+ * @param tree: the empty tree to fill.
+ * @param items: the sorted items. on success the tree owns them (not the array itself).
+ * @param n: number of items.
+ * @return: 0 on failure (tree not empty, items not strictly ascending, or allocation failure - the tree
+ * stays empty), other on success.
+ */
+int buildRBTreeFromSorted(RBTree *tree, void **items, size_t n);
+
+/**
+ * add an item to the tree
+ * @param tree: the tree to add an item to.
+ * @param data: item to add to the tree.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToRBTree(RBTree *tree, void *data); // implement it in RBTree.c
+
+/**
+ * add an item to the tree, searching for its place from hint (a node of the tree near it) instead of from the
+ * root: O(1) amortized when data is next to hint, O(log d) when there are d items between them.
+ * insertToRBTree does the same from the last inserted node when the inserts come in ascending or descending
+ * order, so a hint is only needed for other patterns.
+ * @param tree: the tree to add an item to.
+ * @param data: item to add to the tree.
+ * @param hint: a node of tree, for example the node of an RBTreeIterator. NULL for the last inserted node.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToRBTreeWithHint(RBTree *tree, void *data, const Node *hint);
+
+/**
+ * find the item of the tree that is equal to data, or add data to the tree if there is none, with one search.
+ * a node is allocated only if data is added.
+ * @param tree: the tree to search in.
+ * @param data: item to find or add.
+ * @param existing: set to the item of the tree equal to data, which is data itself if it was added.
+ * @return: 0 on failure (existing is set to NULL and data is not added), other on success.
+ */
+int RBTreeFindOrInsert(RBTree *tree, void *data, void **existing);
+
+/**
+ * add data to the tree, or merge it into the item of the tree that is equal to it, with one search. the weight
+ * and the size of a merged item are measured again.
+ * @param tree: the tree to add the item to.
+ * @param data: item to add. on success it belongs to the tree: if it was merged it is freed with the FreeFunc of
+ * the tree.
+ * @param mergeFunc: merges data into the equal item of the tree.
+ * @return: 0 on failure (the tree and data are unchanged, unless mergeFunc failed half way), other on success.
+ */
+int RBTreeUpsert(RBTree *tree, void *data, MergeFunc mergeFunc);
+
+/**
+ * remove an item from the tree
+ * @param tree: the tree to remove an item from.
+ * @param data: item to remove from the tree.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromRBTree(RBTree *tree, void *data); // implement it in RBTree.c
+
+/**
+ * returned by insertManyToRBTree and deleteManyFromRBTree when an allocation failed, so it is not mistaken for a
+ * batch that matched nothing.
+ */
+#define RBTREE_BATCH_FAILED ((size_t) -1)
+
+/**
+ * add a batch of items to the tree. the batch is sorted with the CompareFunc of the tree and then merged into
+ * the tree in one linear pass (when it is large compared to the tree) or inserted in ascending order.
+ * @param tree: the tree to add the items to.
+ * @param items: the items to add. the array itself is not changed.
+ * @param n: the number of items.
+ * @param results: if not NULL, results[i] is set to 0 if items[i] was not inserted (NULL, already in the tree,
+ * equal to an earlier item of the batch or not added because an allocation failed), other if it was.
+ * @return: the number of items inserted, RBTREE_BATCH_FAILED if an allocation failed (results tells which items
+ * were inserted before it).
+ */
+size_t insertManyToRBTree(RBTree *tree, void **items, size_t n, int *results);
+
+/**
+ * remove a batch of items from the tree. the batch is sorted with the CompareFunc of the tree and then the
+ * tree is rebuilt without them in one linear pass (when the batch is large compared to the tree) or they are
+ * removed in ascending order.
+ * @param tree: the tree to remove the items from.
+ * @param items: the items to remove. the array itself is not changed.
+ * @param n: the number of items.
+ * @param results: if not NULL, results[i] is set to 0 if items[i] was not removed (NULL, not in the tree or
+ * equal to an earlier item of the batch), other if it was.
+ * @return: the number of items removed, RBTREE_BATCH_FAILED if an allocation failed (then nothing is removed and
+ * all the results are 0).
+ */
+size_t deleteManyFromRBTree(RBTree *tree, void **items, size_t n, int *results);
+
+/**
+ * check whether the tree RBTreeContains this item.
+ * @param tree: the tree to check an item in.
+ * @param data: item to check.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int RBTreeContains(const RBTree *tree, const void *data); // implement it in RBTree.c
+
+
+
+/**
+ * Activate a function on each item of the tree. the order is an ascending order. if one of the activations of the
+ * function returns 0, the process stops.
+ * @param tree: the tree with all the items.
+ * @param func: the function to activate on all items.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success.
+ */
+int forEachRBTree(const RBTree *tree, forEachFunc func, void *args); // implement it in RBTree.c
+
+/**
+ * Activate a function on each item of the tree in the range [low, high), in ascending order. if one of the
+ * activations of the function returns 0, the process stops. takes O(log n + k) for k items in the range.
+ * @param tree: the tree with all the items.
+ * @param low: the smallest item in the range (need not be in the tree), NULL to start at the first item.
+ * @param high: the first item after the range (need not be in the tree), NULL to go up to the last item.
+ * @param func: the function to activate on the items.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success.
+ */
+int forEachInRange(const RBTree *tree, const void *low, const void *high, forEachFunc func, void *args);
+
+/**
+ * place iterator at the smallest item of tree.
+ * @return: 0 if the tree is empty (the iterator is invalid), other otherwise.
+ */
+int RBTreeBegin(const RBTree *tree, RBTreeIterator *iterator);
+
+/**
+ * place iterator at the largest item of tree.
+ * @return: 0 if the tree is empty (the iterator is invalid), other otherwise.
+ */
+int RBTreeLast(const RBTree *tree, RBTreeIterator *iterator);
+
+/**
+ * place iterator at the first item of tree that is not smaller than data (lower bound).
+ * @return: 0 if there is no such item (the iterator is invalid), other otherwise.
+ */
+int RBTreeLowerBound(const RBTree *tree, const void *data, RBTreeIterator *iterator);
+
+/**
+ * place iterator at the first item of tree that is larger than data (upper bound).
+ * @return: 0 if there is no such item (the iterator is invalid), other otherwise.
+ */
+int RBTreeUpperBound(const RBTree *tree, const void *data, RBTreeIterator *iterator);
+
+/**
+ * move iterator to the next item in ascending order.
+ * @return: 0 if there is no next item (the iterator becomes invalid), other otherwise.
+ */
+int RBTreeIteratorNext(RBTreeIterator *iterator);
+
+/**
+ * move iterator to the previous item in ascending order.
+ * @return: 0 if there is no previous item (the iterator becomes invalid), other otherwise.
+ */
+int RBTreeIteratorPrev(RBTreeIterator *iterator);
+
+/**
+ * @return: the item iterator points at, NULL if the iterator is invalid.
+ */
+void *RBTreeIteratorData(const RBTreeIterator *iterator);
+
+/**
+ * set the function that gives the sizes of the items, so that tree->dataBytes holds the total size of the items
+ * from now on (the items already in the tree are measured in O(n)).
+ * @param tree: the tree to set the function of.
+ * @param sizeFunc: the function, NULL to stop tracking (dataBytes becomes 0).
+ * @return: 0 on failure, other on success.
+ */
+int setRBTreeSizeFunc(RBTree *tree, SizeFunc sizeFunc);
+
+#ifdef RBTREE_ORDER_STATISTICS
+/**
+ * find the k-th smallest item of the tree, in O(log n).
+ * @param tree: the tree to search in.
+ * @param k: the rank of the item, from 0 (the smallest item) to size - 1.
+ * @return: the item, NULL if k is out of range.
+ */
+void *RBTreeSelect(const RBTree *tree, long unsigned k);
+
+/**
+ * count the items of the tree that are smaller than data, in O(log n).
+ * @param tree: the tree to search in.
+ * @param data: the item to rank (need not be in the tree).
+ * @return: the number of items smaller than data (the index data has or would have in ascending order).
+ */
+long unsigned RBTreeRank(const RBTree *tree, const void *data);
+
+/**
+ * @return: the lower median of the tree (the item of rank (size - 1) / 2), NULL if the tree is empty.
+ */
+void *RBTreeMedian(const RBTree *tree);
+#endif
+
+#ifdef RBTREE_MAX_WEIGHT
+/**
+ * set the function that gives the weights of the items, and weigh the items already in the tree (in O(n)).
+ * @param tree: the tree to set the function of.
+ * @param weightFunc: the function, NULL to give every item the weight 0.
+ * @return: 0 on failure, other on success.
+ */
+int setRBTreeWeightFunc(RBTree *tree, WeightFunc weightFunc);
+
+/**
+ * find the heaviest item of the tree in O(1). of equally heavy items, the smallest one is returned.
+ * @param tree: the tree to search in.
+ * @return: the item with the largest weight, NULL if the tree is empty.
+ */
+void *RBTreeMaxWeight(const RBTree *tree);
+
+/**
+ * find the k heaviest items of the tree, heaviest first, with O(k log n) heap operations.
+ * @param tree: the tree to search in.
+ * @param k: the number of items to find.
+ * @param items: an array of at least k items, filled with the heaviest items.
+ * @return: the number of items found (less than k if the tree is smaller), 0 on failure.
+ */
+size_t RBTreeTopWeights(const RBTree *tree, size_t k, void **items);
+#endif
+
+#ifdef RBTREE_STATS
+/**
+ * copy the counters of the tree. may run while other threads read the tree.
+ * @param tree: the tree to get the counters of.
+ * @param stats: filled with the counters.
+ * @return: 0 on failure, other on success.
+ */
+int getRBTreeStats(const RBTree *tree, RBTreeStats *stats);
+
+/**
+ * set all the counters of the tree to 0.
+ * @param tree: the tree to reset the counters of.
+ */
+void resetRBTreeStats(RBTree *tree);
+#endif
+
+/**
+ * free all memory of the data structure.
+ * @param tree: pointer to the tree to free.
+ */
+void freeRBTree(RBTree **tree); // implement it in RBTree.c
+
+
+#endif //RBTREE_RBTREE_H
@@ -0,0 +1,2144 @@
+/**
+ * benchmarks of the RBTree library. build with optimizations, for example:
+ *     gcc -O2 -std=c99 RBTreeBenchmark.c RBTree-2.c NodePool.c Structs-2.c VectorKernels.c VectorArena.c \
+ *         ConcurrentRBTree.c PersistentRBTree.c ParallelRBTree.c MappedRBTree.c FrozenRBTree.c RBTreeSetOps.c \
+ *         ShardedRBTree.c RBTreeLoader.c VectorIndex.c RadixTree.c -lpthread -lm -o RBTreeBenchmark
+ * usage: RBTreeBenchmark [number of items]
+ *        RBTreeBenchmark --suite [--max-items N] [--memory-mb MB] [--repeat R] [--baseline previous.json]
+ *                                [--threshold percent]
+ * the suite measures ns/op, allocations/op and peak RSS of the core operations for tree sizes 1e3 up to
+ * --max-items (1e7 by default) and prints them as JSON. with --baseline it compares each result to a previous
+ * run, and exits with failure if one is slower by more than --threshold percent (10 by default). each case
+ * runs --repeat times (3 by default) in a new process and the fastest run is reported. cases that need more than
+ * --memory-mb (4096 by default) are skipped.
+ * build it with and without -DRBTREE_COMPACT_NODE (or another layout flag of RBTree.h) to compare node layouts.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "RBTree.h"
+#include "Structs.h"
+#include "SpecializedTrees.h"
+#include "ConcurrentRBTree.h"
+#include "PersistentRBTree.h"
+#include "ParallelRBTree.h"
+#include "VectorKernels.h"
+#include "VectorArena.h"
+#include "MappedRBTree.h"
+#include "FrozenRBTree.h"
+#include "RBTreeSetOps.h"
+#include "ShardedRBTree.h"
+#include "RBTreeLoader.h"
+#include "NodePool.h"
+#include "VectorIndex.h"
+#include "RadixTree.h"
+
+#define DEFAULT_ITEMS 1000000
+#define STRING_LENGTH 16
+#define VECTOR_LENGTH 8
+#define LOOKUPS_PER_THREAD 200000
+#define PERSISTENT_EXPORTS 5
+#define SHARDED_OPERATIONS_PER_THREAD 200000
+#define SHARDS_PER_THREAD 4
+#define PARALLEL_VECTOR_LENGTH 256
+#define KERNEL_ELEMENTS 50000000
+#define SUITE_MIN_ITEMS 1000
+#define SUITE_MAX_ITEMS 10000000
+#define SUITE_MEMORY_MB 4096
+#define SUITE_REPEAT 3
+#define SUITE_SHORT_STRING 8
+#define SUITE_LONG_STRING 128
+#define REGRESSION_PERCENT 10.0
+#define MAX_CASE_RESULTS 8
+#define WORD_LENGTH 4
+#define LOADER_LINE_BYTES 4096
+#define NEIGHBORS 10
+#define VECTOR_CLUSTERS 64
+#define CLUSTER_SPREAD 0.2
+#define VECTOR_QUERIES 200
+#define PREFIX_CATEGORIES 200
+#define PREFIX_KEY_BYTES 128
+#define PREFIX_QUERIES 1000
+
+
+#ifdef __GLIBC__
+// glibc only: count the allocations of the whole program by interposing malloc, calloc and realloc.
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+
+size_t allocations = 0;
+
+
+void *malloc(size_t size)
+{
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+
+void *calloc(size_t count, size_t size)
+{
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(count, size);
+}
+
+
+void *realloc(void *pointer, size_t size)
+{
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(pointer, size);
+}
+
+
+/**
+ * @return: the number of allocations made by the program so far, or -1 if they are not counted.
+ */
+double allocationCount(void)
+{
+    return (double) __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+}
+#else
+double allocationCount(void)
+{
+    return -1;
+}
+#endif
+
+
+/**
+ * @return: the time of a monotonic clock, in seconds.
+ */
+double nowSeconds(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + (double) time.tv_nsec * 1e-9;
+}
+
+
+/**
+ * print the result of a benchmark.
+ * @param name: the name of the benchmark.
+ * @param seconds: the total time of all the operations.
+ * @param operations: the number of operations.
+ */
+void report(const char *name, double seconds, size_t operations)
+{
+    printf("%-40s %10.1f ns/op\n", name, seconds * 1e9 / (double) (operations == 0 ? 1 : operations));
+}
+
+
+/**
+ * @return: a new random string of length letters, NULL on failure.
+ */
+char *randomString(int length)
+{
+    char *s = (char *) malloc(length + 1);
+    if (s == NULL)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < length; ++i)
+    {
+        s[i] = (char) ('a' + rand() % 26);
+    }
+    s[length] = '\0';
+    return s;
+}
+
+
+/**
+ * fill the elements of v with random values.
+ * @return: v.
+ */
+Vector *randomElements(Vector *v)
+{
+    for (int i = 0; v != NULL && i < v->len; ++i)
+    {
+        v->vector[i] = (double) rand() / RAND_MAX * 100;
+    }
+    return v;
+}
+
+
+/**
+ * @return: a new random Vector of length elements, NULL on failure.
+ */
+Vector *randomVector(int length)
+{
+    Vector *v = (Vector *) malloc(sizeof(Vector));
+    if (v == NULL)
+    {
+        return NULL;
+    }
+    v->len = length;
+    v->vector = (double *) malloc(length * sizeof(double));
+    if (v->vector == NULL)
+    {
+        free(v);
+        return NULL;
+    }
+    return randomElements(v);
+}
+
+
+/**
+ * @return: an array of n random items made by make, NULL on failure.
+ */
+void **randomItems(size_t n, void *(*make)(int), int length)
+{
+    void **items = (void **) malloc(n * sizeof(void *));
+    if (items == NULL)
+    {
+        return NULL;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        items[i] = make(length);
+    }
+    return items;
+}
+
+
+/**
+ * randomItems maker of random strings.
+ */
+void *makeString(int length)
+{
+    return randomString(length);
+}
+
+
+/**
+ * randomItems maker of random Vectors.
+ */
+void *makeVector(int length)
+{
+    return randomVector(length);
+}
+
+
+/**
+ * randomItems maker of random Vectors made by newContiguousVector.
+ */
+void *makeContiguousVector(int length)
+{
+    return randomElements(newContiguousVector(length));
+}
+
+
+/**
+ * the arena of makeArenaVector.
+ */
+VectorArena *benchmarkArena = NULL;
+
+
+/**
+ * randomItems maker of random Vectors allocated from benchmarkArena.
+ */
+void *makeArenaVector(int length)
+{
+    if (benchmarkArena == NULL && (benchmarkArena = newVectorArena()) == NULL)
+    {
+        return NULL;
+    }
+    return randomElements(allocateArenaVector(benchmarkArena, length));
+}
+
+
+/**
+ * compare the generic function pointer tree with the specialized one on the same keys.
+ * @param name: the name of the item type.
+ * @param items: the keys, owned by the benchmark. the trees get copies made by copy.
+ * @param n: number of keys.
+ * @param compFunc, freeFunc: the functions of the generic tree.
+ * @param newSpecialized, insertSpecialized, containsSpecialized: the specialized tree functions.
+ * @param copy: makes a copy of a key the tree can own.
+ */
+void benchmarkSpecialized(const char *name, void **items, size_t n, CompareFunc compFunc, FreeFunc freeFunc,
+                          RBTree *(*newSpecialized)(void), int (*insertSpecialized)(RBTree *, void *),
+                          int (*containsSpecialized)(const RBTree *, const void *), void *(*copy)(const void *))
+{
+    char title[128];
+    RBTree *generic = newRBTree(compFunc, freeFunc);
+    RBTree *specialized = newSpecialized();
+    void **copies = (void **) malloc(2 * n * sizeof(void *));
+    if (generic == NULL || specialized == NULL || copies == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < 2 * n; ++i)
+    {
+        copies[i] = copy(items[i % n]);
+    }
+
+    double start = nowSeconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!insertToRBTree(generic, copies[i]))
+        {
+            freeFunc(copies[i]);
+        }
+    }
+    snprintf(title, sizeof(title), "%s insert (function pointer)", name);
+    report(title, nowSeconds() - start, n);
+
+    start = nowSeconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!insertSpecialized(specialized, copies[n + i]))
+        {
+            freeFunc(copies[n + i]);
+        }
+    }
+    snprintf(title, sizeof(title), "%s insert (specialized)", name);
+    report(title, nowSeconds() - start, n);
+
+    size_t found = 0;
+    start = nowSeconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        found += RBTreeContains(generic, items[i]);
+    }
+    snprintf(title, sizeof(title), "%s contains (function pointer)", name);
+    report(title, nowSeconds() - start, n);
+
+    start = nowSeconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        found -= containsSpecialized(specialized, items[i]);
+    }
+    snprintf(title, sizeof(title), "%s contains (specialized)", name);
+    report(title, nowSeconds() - start, n);
+    if (found != 0)
+    {
+        fprintf(stderr, "%s: the trees disagree\n", name);
+    }
+
+    freeRBTree(&generic);
+    freeRBTree(&specialized);
+    free(copies);
+}
+
+
+/**
+ * @return: a new copy of the string s.
+ */
+void *copyString(const void *s)
+{
+    char *copy = (char *) malloc(strlen(s) + 1);
+    if (copy != NULL)
+    {
+        strcpy(copy, s);
+    }
+    return copy;
+}
+
+
+/**
+ * @return: a new deep copy of the Vector v.
+ */
+void *copyVector(const void *v)
+{
+    const Vector *vector = (const Vector *) v;
+    Vector *copy = (Vector *) malloc(sizeof(Vector));
+    if (copy != NULL)
+    {
+        copy->len = vector->len;
+        copy->vector = (double *) malloc(vector->len * sizeof(double));
+        if (copy->vector != NULL)
+        {
+            memcpy(copy->vector, vector->vector, vector->len * sizeof(double));
+        }
+    }
+    return copy;
+}
+
+
+/**
+ * compare the vectorized Vector kernels with the plain loops, on vectors that differ only in their last element
+ * (the longest compare).
+ */
+void benchmarkVectorKernels(void)
+{
+    char title[128];
+    printf("vector kernels: %s\n", vectorKernelsName());
+    for (int length = 128; length <= 1024; length *= 2)
+    {
+        Vector *a = randomVector(length), *b = (Vector *) copyVector(a);
+        if (a == NULL || b == NULL || b->vector == NULL)
+        {
+            fprintf(stderr, "allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        b->vector[length - 1] += 1;
+        size_t iterations = KERNEL_ELEMENTS / length, differences = 0;
+        long double norms = 0;
+
+        double start = nowSeconds();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            differences += firstDifferenceScalar(a->vector, b->vector, length);
+        }
+        snprintf(title, sizeof(title), "compare %d (scalar)", length);
+        report(title, nowSeconds() - start, iterations);
+
+        start = nowSeconds();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            differences -= firstDifference(a->vector, b->vector, length);
+        }
+        snprintf(title, sizeof(title), "compare %d (%s)", length, vectorKernelsName());
+        report(title, nowSeconds() - start, iterations);
+
+        start = nowSeconds();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            norms += sumOfSquaresScalar(a->vector, length);
+        }
+        snprintf(title, sizeof(title), "sum of squares %d (scalar)", length);
+        report(title, nowSeconds() - start, iterations);
+
+        start = nowSeconds();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            norms -= sumOfSquares(a->vector, length);
+        }
+        snprintf(title, sizeof(title), "sum of squares %d (%s)", length, vectorKernelsName());
+        report(title, nowSeconds() - start, iterations);
+        long double error = norms < 0 ? -norms : norms;
+        if (differences != 0 || error > 1e-6L * iterations * sumOfSquaresScalar(a->vector, length))
+        {
+            fprintf(stderr, "vector kernels: the kernels disagree\n");
+        }
+        freeVector(a);
+        freeVector(b);
+    }
+}
+
+
+/**
+ * the arguments of a thread of the concurrent benchmark.
+ */
+typedef struct ConcurrentWorker
+{
+    ConcurrentRBTree *tree;
+    void **items;
+    size_t n;
+    unsigned int seed;
+    volatile int *stop; // set when the readers are done, for the writer.
+    size_t operations;
+} ConcurrentWorker;
+
+
+/**
+ * reader thread: look up random items.
+ */
+void *concurrentReader(void *args)
+{
+    ConcurrentWorker *worker = (ConcurrentWorker *) args;
+    size_t found = 0;
+    for (size_t i = 0; i < LOOKUPS_PER_THREAD; ++i)
+    {
+        worker->seed = worker->seed * 1103515245u + 12345u;
+        found += ConcurrentRBTreeContains(worker->tree, worker->items[worker->seed % worker->n]);
+    }
+    worker->operations = found;
+    return NULL;
+}
+
+
+/**
+ * writer thread: delete and insert back random items until the readers are done.
+ */
+void *concurrentWriter(void *args)
+{
+    ConcurrentWorker *worker = (ConcurrentWorker *) args;
+    worker->operations = 0;
+    while (!*worker->stop)
+    {
+        worker->seed = worker->seed * 1103515245u + 12345u;
+        char *key = (char *) worker->items[worker->seed % worker->n];
+        if (deleteFromConcurrentRBTree(worker->tree, key))
+        {
+            insertToConcurrentRBTree(worker->tree, copyString(key));
+        }
+        worker->operations += 2;
+    }
+    return NULL;
+}
+
+
+/**
+ * measure the lookup throughput of a ConcurrentRBTree of strings with 1 to 2 * cores reader threads and the
+ * throughput of a single writer thread next to them.
+ * @param items: the keys, owned by the benchmark.
+ * @param n: number of keys.
+ */
+void benchmarkConcurrent(void **items, size_t n)
+{
+    ConcurrentRBTree *tree = newConcurrentRBTree(stringCompare, freeString);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int maxThreads = (int) (cores < 1 ? 1 : cores) * 2;
+    ConcurrentWorker *workers = (ConcurrentWorker *) malloc((maxThreads + 1) * sizeof(ConcurrentWorker));
+    pthread_t *threads = (pthread_t *) malloc((maxThreads + 1) * sizeof(pthread_t));
+    if (tree == NULL || workers == NULL || threads == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        void *copy = copyString(items[i]);
+        if (!insertToConcurrentRBTree(tree, copy))
+        {
+            freeString(copy);
+        }
+    }
+    for (int readers = 1; readers <= maxThreads; readers *= 2)
+    {
+        volatile int stop = 0;
+        for (int i = 0; i <= readers; ++i)
+        {
+            workers[i] = (ConcurrentWorker) {tree, items, n, (unsigned int) i + 1, &stop, 0};
+        }
+        double start = nowSeconds();
+        pthread_create(&threads[readers], NULL, concurrentWriter, &workers[readers]);
+        for (int i = 0; i < readers; ++i)
+        {
+            pthread_create(&threads[i], NULL, concurrentReader, &workers[i]);
+        }
+        for (int i = 0; i < readers; ++i)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        double seconds = nowSeconds() - start;
+        stop = 1;
+        pthread_join(threads[readers], NULL);
+        printf("concurrent contains, %2d readers + 1 writer %10.2f Mops/s, writer %10.3f Mops/s\n", readers,
+               (double) readers * LOOKUPS_PER_THREAD / seconds / 1e6,
+               (double) workers[readers].operations / seconds / 1e6);
+    }
+    freeConcurrentRBTree(&tree);
+    free(workers);
+    free(threads);
+}
+
+
+/**
+ * the arguments of a thread of benchmarkSharded.
+ */
+typedef struct ShardedWorker
+{
+    ShardedRBTree *tree;
+    void **items;
+    size_t n;
+    unsigned int seed;
+    void *(*copy)(const void *);
+} ShardedWorker;
+
+
+/**
+ * thread of benchmarkSharded: SHARDED_OPERATIONS_PER_THREAD random operations, a quarter of them lookups and
+ * the others writes (a delete, and an insert back of a copy of the item).
+ */
+void *shardedWorker(void *args)
+{
+    ShardedWorker *worker = (ShardedWorker *) args;
+    for (size_t i = 0; i < SHARDED_OPERATIONS_PER_THREAD; ++i)
+    {
+        worker->seed = worker->seed * 1103515245u + 12345u;
+        void *key = worker->items[(worker->seed >> 4) % worker->n];
+        if (worker->seed % 4 == 0)
+        {
+            ShardedRBTreeContains(worker->tree, key);
+        }
+        else if (deleteFromShardedRBTree(worker->tree, key))
+        {
+            insertToShardedRBTree(worker->tree, worker->copy(key));
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * measure the throughput of a write heavy mix of operations on a ShardedRBTree with 1 to 2 * cores threads,
+ * with a single shard (one lock, like a ConcurrentRBTree) and with SHARDS_PER_THREAD shards for each thread.
+ * @param name: the name of the kind of the items.
+ * @param items: the keys, owned by the benchmark.
+ * @param n: number of keys.
+ * @param copy: makes a copy of an item, to insert back after it is deleted.
+ */
+void benchmarkSharded(const char *name, void **items, size_t n, CompareFunc compFunc, FreeFunc freeFunc,
+                      HashFunc hashFunc, void *(*copy)(const void *))
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int maxThreads = (int) (cores < 1 ? 1 : cores) * 2;
+    ShardedWorker *workers = (ShardedWorker *) malloc(maxThreads * sizeof(ShardedWorker));
+    pthread_t *threads = (pthread_t *) malloc(maxThreads * sizeof(pthread_t));
+    if (workers == NULL || threads == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+    {
+        size_t shardCounts[] = {1, (size_t) maxThreads * SHARDS_PER_THREAD};
+        for (int method = 0; method < 2; ++method)
+        {
+            size_t shards = shardCounts[method];
+            ShardedRBTree *tree = newShardedRBTree(shards, compFunc, freeFunc, hashFunc);
+            if (tree == NULL)
+            {
+                fprintf(stderr, "allocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                void *item = copy(items[i]);
+                if (!insertToShardedRBTree(tree, item))
+                {
+                    freeFunc(item);
+                }
+            }
+            double start = nowSeconds();
+            for (int i = 0; i < threadCount; ++i)
+            {
+                workers[i] = (ShardedWorker) {tree, items, n, (unsigned int) i + 1, copy};
+                pthread_create(&threads[i], NULL, shardedWorker, &workers[i]);
+            }
+            for (int i = 0; i < threadCount; ++i)
+            {
+                pthread_join(threads[i], NULL);
+            }
+            double seconds = nowSeconds() - start;
+            printf("sharded %s, %2d threads, %4zu shards %10.2f Mops/s\n", name, threadCount, shards,
+                   (double) threadCount * SHARDED_OPERATIONS_PER_THREAD / seconds / 1e6);
+            freeShardedRBTree(&tree);
+        }
+    }
+    free(workers);
+    free(threads);
+}
+
+
+/**
+ * the number of items the FreeFunc of benchmarkPersistentSnapshot freed.
+ */
+size_t persistentFrees = 0;
+
+
+/**
+ * FreeFunc of benchmarkPersistentSnapshot: free a string and count it (items may be freed by any thread).
+ */
+void countedFreeString(void *s)
+{
+    __atomic_add_fetch(&persistentFrees, 1, __ATOMIC_RELAXED);
+    freeString(s);
+}
+
+
+/**
+ * the arguments of the threads of benchmarkPersistentSnapshot.
+ */
+typedef struct PersistentWorker
+{
+    PersistentRBTree *tree;
+    void **items;
+    size_t n;
+    unsigned int seed;
+    volatile int *stop; // set when the exporter is done, for the writer.
+    size_t deletes; // the items the writer deleted.
+    size_t writes;
+    RBTreeView *lastView; // the last view of the exporter, left alive.
+    int consistent; // the exporter found all its views consistent.
+    double exportSeconds;
+} PersistentWorker;
+
+
+/**
+ * the state of one export of a view: the items are checked to be in strictly ascending order, and summed by
+ * their hash so that two exports of the same view can be compared.
+ */
+typedef struct ViewExport
+{
+    const char *previous;
+    long unsigned count;
+    size_t hashSum;
+    int ordered;
+} ViewExport;
+
+
+/**
+ * ForEach function of the exporter of benchmarkPersistentSnapshot.
+ */
+int exportItem(const void *data, void *pExport)
+{
+    ViewExport *export = (ViewExport *) pExport;
+    if (export->previous != NULL && strcmp(export->previous, (const char *) data) >= 0)
+    {
+        export->ordered = false;
+    }
+    export->previous = (const char *) data;
+    export->count++;
+    export->hashSum += stringHash(data);
+    return true;
+}
+
+
+/**
+ * writer thread of benchmarkPersistentSnapshot: delete and insert back random items until the exporter is done.
+ */
+void *persistentWriter(void *args)
+{
+    PersistentWorker *worker = (PersistentWorker *) args;
+    while (!*worker->stop)
+    {
+        worker->seed = worker->seed * 1103515245u + 12345u;
+        char *key = (char *) worker->items[worker->seed % worker->n];
+        if (deleteFromPersistentRBTree(worker->tree, key))
+        {
+            worker->deletes++;
+            insertToPersistentRBTree(worker->tree, copyString(key));
+        }
+        worker->writes += 2;
+    }
+    return NULL;
+}
+
+
+/**
+ * exporter thread of benchmarkPersistentSnapshot: take PERSISTENT_EXPORTS snapshots, export each one twice with
+ * forEachRBTreeView and check that both exports see the same items, in order, and as many as the size of the
+ * view. all the views but the last one are released.
+ */
+void *persistentExporter(void *args)
+{
+    PersistentWorker *worker = (PersistentWorker *) args;
+    worker->consistent = true;
+    worker->exportSeconds = 0;
+    for (int i = 0; i < PERSISTENT_EXPORTS; ++i)
+    {
+        RBTreeView *view = RBTreeSnapshot(worker->tree);
+        if (view == NULL)
+        {
+            fprintf(stderr, "allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        ViewExport exports[2] = {{NULL, 0, 0, true}, {NULL, 0, 0, true}};
+        double start = nowSeconds();
+        forEachRBTreeView(view, exportItem, &exports[0]);
+        worker->exportSeconds += nowSeconds() - start;
+        forEachRBTreeView(view, exportItem, &exports[1]);
+        worker->consistent = worker->consistent && exports[0].ordered && exports[0].count == view->size &&
+                             exports[1].count == view->size && exports[0].hashSum == exports[1].hashSum;
+        if (i < PERSISTENT_EXPORTS - 1)
+        {
+            releaseRBTreeView(&view);
+        }
+        worker->lastView = view;
+    }
+    return NULL;
+}
+
+
+/**
+ * export snapshots of a PersistentRBTree of strings with forEachRBTreeView while a writer thread keeps deleting
+ * and inserting items, check that each view stays consistent, and that the items deleted while the last view
+ * was alive are kept for it and freed by releaseRBTreeView.
+ * @param items: the keys, owned by the benchmark.
+ * @param n: number of keys.
+ */
+void benchmarkPersistentSnapshot(void **items, size_t n)
+{
+    PersistentRBTree *tree = newPersistentRBTree(stringCompare, countedFreeString);
+    if (tree == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        void *copy = copyString(items[i]);
+        if (!insertToPersistentRBTree(tree, copy))
+        {
+            freeString(copy);
+        }
+    }
+    volatile int stop = 0;
+    PersistentWorker worker = {tree, items, n, 1, &stop, 0, 0, NULL, true, 0};
+    pthread_t writer, exporter;
+    double start = nowSeconds();
+    pthread_create(&writer, NULL, persistentWriter, &worker);
+    pthread_create(&exporter, NULL, persistentExporter, &worker);
+    pthread_join(exporter, NULL);
+    stop = 1;
+    pthread_join(writer, NULL);
+    double seconds = nowSeconds() - start;
+    size_t kept = worker.deletes - __atomic_load_n(&persistentFrees, __ATOMIC_RELAXED);
+    releaseRBTreeView(&worker.lastView);
+    size_t left = worker.deletes - __atomic_load_n(&persistentFrees, __ATOMIC_RELAXED);
+    printf("persistent snapshot of %lu items: export %8.2f ms, writer %8.3f Mops/s, views %s, "
+           "%zu deleted items kept for the last view, %zu after releaseRBTreeView\n", tree->size,
+           worker.exportSeconds * 1e3 / PERSISTENT_EXPORTS, (double) worker.writes / seconds / 1e6,
+           worker.consistent ? "consistent" : "INCONSISTENT", kept, left);
+    freePersistentRBTree(&tree);
+}
+
+
+/**
+ * compare the cold start of a tree of strings: inserting every item again, against mapping a snapshot file.
+ * @param items: the keys, owned by the benchmark.
+ * @param n: number of keys.
+ */
+void benchmarkMappedLoad(void **items, size_t n)
+{
+    char path[] = "/tmp/RBTreeBenchmarkXXXXXX";
+    int fd = mkstemp(path);
+    RBTree *tree = newRBTree(stringCompare, freeString);
+    if (fd < 0 || tree == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+    double start = nowSeconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        void *copy = copyString(items[i]);
+        if (!insertToRBTree(tree, copy))
+        {
+            freeString(copy);
+        }
+    }
+    double insertSeconds = nowSeconds() - start;
+    if (!saveRBTree(tree, MAPPED_STRINGS, path))
+    {
+        fprintf(stderr, "saveRBTree failed\n");
+        exit(EXIT_FAILURE);
+    }
+    start = nowSeconds();
+    MappedRBTree *mapped = loadMappedRBTree(path, stringCompare, freeString);
+    int found = mapped != NULL && MappedRBTreeContains(mapped, items[0]);
+    double loadSeconds = nowSeconds() - start;
+    printf("cold start, %zu strings: insert %10.1f ms, mapped load + first lookup %10.3f ms%s\n", n,
+           insertSeconds * 1e3, loadSeconds * 1e3, found || n == 0 ? "" : " (not found!)");
+    freeMappedRBTree(&mapped);
+    freeRBTree(&tree);
+    remove(path);
+}
+
+
+/**
+ * write the items of a benchmark to a file for the loaders: strings as lines, Vectors as records.
+ * @param path: the file to write.
+ * @return: the number of bytes written.
+ */
+size_t writeLoaderFile(const char *path, void **items, size_t n, bool vectors)
+{
+    FILE *file = fopen(path, "wb");
+    size_t bytes = 0;
+    for (size_t i = 0; file != NULL && i < n; ++i)
+    {
+        if (!vectors)
+        {
+            bytes += (size_t) fprintf(file, "%s\n", (const char *) items[i]);
+            continue;
+        }
+        const Vector *v = (const Vector *) items[i];
+        int64_t len = v->len;
+        bytes += sizeof(int64_t) * fwrite(&len, sizeof(int64_t), 1, file);
+        bytes += sizeof(double) * fwrite(v->vector, sizeof(double), (size_t) len, file);
+    }
+    if (file == NULL || fclose(file) != 0)
+    {
+        fprintf(stderr, "writing %s failed\n", path);
+        exit(EXIT_FAILURE);
+    }
+    return bytes;
+}
+
+
+/**
+ * read a file of the loaders item by item, allocating each one (a string, or a Vector and its elements).
+ * @return: the tree of the items.
+ */
+RBTree *loadItemByItem(const char *path, bool vectors)
+{
+    RBTree *tree = vectors ? newRBTree(vectorCompare1By1, freeVector) : newRBTree(stringCompare, freeString);
+    FILE *file = fopen(path, "rb");
+    char line[LOADER_LINE_BYTES];
+    int64_t len;
+    while (tree != NULL && file != NULL)
+    {
+        void *item = NULL;
+        if (!vectors && fgets(line, sizeof(line), file) != NULL)
+        {
+            line[strcspn(line, "\n")] = '\0';
+            item = copyString(line);
+        }
+        else if (vectors && fread(&len, sizeof(int64_t), 1, file) == 1)
+        {
+            Vector *v = (Vector *) malloc(sizeof(Vector));
+            v->len = (int) len;
+            v->vector = (double *) malloc((len > 0 ? (size_t) len : 1) * sizeof(double));
+            if (fread(v->vector, sizeof(double), (size_t) len, file) != (size_t) len)
+            {
+                freeVector(v);
+                break;
+            }
+            item = v;
+        }
+        else
+        {
+            break;
+        }
+        if (!insertToRBTree(tree, item))
+        {
+            tree->freeFunc(item);
+        }
+    }
+    if (tree == NULL || file == NULL)
+    {
+        fprintf(stderr, "reading %s failed\n", path);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+    return tree;
+}
+
+
+/**
+ * compare loading a file of strings or of Vectors item by item (with an allocation for each item) to loading it
+ * with the loader, which reads it in blocks into a LoadArena, into a tree with a NodePool.
+ * @param items: the items to write to the file, owned by the benchmark.
+ * @param n: number of items.
+ * @param vectors: whether the items are Vectors (otherwise strings).
+ */
+void benchmarkLoader(void **items, size_t n, bool vectors)
+{
+    char path[] = "/tmp/RBTreeLoaderXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        fprintf(stderr, "mkstemp failed\n");
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+    double megabytes = (double) writeLoaderFile(path, items, n, vectors) / 1e6;
+    for (int method = 0; method < 2; ++method)
+    {
+        LoadArena *arena = method == 0 ? NULL : newLoadArena();
+        // the loaded tree takes its nodes from a NodePool, so it does not allocate for each item either.
+        RBTree *tree = method == 0 ? NULL : newRBTreeWithPool(vectors ? vectorCompare1By1 : stringCompare,
+                                                              keepLoadedItem, newNodePool(0));
+        double startAllocations = allocationCount(), start = nowSeconds();
+        if (method == 0)
+        {
+            tree = loadItemByItem(path, vectors);
+        }
+        else if (tree == NULL || !(vectors ? loadVectorsFile(tree, path, arena) : loadStringsFile(tree, path, arena)))
+        {
+            fprintf(stderr, "loading %s failed\n", path);
+            exit(EXIT_FAILURE);
+        }
+        double seconds = nowSeconds() - start, allocations = allocationCount() - startAllocations;
+        printf("load %zu %s, %-14s %10.1f ms %8.1f MB/s %6.2f allocations/item\n", n, vectors ? "vectors" : "strings",
+               method == 0 ? "item by item" : "loader", seconds * 1e3, megabytes / seconds,
+               startAllocations < 0 ? -1 : allocations / (double) (n == 0 ? 1 : n));
+        freeRBTree(&tree);
+        freeLoadArena(&arena);
+    }
+    remove(path);
+}
+
+
+/**
+ * forEachFunc of the parallel benchmark: keep the largest squared norm in args, a long double.
+ */
+int keepLargestNorm(const void *pVector, void *pMaxNorm)
+{
+    const Vector *v = (const Vector *) pVector;
+    long double norm = 0;
+    for (int i = 0; i < v->len; ++i)
+    {
+        norm += v->vector[i] * v->vector[i];
+    }
+    if (norm > *(long double *) pMaxNorm)
+    {
+        *(long double *) pMaxNorm = norm;
+    }
+    return true;
+}
+
+
+/**
+ * CombineFunc of the parallel benchmark.
+ */
+int combineLargestNorm(void *into, const void *from)
+{
+    if (*(const long double *) from > *(long double *) into)
+    {
+        *(long double *) into = *(const long double *) from;
+    }
+    return true;
+}
+
+
+/**
+ * measure parallelForEachRBTree over a tree of Vectors with 1 to 2 * cores threads.
+ * @param n: number of vectors.
+ */
+void benchmarkParallelForEach(size_t n)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t maxThreads = (size_t) (cores < 1 ? 1 : cores) * 2;
+    RBTree *tree = newRBTree(vectorCompare1By1, freeVector);
+    long double *norms = (long double *) malloc(maxThreads * sizeof(long double));
+    void **args = (void **) malloc(maxThreads * sizeof(void *));
+    if (tree == NULL || norms == NULL || args == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        Vector *v = randomVector(PARALLEL_VECTOR_LENGTH);
+        if (!insertToRBTree(tree, v))
+        {
+            freeVector(v);
+        }
+    }
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        for (size_t i = 0; i < threads; ++i)
+        {
+            norms[i] = 0;
+            args[i] = &norms[i];
+        }
+        double start = nowSeconds();
+        parallelForEachRBTree(tree, keepLargestNorm, args, threads, combineLargestNorm);
+        printf("parallel forEach, %2zu threads %24.1f ns/item\n", threads,
+               (nowSeconds() - start) * 1e9 / (double) (tree->size == 0 ? 1 : tree->size));
+    }
+    freeRBTree(&tree);
+    free(norms);
+    free(args);
+}
+
+
+/**
+ * the state of the brute force k nearest neighbour scan of benchmarkVectorIndex: the nearest vectors so far, by
+ * ascending distance.
+ */
+typedef struct NearestScan
+{
+    const Vector *query;
+    size_t count;
+    const Vector *neighbors[NEIGHBORS];
+    double distances[NEIGHBORS];
+} NearestScan;
+
+
+/**
+ * ForEach function of the brute force scan: keep the vector if it is one of the NEIGHBORS nearest so far.
+ */
+int keepNearest(const void *v, void *pScan)
+{
+    NearestScan *scan = (NearestScan *) pScan;
+    double distance = vectorDistance(scan->query, (const Vector *) v);
+    if (scan->count == NEIGHBORS && distance >= scan->distances[NEIGHBORS - 1])
+    {
+        return true;
+    }
+    size_t i = scan->count < NEIGHBORS ? scan->count++ : NEIGHBORS - 1;
+    for (; i > 0 && scan->distances[i - 1] > distance; --i)
+    {
+        scan->neighbors[i] = scan->neighbors[i - 1];
+        scan->distances[i] = scan->distances[i - 1];
+    }
+    scan->neighbors[i] = (const Vector *) v;
+    scan->distances[i] = distance;
+    return true;
+}
+
+
+/**
+ * @return: a new random Vector of length elements near one of the clusters (rows of length elements).
+ */
+Vector *clusteredVector(const double *clusters, int length)
+{
+    Vector *v = randomVector(length);
+    if (v == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    const double *center = clusters + (size_t) (rand() % VECTOR_CLUSTERS) * (size_t) length;
+    for (int i = 0; i < length; ++i)
+    {
+        v->vector[i] = center[i] + ((double) rand() / RAND_MAX - 0.5) * CLUSTER_SPREAD;
+    }
+    return v;
+}
+
+
+/**
+ * compare the k nearest neighbour queries of a VectorIndex to a scan of the whole tree with forEachRBTree, on
+ * clustered vectors of 64 and 256 elements.
+ * @param n: number of vectors.
+ */
+void benchmarkVectorIndex(size_t n)
+{
+    int lengths[] = {64, 256};
+    for (int l = 0; l < 2; ++l)
+    {
+        int length = lengths[l];
+        RBTree *tree = newRBTree(vectorCompare1By1, freeVector);
+        double *clusters = (double *) malloc((size_t) VECTOR_CLUSTERS * (size_t) length * sizeof(double));
+        if (tree == NULL || clusters == NULL)
+        {
+            fprintf(stderr, "allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < (size_t) VECTOR_CLUSTERS * (size_t) length; ++i)
+        {
+            clusters[i] = (double) rand() / RAND_MAX * 2 - 1;
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            Vector *v = clusteredVector(clusters, length);
+            if (!insertToRBTree(tree, v))
+            {
+                freeVector(v);
+            }
+        }
+        double start = nowSeconds();
+        VectorIndex *index = newVectorIndex(tree);
+        double buildSeconds = nowSeconds() - start, scanSeconds = 0, indexSeconds = 0;
+        if (index == NULL)
+        {
+            fprintf(stderr, "allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        size_t mismatches = 0;
+        for (int q = 0; q < VECTOR_QUERIES; ++q)
+        {
+            Vector *query = clusteredVector(clusters, length);
+            NearestScan scan = {query, 0, {NULL}, {0}};
+            const Vector *neighbors[NEIGHBORS];
+            double distances[NEIGHBORS];
+            start = nowSeconds();
+            forEachRBTree(tree, keepNearest, &scan);
+            scanSeconds += nowSeconds() - start;
+            start = nowSeconds();
+            size_t found = knnQuery(index, query, NEIGHBORS, neighbors, distances);
+            indexSeconds += nowSeconds() - start;
+            mismatches += found != scan.count || (found > 0 && distances[found - 1] != scan.distances[found - 1]);
+            freeVector(query);
+        }
+        printf("%d nearest of %lu vectors of %3d: build %8.1f ms, scan %9.1f us/query, index %9.1f us/query%s\n",
+               NEIGHBORS, tree->size, length, buildSeconds * 1e3, scanSeconds * 1e6 / VECTOR_QUERIES,
+               indexSeconds * 1e6 / VECTOR_QUERIES, mismatches == 0 ? "" : " (results differ!)");
+        freeVectorIndex(&index);
+        freeRBTree(&tree);
+        free(clusters);
+    }
+}
+
+
+/**
+ * free an array of items and the items.
+ */
+void freeItems(void **items, size_t n, FreeFunc freeFunc)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        freeFunc(items[i]);
+    }
+    free(items);
+}
+
+
+/**
+ * a kind of items of the suite.
+ */
+typedef struct Workload
+{
+    const char *name;
+    void *(*make)(int);
+    int length;
+    CompareFunc compFunc;
+    FreeFunc freeFunc;
+    size_t bytesPerItem; // an estimate of the memory of an item in a tree, with its node.
+    bool vectors;
+} Workload;
+
+/**
+ * the order the keys are inserted and deleted in.
+ */
+typedef enum KeyOrder
+{
+    RANDOM_ORDER, SORTED_ORDER, REVERSE_ORDER
+} KeyOrder;
+
+const char *keyOrderNames[] = {"random", "sorted", "reverse"};
+
+/**
+ * the measurement of one operation of the suite.
+ */
+typedef struct OperationResult
+{
+    char operation[32];
+    double nsPerOp;
+    double allocationsPerOp;
+    long peakRssKb;
+} OperationResult;
+
+/**
+ * a result of a previous run, to compare with.
+ */
+typedef struct BaselineResult
+{
+    char workload[32];
+    char order[16];
+    size_t items;
+    char operation[32];
+    double nsPerOp;
+} BaselineResult;
+
+/**
+ * the options of the suite.
+ */
+typedef struct SuiteOptions
+{
+    size_t maxItems;
+    size_t memoryMb;
+    size_t repeat; // each case runs repeat times, and the fastest run is reported.
+    double threshold;
+    BaselineResult *baseline;
+    size_t baselineCount;
+} SuiteOptions;
+
+
+/**
+ * set the time and the allocations per operation of result.
+ */
+void measure(OperationResult *result, const char *operation, double start, double startAllocations,
+             size_t operations)
+{
+    double seconds = nowSeconds() - start, allocated = allocationCount() - startAllocations;
+    double count = (double) (operations == 0 ? 1 : operations);
+    snprintf(result->operation, sizeof(result->operation), "%s", operation);
+    result->nsPerOp = seconds * 1e9 / count;
+    result->allocationsPerOp = startAllocations < 0 ? -1 : allocated / count;
+}
+
+
+/**
+ * the comparison function of sortKeys.
+ */
+CompareFunc keyCompare = NULL;
+
+
+/**
+ * qsort adapter of keyCompare.
+ */
+int compareKeys(const void *a, const void *b)
+{
+    return keyCompare(*(void *const *) a, *(void *const *) b);
+}
+
+
+/**
+ * put the keys in the given order.
+ */
+void orderKeys(void **keys, size_t n, CompareFunc compFunc, KeyOrder order)
+{
+    if (order == RANDOM_ORDER)
+    {
+        return;
+    }
+    keyCompare = compFunc;
+    qsort(keys, n, sizeof(void *), compareKeys);
+    for (size_t i = 0; order == REVERSE_ORDER && i < n / 2; ++i)
+    {
+        void *key = keys[i];
+        keys[i] = keys[n - 1 - i];
+        keys[n - 1 - i] = key;
+    }
+}
+
+
+/**
+ * forEachFunc of the suite: count the items.
+ */
+int countItem(const void *data, void *pCount)
+{
+    (void) data;
+    (*(size_t *) pCount)++;
+    return true;
+}
+
+
+/**
+ * run all the operations of the suite on one tree, made of n new items of workload inserted in order.
+ * @param results: filled with the measurement of each operation.
+ * @return: the number of results.
+ */
+size_t runCase(const Workload *workload, KeyOrder order, size_t n, OperationResult *results)
+{
+    size_t count = 0, inserted = 0, found = 0, visited = 0;
+    srand(1);
+    void **keys = randomItems(n, workload->make, workload->length);
+    void **lookups = (void **) malloc((n == 0 ? 1 : n) * sizeof(void *));
+    RBTree *tree = newRBTree(workload->compFunc, workload->freeFunc);
+    if (keys == NULL || lookups == NULL || tree == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    orderKeys(keys, n, workload->compFunc, order);
+#ifdef RBTREE_MAX_WEIGHT
+    if (workload->vectors)
+    {
+        setRBTreeWeightFunc(tree, vectorSquaredNorm);
+    }
+#endif
+    if (!workload->vectors)
+    {
+        setRBTreeSizeFunc(tree, stringSize);
+    }
+
+    double startAllocations = allocationCount(), start = nowSeconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!insertToRBTree(tree, keys[i]))
+        {
+            workload->freeFunc(keys[i]);
+            keys[i] = NULL;
+        }
+    }
+    measure(&results[count++], "insert", start, startAllocations, n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (keys[i] != NULL)
+        {
+            lookups[inserted++] = keys[i];
+        }
+    }
+    for (size_t i = inserted; i > 1; --i)
+    {
+        size_t j = (size_t) rand() % i;
+        void *key = lookups[i - 1];
+        lookups[i - 1] = lookups[j];
+        lookups[j] = key;
+    }
+    startAllocations = allocationCount();
+    start = nowSeconds();
+    for (size_t i = 0; i < inserted; ++i)
+    {
+        found += RBTreeContains(tree, lookups[i]);
+    }
+    measure(&results[count++], "contains", start, startAllocations, inserted);
+
+    startAllocations = allocationCount();
+    start = nowSeconds();
+    forEachRBTree(tree, countItem, &visited);
+    measure(&results[count++], "forEach", start, startAllocations, visited);
+
+    if (workload->vectors)
+    {
+        startAllocations = allocationCount();
+        start = nowSeconds();
+        Vector *maxNorm = findMaxNormVectorInTree(tree);
+        measure(&results[count++], "findMaxNormVectorInTree", start, startAllocations, tree->size);
+        if (maxNorm != NULL)
+        {
+            freeVector(maxNorm);
+        }
+    }
+    else
+    {
+        startAllocations = allocationCount();
+        start = nowSeconds();
+        char *serialized = serializeStrings(tree, "\n");
+        measure(&results[count++], "serializeStrings", start, startAllocations, tree->size);
+        free(serialized);
+    }
+
+    // the keys are the items of the tree, each one is freed by its own delete.
+    startAllocations = allocationCount();
+    start = nowSeconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (keys[i] != NULL)
+        {
+            deleteFromRBTree(tree, keys[i]);
+        }
+    }
+    measure(&results[count++], "delete", start, startAllocations, inserted);
+
+    if (found != inserted || visited != inserted || tree->size != 0)
+    {
+        fprintf(stderr, "%s %s %zu: the tree lost items\n", workload->name, keyOrderNames[order], n);
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    for (size_t i = 0; i < count; ++i)
+    {
+        results[i].peakRssKb = usage.ru_maxrss;
+    }
+    freeRBTree(&tree);
+    free(keys);
+    free(lookups);
+    return count;
+}
+
+
+/**
+ * run runCase in a new process, so each case starts with a clean heap and has its own peak RSS.
+ * @return: the number of results, 0 on failure.
+ */
+size_t runCaseInProcess(const Workload *workload, KeyOrder order, size_t n, OperationResult *results)
+{
+    int fds[2];
+    fflush(stdout);
+    if (pipe(fds) != 0)
+    {
+        return 0;
+    }
+    pid_t child = fork();
+    if (child < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return 0;
+    }
+    if (child == 0)
+    {
+        close(fds[0]);
+        size_t count = runCase(workload, order, n, results);
+        ssize_t written = write(fds[1], results, count * sizeof(OperationResult));
+        _exit(written == (ssize_t) (count * sizeof(OperationResult)) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    close(fds[1]);
+    size_t bytes = 0;
+    ssize_t got;
+    while ((got = read(fds[0], (char *) results + bytes, MAX_CASE_RESULTS * sizeof(OperationResult) - bytes)) > 0)
+    {
+        bytes += (size_t) got;
+    }
+    close(fds[0]);
+    int status;
+    waitpid(child, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+    {
+        return 0;
+    }
+    return bytes / sizeof(OperationResult);
+}
+
+
+/**
+ * read the results of a previous run of the suite (its JSON output, one result per line).
+ * @param path: the file of the previous run.
+ * @param count: set to the number of results.
+ * @return: the results, NULL on failure.
+ */
+BaselineResult *readBaseline(const char *path, size_t *count)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    size_t capacity = 64;
+    BaselineResult *results = (BaselineResult *) malloc(capacity * sizeof(BaselineResult));
+    char line[512];
+    *count = 0;
+    while (results != NULL && fgets(line, sizeof(line), file) != NULL)
+    {
+        BaselineResult result;
+        if (sscanf(line, " {\"workload\": \"%31[^\"]\", \"order\": \"%15[^\"]\", \"items\": %zu, "
+                         "\"operation\": \"%31[^\"]\", \"nsPerOp\": %lf", result.workload, result.order,
+                   &result.items, result.operation, &result.nsPerOp) != 5)
+        {
+            continue;
+        }
+        if (*count == capacity)
+        {
+            capacity *= 2;
+            BaselineResult *larger = (BaselineResult *) realloc(results, capacity * sizeof(BaselineResult));
+            if (larger == NULL)
+            {
+                free(results);
+                results = NULL;
+                break;
+            }
+            results = larger;
+        }
+        results[(*count)++] = result;
+    }
+    fclose(file);
+    return results;
+}
+
+
+/**
+ * @return: the result of the same case and operation in the baseline, NULL if there is none.
+ */
+const BaselineResult *findBaseline(const SuiteOptions *options, const char *workload, const char *order,
+                                   size_t items, const char *operation)
+{
+    for (size_t i = 0; i < options->baselineCount; ++i)
+    {
+        const BaselineResult *result = &options->baseline[i];
+        if (result->items == items && strcmp(result->workload, workload) == 0 &&
+            strcmp(result->order, order) == 0 && strcmp(result->operation, operation) == 0)
+        {
+            return result;
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * run every workload in every key order for tree sizes 1e3, 1e4, ... up to options->maxItems, and print
+ * the results as JSON. with a baseline, each result also gets its change in percent, and slowdowns
+ * larger than options->threshold percent are reported as regressions.
+ * @return: the number of regressions.
+ */
+size_t runSuite(const SuiteOptions *options)
+{
+    const Workload workloads[] = {
+            {"short-string", makeString, SUITE_SHORT_STRING, stringCompare, freeString, SUITE_SHORT_STRING + 80,
+                    false},
+            {"long-string", makeString, SUITE_LONG_STRING, stringCompare, freeString, SUITE_LONG_STRING + 80,
+                    false},
+            {"vector-2", makeVector, 2, vectorCompare1By1, freeVector, 2 * sizeof(double) + 96, true},
+            {"vector-16", makeVector, 16, vectorCompare1By1, freeVector, 16 * sizeof(double) + 96, true},
+            {"vector-128", makeVector, 128, vectorCompare1By1, freeVector, 128 * sizeof(double) + 96, true},
+            {"contiguous-vector-128", makeContiguousVector, 128, vectorCompare1By1, freeContiguousVector,
+                    128 * sizeof(double) + 80, true},
+            {"arena-vector-128", makeArenaVector, 128, vectorCompare1By1, freeArenaVector,
+                    128 * sizeof(double) + 80, true}
+    };
+    OperationResult results[MAX_CASE_RESULTS], repeated[MAX_CASE_RESULTS];
+    size_t regressions = 0;
+    bool first = true;
+    printf("{\"benchmarks\": [");
+    for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); ++w)
+    {
+        for (KeyOrder order = RANDOM_ORDER; order <= REVERSE_ORDER; ++order)
+        {
+            for (size_t n = SUITE_MIN_ITEMS; n <= options->maxItems; n *= 10)
+            {
+                if ((double) n * (double) workloads[w].bytesPerItem > (double) options->memoryMb * 1024 * 1024)
+                {
+                    fprintf(stderr, "skipping %s %s %zu: more than %zu MB\n", workloads[w].name,
+                            keyOrderNames[order], n, options->memoryMb);
+                    continue;
+                }
+                size_t count = runCaseInProcess(&workloads[w], order, n, results);
+                for (size_t run = 1; run < options->repeat && count > 0; ++run)
+                {
+                    if (runCaseInProcess(&workloads[w], order, n, repeated) != count)
+                    {
+                        count = 0;
+                    }
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        if (repeated[i].nsPerOp < results[i].nsPerOp)
+                        {
+                            results[i] = repeated[i];
+                        }
+                    }
+                }
+                if (count == 0)
+                {
+                    fprintf(stderr, "%s %s %zu failed\n", workloads[w].name, keyOrderNames[order], n);
+                }
+                for (size_t i = 0; i < count; ++i)
+                {
+                    printf("%s\n  {\"workload\": \"%s\", \"order\": \"%s\", \"items\": %zu, \"operation\": \"%s\", "
+                           "\"nsPerOp\": %.2f, \"allocationsPerOp\": %.3f, \"peakRssKb\": %ld", first ? "" : ",",
+                           workloads[w].name, keyOrderNames[order], n, results[i].operation, results[i].nsPerOp,
+                           results[i].allocationsPerOp, results[i].peakRssKb);
+                    first = false;
+                    const BaselineResult *base = findBaseline(options, workloads[w].name, keyOrderNames[order], n,
+                                                              results[i].operation);
+                    if (base != NULL && base->nsPerOp > 0)
+                    {
+                        double change = (results[i].nsPerOp / base->nsPerOp - 1) * 100;
+                        printf(", \"baselineNsPerOp\": %.2f, \"changePercent\": %.1f", base->nsPerOp, change);
+                        if (change > options->threshold)
+                        {
+                            fprintf(stderr, "regression: %s %s %zu %s %.2f -> %.2f ns/op (%+.1f%%)\n",
+                                    workloads[w].name, keyOrderNames[order], n, results[i].operation,
+                                    base->nsPerOp, results[i].nsPerOp, change);
+                            regressions++;
+                        }
+                    }
+                    printf("}");
+                }
+            }
+        }
+    }
+    printf("\n]}\n");
+    return regressions;
+}
+
+
+/**
+ * parse the options of the suite and run it.
+ * @return: the exit status, failure if there were regressions.
+ */
+int suiteMain(int argc, char *argv[])
+{
+    SuiteOptions options = {SUITE_MAX_ITEMS, SUITE_MEMORY_MB, SUITE_REPEAT, REGRESSION_PERCENT, NULL, 0};
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--max-items") == 0)
+        {
+            options.maxItems = (size_t) strtoul(argv[i + 1], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--memory-mb") == 0)
+        {
+            options.memoryMb = (size_t) strtoul(argv[i + 1], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--repeat") == 0)
+        {
+            options.repeat = (size_t) strtoul(argv[i + 1], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--threshold") == 0)
+        {
+            options.threshold = strtod(argv[i + 1], NULL);
+        }
+        else if (strcmp(argv[i], "--baseline") == 0)
+        {
+            options.baseline = readBaseline(argv[i + 1], &options.baselineCount);
+            if (options.baseline == NULL)
+            {
+                fprintf(stderr, "cannot read the baseline %s\n", argv[i + 1]);
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    size_t regressions = runSuite(&options);
+    free(options.baseline);
+    if (regressions > 0)
+    {
+        fprintf(stderr, "%zu regressions larger than %.1f%%\n", regressions, options.threshold);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+
+/**
+ * compare contains, lower bound and ordered iteration of a live tree and of its frozen copy (see freezeRBTree).
+ * @param name: the name of the kind of items.
+ * @param items: the keys, owned by the benchmark.
+ * @param n: number of keys.
+ */
+void benchmarkFrozen(const char *name, void **items, size_t n, CompareFunc compFunc, FreeFunc freeFunc,
+                     void *(*copy)(const void *))
+{
+    RBTree *tree = newRBTree(compFunc, freeFunc);
+    if (tree == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        void *item = copy(items[i]);
+        if (!insertToRBTree(tree, item))
+        {
+            freeFunc(item);
+        }
+    }
+    double start = nowSeconds();
+    FrozenRBTree *frozen = freezeRBTree(tree);
+    double freezeSeconds = nowSeconds() - start;
+    if (frozen == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t liveFound = 0, frozenFound = 0, liveVisited = 0, frozenVisited = 0;
+    start = nowSeconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        liveFound += RBTreeContains(tree, items[i]);
+    }
+    report(name, nowSeconds() - start, n);
+    start = nowSeconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        frozenFound += FrozenRBTreeContains(frozen, items[i]);
+    }
+    report("  frozen", nowSeconds() - start, n);
+    report("  freeze (per item)", freezeSeconds, tree->size);
+
+    RBTreeIterator liveIterator;
+    FrozenIterator frozenIterator;
+    start = nowSeconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        liveVisited += RBTreeLowerBound(tree, items[i], &liveIterator);
+    }
+    report("  lower bound", nowSeconds() - start, n);
+    start = nowSeconds();
+    for (size_t i = 0; i < n; ++i)
+    {
+        frozenVisited += FrozenRBTreeLowerBound(frozen, items[i], &frozenIterator);
+    }
+    report("  frozen lower bound", nowSeconds() - start, n);
+    if (liveFound != frozenFound || liveVisited != frozenVisited)
+    {
+        fprintf(stderr, "%s: the frozen tree disagrees\n", name);
+    }
+
+    liveVisited = frozenVisited = 0;
+    start = nowSeconds();
+    forEachRBTree(tree, countItem, &liveVisited);
+    report("  forEach", nowSeconds() - start, liveVisited);
+    start = nowSeconds();
+    forEachFrozenRBTree(frozen, countItem, &frozenVisited);
+    report("  frozen forEach", nowSeconds() - start, frozenVisited);
+    freeFrozenRBTree(&frozen);
+    freeRBTree(&tree);
+}
+
+
+/**
+ * the number of calls to countingCompare.
+ */
+size_t comparisons = 0;
+
+
+/**
+ * stringCompare that counts its calls in comparisons.
+ */
+int countingCompare(const void *a, const void *b)
+{
+    comparisons++;
+    return stringCompare(a, b);
+}
+
+
+/**
+ * FreeFunc of trees that do not own their items.
+ */
+void keepItem(void *data)
+{
+    (void) data;
+}
+
+
+/**
+ * the ways benchmarkHintedInsert inserts: the plain insert (which follows the finger of sequential streams),
+ * the insert from the last inserted node, and the insert from the root.
+ */
+typedef enum InsertMethod
+{
+    PLAIN_INSERT, FINGER_INSERT, ROOT_INSERT, INSERT_METHODS
+} InsertMethod;
+
+const char *insertMethodNames[] = {"insertToRBTree", "hint = last inserted", "hint = root"};
+
+
+/**
+ * measure the inserts of sorted, reverse and nearly sorted streams of strings, by each InsertMethod.
+ * @param items: the keys, owned by the benchmark.
+ * @param n: number of keys.
+ */
+void benchmarkHintedInsert(void **items, size_t n)
+{
+    const char *streams[] = {"sorted", "reverse", "nearly sorted"};
+    void **keys = (void **) malloc((n == 0 ? 1 : n) * sizeof(void *));
+    if (keys == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int stream = 0; stream < 3; ++stream)
+    {
+        memcpy(keys, items, n * sizeof(void *));
+        orderKeys(keys, n, stringCompare, stream == 1 ? REVERSE_ORDER : SORTED_ORDER);
+        for (size_t i = 0; stream == 2 && i + 1 < n; i += 1 + (size_t) rand() % 4) // swap neighbours
+        {
+            size_t j = i + 1 + (size_t) rand() % (n - i - 1 < 8 ? n - i - 1 : 8);
+            void *key = keys[i];
+            keys[i] = keys[j];
+            keys[j] = key;
+        }
+        for (int method = 0; method < INSERT_METHODS; ++method)
+        {
+            RBTree *tree = newRBTree(countingCompare, keepItem); // the keys belong to items.
+            if (tree == NULL)
+            {
+                fprintf(stderr, "allocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+            comparisons = 0;
+            double start = nowSeconds();
+            for (size_t i = 0; i < n; ++i)
+            {
+                method == PLAIN_INSERT ? insertToRBTree(tree, keys[i]) :
+                insertToRBTreeWithHint(tree, keys[i], method == ROOT_INSERT ? tree->root : NULL);
+            }
+            double seconds = nowSeconds() - start;
+            printf("insert %-14s %-22s %10.1f ns/op %6.1f comparisons/op\n", streams[stream],
+                   insertMethodNames[method], seconds * 1e9 / (double) (n == 0 ? 1 : n),
+                   (double) comparisons / (double) (n == 0 ? 1 : n));
+            freeRBTree(&tree);
+        }
+    }
+    free(keys);
+}
+
+
+/**
+ * an item of the word count benchmark.
+ */
+typedef struct WordCount
+{
+    char word[WORD_LENGTH + 1];
+    size_t count;
+} WordCount;
+
+
+/**
+ * CompareFunc of WordCounts: by their words.
+ */
+int wordCompare(const void *a, const void *b)
+{
+    return strcmp(((const WordCount *) a)->word, ((const WordCount *) b)->word);
+}
+
+
+/**
+ * MergeFunc of WordCounts: add the count of data to existing.
+ */
+int addCount(void *existing, const void *data)
+{
+    ((WordCount *) existing)->count += ((const WordCount *) data)->count;
+    return true;
+}
+
+
+/**
+ * count n random words of WORD_LENGTH letters (with many repeats): with a search and then an insert of each new
+ * word, with RBTreeUpsert, and with RBTreeFindOrInsert (which reuses the item of a word that was found).
+ */
+void benchmarkUpsert(size_t n)
+{
+    const char *methods[] = {"search, then insert", "RBTreeUpsert", "RBTreeFindOrInsert"};
+    for (int method = 0; method < 3; ++method)
+    {
+        RBTree *tree = newRBTree(wordCompare, free);
+        WordCount *item = NULL;
+        if (tree == NULL)
+        {
+            fprintf(stderr, "allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        srand(1);
+        double startAllocations = allocationCount(), start = nowSeconds();
+        for (size_t i = 0; i < n; ++i)
+        {
+            WordCount word = {{0}, 1};
+            for (int j = 0; j < WORD_LENGTH; ++j)
+            {
+                word.word[j] = (char) ('a' + rand() % 10);
+            }
+            RBTreeIterator found;
+            if (method == 0 && RBTreeLowerBound(tree, &word, &found) &&
+                wordCompare(RBTreeIteratorData(&found), &word) == 0)
+            {
+                addCount(RBTreeIteratorData(&found), &word);
+                continue;
+            }
+            if (item == NULL && (item = (WordCount *) malloc(sizeof(WordCount))) == NULL)
+            {
+                fprintf(stderr, "allocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+            *item = word;
+            void *existing = NULL;
+            if (method == 0 ? insertToRBTree(tree, item) : method == 1 ? RBTreeUpsert(tree, item, addCount) :
+                RBTreeFindOrInsert(tree, item, &existing) && existing == item)
+            {
+                item = NULL; // the item belongs to the tree now.
+            }
+            else if (existing != NULL)
+            {
+                addCount(existing, &word);
+            }
+        }
+        double seconds = nowSeconds() - start, allocations = allocationCount() - startAllocations;
+        printf("word count, %-25s %10.1f ns/op %6.2f allocations/op (%lu words)\n", methods[method],
+               seconds * 1e9 / (double) (n == 0 ? 1 : n),
+               startAllocations < 0 ? -1 : allocations / (double) (n == 0 ? 1 : n), tree->size);
+        free(item);
+        freeRBTree(&tree);
+    }
+}
+
+
+/**
+ * ForEach function of benchmarkSetOperations: insert the item to the tree of args.
+ */
+int insertInto(const void *data, void *pTree)
+{
+    insertToRBTree((RBTree *) pTree, (void *) data);
+    return true;
+}
+
+
+/**
+ * ForEach function of benchmarkSetOperations: delete the item from the tree of args.
+ */
+int deleteFrom(const void *data, void *pTree)
+{
+    deleteFromRBTree((RBTree *) pTree, (void *) data);
+    return true;
+}
+
+
+/**
+ * build a tree of the keys of items whose index i has i % modulo < below.
+ */
+RBTree *treeOfEvery(void **items, size_t n, size_t modulo, size_t below)
+{
+    RBTree *tree = newRBTree(countingCompare, keepItem); // the keys belong to items.
+    for (size_t i = 0; tree != NULL && i < n; ++i)
+    {
+        if (i % modulo < below && !insertToRBTree(tree, items[i]))
+        {
+            freeRBTree(&tree);
+        }
+    }
+    if (tree == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return tree;
+}
+
+
+/**
+ * merge a small tree of strings into a large one (half of its items are new), and remove it from the large one
+ * again: item by item with forEachRBTree, and with unionRBTree and differenceRBTree.
+ * @param items: the keys, owned by the benchmark.
+ * @param n: number of keys.
+ */
+void benchmarkSetOperations(void **items, size_t n)
+{
+    const char *methods[] = {"forEach + insert/delete", "unionRBTree/differenceRBTree"};
+    for (int method = 0; method < 2; ++method)
+    {
+        RBTree *large = treeOfEvery(items, n, 2, 1), *small = treeOfEvery(items, n, 100, 2);
+        long unsigned smallSize = small->size, largeSize = large->size;
+        comparisons = 0;
+        double start = nowSeconds();
+        method == 0 ? forEachRBTree(small, insertInto, large) : unionRBTree(large, small);
+        double unionSeconds = nowSeconds() - start;
+        size_t unionComparisons = comparisons;
+        freeRBTree(&small);
+        small = treeOfEvery(items, n, 100, 2);
+        comparisons = 0;
+        start = nowSeconds();
+        method == 0 ? forEachRBTree(small, deleteFrom, large) : differenceRBTree(large, small);
+        double differenceSeconds = nowSeconds() - start;
+        printf("merge %lu into %lu, %-29s union %8.2f ms %9zu comparisons, difference %8.2f ms %9zu comparisons\n",
+               smallSize, largeSize, methods[method], unionSeconds * 1e3, unionComparisons,
+               differenceSeconds * 1e3, comparisons);
+        freeRBTree(&small);
+        freeRBTree(&large);
+    }
+}
+
+
+/**
+ * @return: n different keys with long common prefixes, in random order: URLs of a few sites, or the paths of the
+ * files of a source tree. the prefix of the keys of category i is put in prefixes[i] (PREFIX_CATEGORIES of them).
+ */
+void **prefixHeavyKeys(size_t n, bool urls, char prefixes[PREFIX_CATEGORIES][PREFIX_KEY_BYTES])
+{
+    void **keys = (void **) malloc(n * sizeof(void *));
+    if (keys == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < PREFIX_CATEGORIES; ++i)
+    {
+        snprintf(prefixes[i], PREFIX_KEY_BYTES, urls ? "https://www.site%lu.example.com/catalog/category-%lu/" :
+                 "/home/user/projects/library/src/module%lu/component%lu/", (long unsigned) i % 4,
+                 (long unsigned) i / 4);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        char key[PREFIX_KEY_BYTES];
+        int length = snprintf(key, sizeof(key), urls ? "%sproducts/item-%lu.html" : "%sfile%lu.c",
+                              prefixes[i % PREFIX_CATEGORIES], (long unsigned) i);
+        if ((keys[i] = malloc((size_t) length + 1)) == NULL)
+        {
+            fprintf(stderr, "allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(keys[i], key, (size_t) length + 1);
+    }
+    for (size_t i = n; i > 1; --i)
+    {
+        size_t j = ((size_t) rand() * ((size_t) RAND_MAX + 1) + (size_t) rand()) % i;
+        void *key = keys[i - 1];
+        keys[i - 1] = keys[j];
+        keys[j] = key;
+    }
+    return keys;
+}
+
+
+/**
+ * ForEach function of benchmarkRadixTree: count the keys of a prefix scan.
+ */
+int countKey(const void *data, void *pCount)
+{
+    (void) data;
+    (*(size_t *) pCount)++;
+    return true;
+}
+
+
+/**
+ * compare a RadixTree to an RBTree of strings on prefix heavy keys: the time of inserts, lookups and prefix scans
+ * (forEachWithPrefix against forEachInRange), and the memory and allocations of the nodes per key.
+ * @param n: number of keys.
+ */
+void benchmarkRadixTree(size_t n)
+{
+    const char *names[] = {"urls", "paths"};
+    for (int urls = 1; urls >= 0; --urls)
+    {
+        char prefixes[PREFIX_CATEGORIES][PREFIX_KEY_BYTES];
+        void **keys = prefixHeavyKeys(n, urls, prefixes);
+        for (int radix = 0; radix < 2; ++radix)
+        {
+            RBTree *tree = radix ? NULL : newRBTree(stringCompare, keepItem); // the keys belong to keys.
+            RadixTree *radixTree = radix ? newRadixTree(keepItem) : NULL;
+            if (tree == NULL && radixTree == NULL)
+            {
+                fprintf(stderr, "allocation failed\n");
+                exit(EXIT_FAILURE);
+            }
+            double startAllocations = allocationCount(), start = nowSeconds();
+            for (size_t i = 0; i < n; ++i)
+            {
+                radix ? insertToRadixTree(radixTree, keys[i]) : insertToRBTree(tree, keys[i]);
+            }
+            double insertSeconds = nowSeconds() - start, allocationsPerKey = (allocationCount() - startAllocations) / n;
+            size_t found = 0;
+            start = nowSeconds();
+            for (size_t i = 0; i < n; ++i)
+            {
+                found += radix ? RadixTreeContains(radixTree, keys[i]) != 0 : RBTreeContains(tree, keys[i]) != 0;
+            }
+            double containsSeconds = nowSeconds() - start;
+            size_t scanned = 0;
+            start = nowSeconds();
+            for (int q = 0; q < PREFIX_QUERIES; ++q)
+            {
+                char *prefix = prefixes[rand() % PREFIX_CATEGORIES], high[PREFIX_KEY_BYTES];
+                if (radix)
+                {
+                    forEachWithPrefix(radixTree, prefix, countKey, &scanned);
+                    continue;
+                }
+                // the keys that start with prefix are the range [prefix, prefix with its last byte + 1).
+                size_t length = strlen(prefix);
+                memcpy(high, prefix, length + 1);
+                high[length - 1]++;
+                forEachInRange(tree, prefix, high, countKey, &scanned);
+            }
+            double scanSeconds = nowSeconds() - start;
+            double bytesPerKey = radix ? (double) radixTree->nodeBytes / n : (double) sizeof(Node);
+            printf("%-5s %lu %-7s insert %7.1f ns/op, contains %7.1f ns/op, prefix scan %8.1f us (%lu keys), "
+                   "%6.1f node bytes/key, %5.2f allocations/key%s\n", names[urls], (long unsigned) n,
+                   radix ? "radix" : "RBTree", insertSeconds * 1e9 / n, containsSeconds * 1e9 / n,
+                   scanSeconds * 1e6 / PREFIX_QUERIES, (long unsigned) (scanned / PREFIX_QUERIES), bytesPerKey,
+                   allocationsPerKey, found == n ? "" : " (keys missing!)");
+            freeRadixTree(&radixTree);
+            freeRBTree(&tree);
+        }
+        freeItems(keys, n, freeString);
+    }
+}
+
+
+/**
+ * run all the benchmarks on random items.
+ */
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--suite") == 0)
+    {
+        return suiteMain(argc, argv);
+    }
+    size_t n = argc > 1 ? (size_t) strtoul(argv[1], NULL, 10) : DEFAULT_ITEMS;
+    srand(1);
+
+    void **strings = randomItems(n, makeString, STRING_LENGTH);
+    void **vectors = randomItems(n, makeVector, VECTOR_LENGTH);
+    if (strings == NULL || vectors == NULL)
+    {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+    benchmarkSpecialized("string", strings, n, stringCompare, freeString, stringTreeNew, stringTreeInsert,
+                         stringTreeContains, copyString);
+    benchmarkSpecialized("vector", vectors, n, vectorCompare1By1, freeVector, vectorTreeNew, vectorTreeInsert,
+                         vectorTreeContains, copyVector);
+    benchmarkFrozen("string frozen vs live contains", strings, n, stringCompare, freeString, copyString);
+    benchmarkFrozen("vector frozen vs live contains", vectors, n, vectorCompare1By1, freeVector, copyVector);
+    benchmarkVectorKernels();
+    benchmarkConcurrent(strings, n);
+    benchmarkPersistentSnapshot(strings, n);
+    benchmarkSharded("string", strings, n, stringCompare, freeString, stringHash, copyString);
+    benchmarkSharded("vector", vectors, n, vectorCompare1By1, freeVector, vectorHash, copyVector);
+    benchmarkMappedLoad(strings, n);
+    benchmarkLoader(strings, n, false);
+    benchmarkLoader(vectors, n, true);
+    benchmarkHintedInsert(strings, n);
+    benchmarkUpsert(n);
+    benchmarkSetOperations(strings, n);
+    benchmarkParallelForEach(n / 4);
+    benchmarkVectorIndex(n / 10);
+    benchmarkRadixTree(n);
+    freeItems(strings, n, freeString);
+    freeItems(vectors, n, freeVector);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,199 @@
+#ifndef RBTREE_RBTREEINTERNAL_H
+#define RBTREE_RBTREEINTERNAL_H
+
+#include "RBTree.h"
+
+// the building blocks of RBTree.c that do not call the CompareFunc of the tree, shared with the other
+// modules of the library. not part of the public API.
+
+#ifdef RBTREE_STATS
+// the counters are updated with relaxed atomics, since the readers of a ConcurrentRBTree search it together.
+#define STATS_ADD(tree, field, value) __atomic_fetch_add(&(tree)->stats->field, (value), __ATOMIC_RELAXED)
+#define STATS_SEARCH(tree, depth) recordSearch((tree), (depth))
+#define STATS_START() statsNow()
+#define STATS_LATENCY(tree, operation, start) recordLatency((tree), (operation), (start))
+
+/**
+ * count a search of the tree that compared data with depth nodes.
+ */
+void recordSearch(const RBTree *tree, long unsigned depth);
+
+/**
+ * @return: the time of a monotonic clock, in nanoseconds.
+ */
+long unsigned statsNow(void);
+
+/**
+ * count an operation of the tree that started at start in the latency histogram of the operation.
+ */
+void recordLatency(const RBTree *tree, RBTreeOperation operation, long unsigned start);
+#else
+#define STATS_ADD(tree, field, value) ((void) (tree))
+#define STATS_SEARCH(tree, depth) ((void) (depth))
+#define STATS_START() 0ul
+#define STATS_LATENCY(tree, operation, start) ((void) (start))
+#endif
+
+#ifdef RBTREE_COMPACT_NODE
+/**
+ * @return: the parent of node, NULL for the root.
+ */
+static inline Node *nodeParent(const Node *node)
+{
+    return (Node *) (node->parentAndColor & ~(uintptr_t) 1);
+}
+
+
+/**
+ * @return: the color of node.
+ */
+static inline Color nodeColor(const Node *node)
+{
+    return (Color) (node->parentAndColor & 1);
+}
+
+
+/**
+ * set the parent of node, keeping its color.
+ */
+static inline void setNodeParent(Node *node, Node *parent)
+{
+    node->parentAndColor = (uintptr_t) parent | (node->parentAndColor & 1);
+}
+
+
+/**
+ * set the color of node, keeping its parent.
+ */
+static inline void setNodeColor(Node *node, Color color)
+{
+    node->parentAndColor = (node->parentAndColor & ~(uintptr_t) 1) | (uintptr_t) color;
+}
+
+
+/**
+ * set the parent and the color of a new node.
+ */
+static inline void setNodeParentAndColor(Node *node, Node *parent, Color color)
+{
+    node->parentAndColor = (uintptr_t) parent | (uintptr_t) color;
+}
+#else
+static inline Node *nodeParent(const Node *node)
+{
+    return node->parent;
+}
+
+
+static inline Color nodeColor(const Node *node)
+{
+    return node->color;
+}
+
+
+static inline void setNodeParent(Node *node, Node *parent)
+{
+    node->parent = parent;
+}
+
+
+static inline void setNodeColor(Node *node, Color color)
+{
+    node->color = color;
+}
+
+
+static inline void setNodeParentAndColor(Node *node, Node *parent, Color color)
+{
+    node->parent = parent;
+    node->color = color;
+}
+#endif
+
+/**
+ * allocate a new node for data, from the pool of tree if it has one.
+ * @return: the new node, NULL on failure.
+ */
+Node *getNewNode(RBTree *tree, void *data);
+
+/**
+ * release a node that is no longer linked to tree, to the pool of tree if it has one.
+ */
+void releaseNode(RBTree *tree, Node *node);
+
+/**
+ * link a new node to the tree and fix the colors of the tree.
+ * @param parent: the parent of the new node found by findNodeLocation, NULL if the tree is empty.
+ * @param result: the result of comparing the data of parent with the data of node (not 0).
+ */
+void insertNode(RBTree *tree, Node *parent, Node *node, int result);
+
+/**
+ * insertNode, and make the new node the finger of the tree (see sequentialFinger).
+ */
+void insertNodeWithFinger(RBTree *tree, Node *parent, Node *node, int result);
+
+/**
+ * search for the place of data from hint, a node of the tree near it (finger search), like findNodeLocation.
+ * @param result: set to the result of comparing the data of the returned node with data (1 if it is NULL).
+ * @return: the node of data if it is in the tree, otherwise the parent of its place.
+ */
+Node *findNodeNear(const RBTree *tree, Node *hint, const void *data, int *result);
+
+/**
+ * @return: the node the next insert to tree starts from: the last inserted node while the inserts are
+ * sequential, NULL (the root) otherwise.
+ */
+Node *sequentialFinger(const RBTree *tree);
+
+/**
+ * fix the colors of the tree after a red node was linked (as in insertNode) under a parent that is not the root.
+ */
+void fixRedNode(RBTree *tree, Node *node);
+
+/**
+ * recompute the augmented fields of node from its children (nothing without RBTREE_AUGMENTED).
+ */
+void updateNode(Node *node);
+
+/**
+ * updateNode on node and all of its ancestors.
+ */
+void updatePathToRoot(Node *node);
+
+/**
+ * unlink node from the tree, fix the tree and release the node (but not its data).
+ */
+void deleteNode(RBTree *tree, Node *node);
+
+/**
+ * @return: the node with the smallest data in the sub tree of node, NULL if it is empty.
+ */
+Node *minimumNode(Node *node);
+
+/**
+ * @return: the node with the largest data in the sub tree of node, NULL if it is empty.
+ */
+Node *maximumNode(Node *node);
+
+/**
+ * @return: the next node in ascending order, NULL if there is none.
+ */
+Node *successorNode(Node *node);
+
+/**
+ * @return: the previous node in ascending order, NULL if there is none.
+ */
+Node *predecessorNode(Node *node);
+
+/**
+ * append the nodes of the sub tree of node to nodes, in ascending order.
+ */
+void collectNodes(Node *node, Node **nodes, size_t *count);
+
+/**
+ * @return: the number of nodes in the sub tree of node (0 without RBTREE_ORDER_STATISTICS).
+ */
+long unsigned subtreeSize(const Node *node);
+
+#endif //RBTREE_RBTREEINTERNAL_H
@@ -0,0 +1,416 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "RBTreeLoader.h"
+
+/**
+ * the items of one block, before they are added to the tree.
+ */
+typedef struct ItemBatch
+{
+    void **items;
+    size_t count, capacity;
+} ItemBatch;
+
+
+/**
+ * constructs a new empty LoadArena.
+ * @return: the new arena, NULL on failure.
+ */
+LoadArena *newLoadArena(void)
+{
+    LoadArena *arena = (LoadArena *) malloc(sizeof(LoadArena));
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+    arena->chunks = NULL;
+    arena->current = NULL;
+    arena->bytes = 0;
+    return arena;
+}
+
+
+/**
+ * allocate a new chunk and add it to the arena.
+ * @param capacity: the bytes of the chunk.
+ * @return: the new chunk, NULL on failure.
+ */
+LoadChunk *addChunk(LoadArena *arena, size_t capacity)
+{
+    LoadChunk *chunk = (LoadChunk *) malloc(sizeof(LoadChunk) + capacity);
+    if (chunk == NULL)
+    {
+        return NULL;
+    }
+    chunk->next = arena->chunks;
+    chunk->used = 0;
+    chunk->capacity = capacity;
+    arena->chunks = chunk;
+    arena->bytes += capacity;
+    return chunk;
+}
+
+
+/**
+ * grow a chunk of the arena that nothing points into yet, keeping its place in the list of chunks.
+ * @param capacity: the new bytes of the chunk.
+ * @return: the grown chunk, NULL on failure (the chunk stays in the arena as it was).
+ */
+LoadChunk *growChunk(LoadArena *arena, LoadChunk *chunk, size_t capacity)
+{
+    LoadChunk **link = &arena->chunks;
+    while (*link != chunk)
+    {
+        link = &(*link)->next;
+    }
+    LoadChunk *grown = (LoadChunk *) realloc(chunk, sizeof(LoadChunk) + capacity);
+    if (grown == NULL)
+    {
+        return NULL;
+    }
+    arena->bytes += capacity - grown->capacity;
+    grown->capacity = capacity;
+    *link = grown;
+    return grown;
+}
+
+
+/**
+ * allocate bytes from the arena, aligned for doubles. freed with the arena.
+ * @param arena: the arena to allocate from.
+ * @param bytes: the size of the allocation.
+ * @return: the memory, NULL on failure.
+ */
+void *allocateFromLoadArena(LoadArena *arena, size_t bytes)
+{
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+    bytes = (bytes + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+    LoadChunk *chunk = arena->current;
+    if (chunk == NULL || chunk->capacity - chunk->used < bytes)
+    {
+        if ((chunk = addChunk(arena, bytes > LOAD_ARENA_CHUNK_BYTES ? bytes : LOAD_ARENA_CHUNK_BYTES)) == NULL)
+        {
+            return NULL;
+        }
+        arena->current = chunk;
+    }
+    void *memory = (char *) chunk->data + chunk->used;
+    chunk->used += bytes;
+    return memory;
+}
+
+
+/**
+ * FreeFunc of trees whose items were made by a loader: nothing, the items are freed with their arena.
+ */
+void keepLoadedItem(void *data)
+{
+    (void) data;
+}
+
+
+/**
+ * read from fd until bytes were read or the file ends, retrying interrupted reads.
+ * @return: the number of bytes read (less than bytes only at the end of the file), -1 on failure.
+ */
+ssize_t readBlock(int fd, char *buffer, size_t bytes)
+{
+    size_t total = 0;
+    while (total < bytes)
+    {
+        ssize_t got = read(fd, buffer + total, bytes - total);
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got < 0)
+        {
+            return -1;
+        }
+        if (got == 0)
+        {
+            break;
+        }
+        total += (size_t) got;
+    }
+    return (ssize_t) total;
+}
+
+
+/**
+ * read the next block of a file into a chunk of the arena, after the bytes carried from the last block (the
+ * start of an item that did not end in it). when no item ended in the last chunk, the carry is all of it, and
+ * the chunk is grown (doubling) instead of copied, so an item longer than a block takes memory linear in its
+ * length.
+ * @param chunk: the chunk of the last block, NULL for none. set to the chunk of the block, which has one more
+ * byte than the bytes it holds, for a last "\0".
+ * @param carry: the bytes carried from the last block.
+ * @param carryBytes: the number of carried bytes.
+ * @param bytes: set to the bytes in the chunk: the carried bytes and then the block.
+ * @param end: set to whether the file ended.
+ * @return: false on failure, true on success.
+ */
+bool readNextBlock(int fd, LoadArena *arena, LoadChunk **chunk, const char *carry, size_t carryBytes, size_t *bytes,
+                   bool *end)
+{
+    size_t capacity = carryBytes + LOADER_BLOCK_BYTES + 1;
+    if (*chunk != NULL && carryBytes > 0 && carry == (const char *) (*chunk)->data)
+    {
+        if ((*chunk)->capacity < capacity)
+        {
+            capacity = 2 * (*chunk)->capacity > capacity ? 2 * (*chunk)->capacity : capacity;
+            if ((*chunk = growChunk(arena, *chunk, capacity)) == NULL)
+            {
+                return false;
+            }
+        }
+    }
+    else
+    {
+        if ((*chunk = addChunk(arena, capacity)) == NULL)
+        {
+            return false;
+        }
+        if (carryBytes > 0)
+        {
+            memcpy((*chunk)->data, carry, carryBytes);
+        }
+    }
+    char *block = (char *) (*chunk)->data;
+    ssize_t got = readBlock(fd, block + carryBytes, LOADER_BLOCK_BYTES);
+    if (got < 0)
+    {
+        return false;
+    }
+    *end = got < LOADER_BLOCK_BYTES;
+    *bytes = carryBytes + (size_t) got;
+    (*chunk)->used = *bytes;
+    return true;
+}
+
+
+/**
+ * add an item to the batch of the block.
+ * @return: false on failure, true on success.
+ */
+bool addToBatch(ItemBatch *batch, void *item)
+{
+    if (batch->count == batch->capacity)
+    {
+        size_t capacity = batch->capacity == 0 ? 1024 : 2 * batch->capacity;
+        void **items = (void **) realloc(batch->items, capacity * sizeof(void *));
+        if (items == NULL)
+        {
+            return false;
+        }
+        batch->items = items;
+        batch->capacity = capacity;
+    }
+    batch->items[batch->count++] = item;
+    return true;
+}
+
+
+/**
+ * cut a line in place and add it to the batch, unless it is empty.
+ * @param line: the first character of the line.
+ * @param end: the "\n" after the line, or the byte after the end of the file.
+ * @return: false on failure, true on success.
+ */
+bool addLine(ItemBatch *batch, char *line, char *end)
+{
+    if (end > line && end[-1] == '\r')
+    {
+        end--;
+    }
+    if (end == line)
+    {
+        return true;
+    }
+    *end = '\0';
+    return addToBatch(batch, line);
+}
+
+
+/**
+ * add the lines of a text file to a tree of strings, cut in place in blocks of the file read into the arena.
+ * @param tree: the tree to add the strings to, with keepLoadedItem as its FreeFunc.
+ * @param fd: the file to read from its current offset to its end.
+ * @param arena: the arena of the strings, freed after the tree.
+ * @return: 0 on failure (a read or allocation error - the lines before it may stay in the tree), other on
+ * success.
+ */
+int loadStrings(RBTree *tree, int fd, LoadArena *arena)
+{
+    if (tree == NULL || fd < 0 || arena == NULL)
+    {
+        return false;
+    }
+    ItemBatch batch = {NULL, 0, 0};
+    LoadChunk *chunk = NULL;
+    const char *carry = NULL;
+    size_t carryBytes = 0, bytes = 0;
+    bool loaded = true, end = false;
+    while (loaded && !end)
+    {
+        if (!readNextBlock(fd, arena, &chunk, carry, carryBytes, &bytes, &end))
+        {
+            loaded = false;
+            break;
+        }
+        char *line = (char *) chunk->data, *stop = line + bytes, *newline = NULL;
+        batch.count = 0;
+        while (loaded && (newline = (char *) memchr(line, '\n', (size_t) (stop - line))) != NULL)
+        {
+            loaded = addLine(&batch, line, newline);
+            line = newline + 1;
+        }
+        if (loaded && end && line < stop) // the last line has no "\n", the chunk has a byte for its "\0".
+        {
+            loaded = addLine(&batch, line, stop);
+            line = stop;
+        }
+        carry = line;
+        carryBytes = (size_t) (stop - line);
+        if (loaded)
+        {
+            loaded = insertManyToRBTree(tree, batch.items, batch.count, NULL) != RBTREE_BATCH_FAILED;
+        }
+    }
+    free(batch.items);
+    return loaded;
+}
+
+
+/**
+ * add the vectors of a binary file to a tree of Vectors, whose elements point into blocks of the file read into
+ * the arena.
+ * @param tree: the tree to add the Vectors to, with keepLoadedItem as its FreeFunc.
+ * @param fd: the file to read from its current offset to its end.
+ * @param arena: the arena of the Vectors, freed after the tree.
+ * @return: 0 on failure (a read or allocation error, or a record that is not valid - the vectors before it may
+ * stay in the tree), other on success.
+ */
+int loadVectors(RBTree *tree, int fd, LoadArena *arena)
+{
+    if (tree == NULL || fd < 0 || arena == NULL)
+    {
+        return false;
+    }
+    ItemBatch batch = {NULL, 0, 0};
+    LoadChunk *chunk = NULL;
+    const char *carry = NULL;
+    size_t carryBytes = 0, bytes = 0;
+    bool loaded = true, end = false;
+    while (loaded && !end)
+    {
+        if (!readNextBlock(fd, arena, &chunk, carry, carryBytes, &bytes, &end))
+        {
+            loaded = false;
+            break;
+        }
+        // every record is a multiple of 8 bytes long, so the records of the chunk are aligned for doubles.
+        char *block = (char *) chunk->data;
+        size_t offset = 0;
+        batch.count = 0;
+        while (loaded && bytes - offset >= sizeof(int64_t))
+        {
+            int64_t len;
+            memcpy(&len, block + offset, sizeof(int64_t));
+            if (len < 0 || len > INT_MAX)
+            {
+                loaded = false;
+                break;
+            }
+            size_t recordBytes = sizeof(int64_t) + (size_t) len * sizeof(double);
+            if (bytes - offset < recordBytes)
+            {
+                break;
+            }
+            Vector *v = (Vector *) allocateFromLoadArena(arena, sizeof(Vector));
+            if (v == NULL)
+            {
+                loaded = false;
+                break;
+            }
+            v->len = (int) len;
+            v->vector = (double *) (block + offset + sizeof(int64_t));
+            loaded = addToBatch(&batch, v);
+            offset += recordBytes;
+        }
+        carry = block + offset;
+        carryBytes = bytes - offset;
+        loaded = loaded && !(end && carryBytes > 0); // a record that the file cuts.
+        if (loaded)
+        {
+            loaded = insertManyToRBTree(tree, batch.items, batch.count, NULL) != RBTREE_BATCH_FAILED;
+        }
+    }
+    free(batch.items);
+    return loaded;
+}
+
+
+/**
+ * loadStrings from the file at path.
+ * @return: 0 on failure, other on success.
+ */
+int loadStringsFile(RBTree *tree, const char *path, LoadArena *arena)
+{
+    int fd = path == NULL ? -1 : open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    int loaded = loadStrings(tree, fd, arena);
+    close(fd);
+    return loaded;
+}
+
+
+/**
+ * loadVectors from the file at path.
+ * @return: 0 on failure, other on success.
+ */
+int loadVectorsFile(RBTree *tree, const char *path, LoadArena *arena)
+{
+    int fd = path == NULL ? -1 : open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    int loaded = loadVectors(tree, fd, arena);
+    close(fd);
+    return loaded;
+}
+
+
+/**
+ * free all the chunks of the arena at once.
+ * @param arena: pointer to the arena to free.
+ */
+void freeLoadArena(LoadArena **arena)
+{
+    if (arena == NULL || (*arena) == NULL)
+    {
+        return;
+    }
+    while ((*arena)->chunks != NULL)
+    {
+        LoadChunk *chunk = (*arena)->chunks;
+        (*arena)->chunks = chunk->next;
+        free(chunk);
+    }
+    free(*arena);
+    (*arena) = NULL;
+}
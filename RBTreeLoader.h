@@ -0,0 +1,102 @@
+#ifndef RBTREE_RBTREELOADER_H
+#define RBTREE_RBTREELOADER_H
+
+#include <stddef.h>
+#include "RBTree.h"
+#include "Structs.h"
+
+/**
+ * the loaders read their input in blocks of this many bytes.
+ */
+#define LOADER_BLOCK_BYTES (4 * 1024 * 1024)
+
+/**
+ * the bytes of each chunk of an arena that holds small allocations (the headers of loaded Vectors).
+ */
+#define LOAD_ARENA_CHUNK_BYTES (256 * 1024)
+
+/*
+ * a chunk of a LoadArena: a block of input, or small allocations one after the other.
+ */
+typedef struct LoadChunk
+{
+	struct LoadChunk *next;
+	size_t used, capacity;
+	double data[]; // capacity bytes, aligned for doubles.
+} LoadChunk;
+
+/**
+ * the memory of the items made by the loaders: the blocks of input the items are parsed from in place, and the
+ * Vector headers. the items of a loaded tree are not freed one by one - the tree uses keepLoadedItem as its
+ * FreeFunc, and the whole arena is freed at once after the tree. with a tree that has a NodePool, a load allocates
+ * only per block, not per item. not thread safe.
+ */
+typedef struct LoadArena
+{
+	LoadChunk *chunks;
+	LoadChunk *current; // the chunk of the small allocations, NULL if there is none yet.
+	size_t bytes; // the capacity of all the chunks.
+} LoadArena;
+
+/**
+ * constructs a new empty LoadArena.
+ * @return: the new arena, NULL on failure.
+ */
+LoadArena *newLoadArena(void);
+
+/**
+ * allocate bytes from the arena, aligned for doubles. freed with the arena.
+ * @return: the memory, NULL on failure.
+ */
+void *allocateFromLoadArena(LoadArena *arena, size_t bytes);
+
+/**
+ * FreeFunc of trees whose items were made by a loader: nothing, the items are freed with their arena.
+ */
+void keepLoadedItem(void *data);
+
+/**
+ * add the lines of a text file to a tree of strings (see stringCompare). the file is read in blocks straight
+ * into the arena, and each line is cut in place (its "\n", or "\r\n", is replaced by "\0"), so no line is
+ * copied or allocated on its own. each block is added with insertManyToRBTree. empty lines are skipped.
+ * @param tree: the tree to add the strings to, with keepLoadedItem as its FreeFunc.
+ * @param fd: the file to read from its current offset to its end.
+ * @param arena: the arena of the strings, freed after the tree.
+ * @return: 0 on failure (a read or allocation error - the lines before it may stay in the tree), other on
+ * success.
+ */
+int loadStrings(RBTree *tree, int fd, LoadArena *arena);
+
+/**
+ * add the vectors of a binary file to a tree of Vectors (see vectorCompare1By1). the file holds records of a
+ * vector each: its length as an int64_t followed by its elements, in the byte order of the machine (like the
+ * items of a snapshot of MappedRBTree). the file is read in blocks straight into the arena, and the elements of
+ * each Vector point into the block. each block is added with insertManyToRBTree.
+ * @param tree: the tree to add the Vectors to, with keepLoadedItem as its FreeFunc.
+ * @param fd: the file to read from its current offset to its end.
+ * @param arena: the arena of the Vectors, freed after the tree.
+ * @return: 0 on failure (a read or allocation error, or a record that is not valid - the vectors before it may
+ * stay in the tree), other on success.
+ */
+int loadVectors(RBTree *tree, int fd, LoadArena *arena);
+
+/**
+ * loadStrings from the file at path.
+ * @return: 0 on failure, other on success.
+ */
+int loadStringsFile(RBTree *tree, const char *path, LoadArena *arena);
+
+/**
+ * loadVectors from the file at path.
+ * @return: 0 on failure, other on success.
+ */
+int loadVectorsFile(RBTree *tree, const char *path, LoadArena *arena);
+
+/**
+ * free all the chunks of the arena at once. all the items allocated from it become invalid, so the trees that
+ * hold them must be freed before.
+ * @param arena: pointer to the arena to free.
+ */
+void freeLoadArena(LoadArena **arena);
+
+#endif //RBTREE_RBTREELOADER_H
@@ -0,0 +1,644 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include "RBTreeSetOps.h"
+#include "RBTreeInternal.h"
+
+/**
+ * a red black sub tree that is not linked to a tree (its root may be red), and its black height: the number of
+ * black nodes on each path from its root down to a NULL.
+ */
+typedef struct Subtree
+{
+    Node *root;
+    int blackHeight;
+} Subtree;
+
+
+/**
+ * @return: the empty sub tree.
+ */
+Subtree emptySubtree(void)
+{
+    Subtree subtree = {NULL, 0};
+    return subtree;
+}
+
+
+/**
+ * @return: the content of tree as a sub tree, its black height found on the leftmost path in O(log n).
+ */
+Subtree wholeTree(const RBTree *tree)
+{
+    Subtree subtree = {tree->root, 0};
+    for (const Node *node = tree->root; node != NULL; node = node->left)
+    {
+        subtree.blackHeight += nodeColor(node) == BLACK;
+    }
+    return subtree;
+}
+
+
+/**
+ * set the children of node, and node as their parent.
+ */
+void linkChildren(Node *node, Node *left, Node *right)
+{
+    node->left = left;
+    node->right = right;
+    if (left != NULL)
+    {
+        setNodeParent(left, node);
+    }
+    if (right != NULL)
+    {
+        setNodeParent(right, node);
+    }
+}
+
+
+/**
+ * unlink the root of a non empty sub tree from its children, which become sub trees of their own.
+ * @param subtree: the sub tree, its root is left alone.
+ * @param left: set to the left sub tree of the root.
+ * @param right: set to the right sub tree of the root.
+ */
+void detachChildren(Subtree subtree, Subtree *left, Subtree *right)
+{
+    Node *node = subtree.root;
+    int blackHeight = subtree.blackHeight - (nodeColor(node) == BLACK);
+    left->root = node->left;
+    left->blackHeight = blackHeight;
+    right->root = node->right;
+    right->blackHeight = blackHeight;
+    if (node->left != NULL)
+    {
+        setNodeParent(node->left, NULL);
+    }
+    if (node->right != NULL)
+    {
+        setNodeParent(node->right, NULL);
+    }
+    node->left = NULL;
+    node->right = NULL;
+}
+
+
+/**
+ * color the root of a sub tree black, so that it has no red root (which makes its black height larger).
+ */
+void blackenRoot(Subtree *subtree)
+{
+    if (subtree->root != NULL && nodeColor(subtree->root) == RED)
+    {
+        setNodeColor(subtree->root, BLACK);
+        subtree->blackHeight++;
+    }
+}
+
+
+/**
+ * join two sub trees of different black heights and a node between them, by linking the node to the spine of
+ * the taller one, in the place of the first black node of the black height of the shorter one. takes
+ * O(difference of the black heights), and O(log n) with RBTREE_AUGMENTED (to update the spine).
+ * @param tree: the tree of the nodes (the nodes are allocated like its nodes, its stats count the rotations).
+ * @param tall: the taller sub tree, with a black root.
+ * @param node: the node between the two sub trees.
+ * @param shorter: the shorter sub tree, with a black root.
+ * @param right: whether the shorter sub tree holds the larger items (it is linked to the right spine).
+ * @return: the joined sub tree.
+ */
+Subtree joinToSpine(const RBTree *tree, Subtree tall, Node *node, Subtree shorter, bool right)
+{
+    Node *parent = NULL, *child = tall.root;
+    int blackHeight = tall.blackHeight;
+    while (child != NULL && (nodeColor(child) == RED || blackHeight != shorter.blackHeight))
+    {
+        blackHeight -= nodeColor(child) == BLACK;
+        parent = child;
+        child = right ? child->right : child->left;
+    }
+    // parent is not NULL since the root of tall is black and taller than shorter.
+    setNodeParentAndColor(node, parent, RED);
+    right ? linkChildren(node, child, shorter.root) : linkChildren(node, shorter.root, child);
+    right ? (parent->right = node) : (parent->left = node);
+    updateNode(node);
+#ifdef RBTREE_AUGMENTED
+    updatePathToRoot(parent);
+#endif
+    Node *root = tall.root;
+    bool redChildren = root->left != NULL && root->right != NULL && nodeColor(root->left) == RED &&
+                       nodeColor(root->right) == RED;
+    RBTree joined = *tree;
+    joined.root = root;
+    fixRedNode(&joined, node);
+    // the sub tree grows only when the recoloring reaches the root, whose red children become black.
+    Subtree subtree = {joined.root, tall.blackHeight};
+    subtree.blackHeight += joined.root == root && redChildren && nodeColor(root->left) == BLACK;
+    return subtree;
+}
+
+
+/**
+ * join two sub trees and a node between them: every item of left is smaller than the item of node, which is
+ * smaller than every item of right. takes O(difference of the black heights + 1).
+ * @param tree: the tree of the nodes.
+ * @param left: the sub tree of the smaller items.
+ * @param node: a node that is not linked to anything.
+ * @param right: the sub tree of the larger items.
+ * @return: the joined sub tree.
+ */
+Subtree joinSubtrees(const RBTree *tree, Subtree left, Node *node, Subtree right)
+{
+    blackenRoot(&left);
+    blackenRoot(&right);
+    if (left.blackHeight > right.blackHeight)
+    {
+        return joinToSpine(tree, left, node, right, true);
+    }
+    if (left.blackHeight < right.blackHeight)
+    {
+        return joinToSpine(tree, right, node, left, false);
+    }
+    setNodeParentAndColor(node, NULL, BLACK);
+    linkChildren(node, left.root, right.root);
+    updateNode(node);
+    Subtree subtree = {node, left.blackHeight + 1};
+    return subtree;
+}
+
+
+/**
+ * split a sub tree by a key, in O(log n): the join of the sub trees on each side of the path to the key.
+ * @param tree: the tree of the nodes, with the CompareFunc.
+ * @param subtree: the sub tree to split.
+ * @param key: the key to split by.
+ * @param lo: set to the sub tree of the items smaller than key.
+ * @param hi: set to the sub tree of the items larger than key.
+ * @return: the node of the item equal to key, not linked to anything. NULL if there is no such item.
+ */
+Node *splitSubtree(const RBTree *tree, Subtree subtree, const void *key, Subtree *lo, Subtree *hi)
+{
+    if (subtree.root == NULL)
+    {
+        *lo = emptySubtree();
+        *hi = emptySubtree();
+        return NULL;
+    }
+    Node *node = subtree.root, *found = NULL;
+    Subtree left, right;
+    detachChildren(subtree, &left, &right);
+    int result = tree->compFunc(node->data, key);
+    if (result == 0)
+    {
+        *lo = left;
+        *hi = right;
+        return node;
+    }
+    if (result > 0)
+    {
+        found = splitSubtree(tree, left, key, lo, hi);
+        *hi = joinSubtrees(tree, *hi, node, right);
+    }
+    else
+    {
+        found = splitSubtree(tree, right, key, lo, hi);
+        *lo = joinSubtrees(tree, left, node, *lo);
+    }
+    return found;
+}
+
+
+/**
+ * remove the largest node of a non empty sub tree, in O(log n).
+ * @param rest: set to the sub tree of the other nodes.
+ * @return: the largest node, not linked to anything.
+ */
+Node *splitLast(const RBTree *tree, Subtree subtree, Subtree *rest)
+{
+    Node *node = subtree.root;
+    Subtree left, right;
+    detachChildren(subtree, &left, &right);
+    if (right.root == NULL)
+    {
+        *rest = left;
+        return node;
+    }
+    Node *last = splitLast(tree, right, rest);
+    *rest = joinSubtrees(tree, left, node, *rest);
+    return last;
+}
+
+
+/**
+ * join two sub trees without a node between them, in O(log n).
+ * @return: the joined sub tree.
+ */
+Subtree concatSubtrees(const RBTree *tree, Subtree left, Subtree right)
+{
+    if (left.root == NULL || right.root == NULL)
+    {
+        return left.root == NULL ? right : left;
+    }
+    Subtree rest;
+    Node *last = splitLast(tree, left, &rest);
+    return joinSubtrees(tree, rest, last, right);
+}
+
+
+/**
+ * release a node that is not linked to anything, and free its data with the FreeFunc of tree.
+ */
+void dropNode(RBTree *tree, Node *node)
+{
+    void *data = node->data;
+    releaseNode(tree, node);
+    if (tree->freeFunc != NULL)
+    {
+        tree->freeFunc(data);
+    }
+}
+
+
+/**
+ * release all the nodes of a sub tree and free their data.
+ */
+void dropSubtree(RBTree *tree, Node *node)
+{
+    if (node == NULL)
+    {
+        return;
+    }
+    dropSubtree(tree, node->left);
+    dropSubtree(tree, node->right);
+    dropNode(tree, node);
+}
+
+
+/**
+ * union of two sub trees: split a by the root of b, and join the unions of the two sides.
+ * @param tree: the tree of the nodes of a.
+ * @param other: the tree of the nodes of b, whose nodes of duplicate items are dropped.
+ * @param duplicates: incremented for each dropped item.
+ * @return: the union.
+ */
+Subtree unionSubtrees(RBTree *tree, RBTree *other, Subtree a, Subtree b, long unsigned *duplicates)
+{
+    if (a.root == NULL || b.root == NULL)
+    {
+        return a.root == NULL ? b : a;
+    }
+    Node *node = b.root;
+    Subtree aLeft, aRight, bLeft, bRight;
+    detachChildren(b, &bLeft, &bRight);
+    Node *found = splitSubtree(tree, a, node->data, &aLeft, &aRight);
+    Subtree left = unionSubtrees(tree, other, aLeft, bLeft, duplicates);
+    Subtree right = unionSubtrees(tree, other, aRight, bRight, duplicates);
+    if (found != NULL)
+    {
+        dropNode(other, node);
+        (*duplicates)++;
+        node = found;
+    }
+    return joinSubtrees(tree, left, node, right);
+}
+
+
+/**
+ * intersection of a sub tree with the sub tree of a node of another tree, which is only read: split a by the
+ * node, and join the intersections of the two sides.
+ * @param tree: the tree of the nodes of a, whose items that are not kept are dropped.
+ * @param kept: incremented for each kept item.
+ * @return: the intersection.
+ */
+Subtree intersectSubtrees(RBTree *tree, Subtree a, const Node *node, long unsigned *kept)
+{
+    if (a.root == NULL || node == NULL)
+    {
+        dropSubtree(tree, a.root);
+        return emptySubtree();
+    }
+    Subtree aLeft, aRight;
+    Node *found = splitSubtree(tree, a, node->data, &aLeft, &aRight);
+    Subtree left = intersectSubtrees(tree, aLeft, node->left, kept);
+    Subtree right = intersectSubtrees(tree, aRight, node->right, kept);
+    if (found == NULL)
+    {
+        return concatSubtrees(tree, left, right);
+    }
+    (*kept)++;
+    return joinSubtrees(tree, left, found, right);
+}
+
+
+/**
+ * difference of a sub tree and the sub tree of a node of another tree, which is only read: split a by the node,
+ * drop the item equal to it, and concatenate the differences of the two sides.
+ * @param tree: the tree of the nodes of a, whose removed items are dropped.
+ * @param removed: incremented for each dropped item.
+ * @return: the difference.
+ */
+Subtree differenceSubtrees(RBTree *tree, Subtree a, const Node *node, long unsigned *removed)
+{
+    if (a.root == NULL || node == NULL)
+    {
+        return a;
+    }
+    Subtree aLeft, aRight;
+    Node *found = splitSubtree(tree, a, node->data, &aLeft, &aRight);
+    if (found != NULL)
+    {
+        dropNode(tree, found);
+        (*removed)++;
+    }
+    Subtree left = differenceSubtrees(tree, aLeft, node->left, removed);
+    Subtree right = differenceSubtrees(tree, aRight, node->right, removed);
+    return concatSubtrees(tree, left, right);
+}
+
+
+/**
+ * set a sub tree as the content of tree.
+ * @param size: the number of items in the sub tree.
+ */
+void setSubtree(RBTree *tree, Subtree subtree, long unsigned size)
+{
+    tree->root = subtree.root;
+    if (tree->root != NULL)
+    {
+        setNodeColor(tree->root, BLACK);
+    }
+    tree->size = size;
+    tree->sequential = false;
+}
+
+
+/**
+ * leave a tree whose nodes were all moved away empty.
+ */
+void clearTree(RBTree *tree)
+{
+    tree->root = NULL;
+    tree->size = 0;
+    tree->dataBytes = 0;
+    tree->finger = NULL;
+    tree->sequential = false;
+}
+
+
+/**
+ * check whether the nodes of other can be linked into tree as they are: both trees allocate their nodes with
+ * malloc, and track the sizes and the weights of their items with the same functions.
+ */
+bool compatibleNodes(const RBTree *tree, const RBTree *other)
+{
+    bool compatible = tree->pool == NULL && other->pool == NULL && tree->sizeFunc == other->sizeFunc;
+#ifdef RBTREE_MAX_WEIGHT
+    compatible = compatible && tree->weightFunc == other->weightFunc;
+#endif
+    return compatible;
+}
+
+
+/**
+ * move the items of other to new nodes that are allocated like the nodes of tree, in O(m).
+ * @param adopted: set to a tree like tree (with the FreeFunc of other) that holds the new nodes.
+ * @return: false on failure (other is not changed), true on success (other is left empty).
+ */
+bool adoptItems(const RBTree *tree, RBTree *other, RBTree *adopted)
+{
+    *adopted = *tree;
+    clearTree(adopted);
+    adopted->freeFunc = other->freeFunc;
+    size_t n = other->size, count = 0;
+    Node **nodes = (Node **) malloc((n == 0 ? 1 : n) * sizeof(Node *));
+    void **items = (void **) malloc((n == 0 ? 1 : n) * sizeof(void *));
+    if (nodes == NULL || items == NULL)
+    {
+        free(nodes);
+        free(items);
+        return false;
+    }
+    collectNodes(other->root, nodes, &count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        items[i] = nodes[i]->data;
+    }
+    bool built = buildRBTreeFromSorted(adopted, items, count);
+    for (size_t i = 0; built && i < count; ++i)
+    {
+        releaseNode(other, nodes[i]);
+    }
+    if (built)
+    {
+        clearTree(other);
+    }
+    free(nodes);
+    free(items);
+    return built;
+}
+
+
+/**
+ * the tree whose nodes hold the items of other in an operation with tree: other itself if its nodes are
+ * compatible with the nodes of tree, otherwise adopted, filled by adoptItems.
+ * @return: the tree of the nodes, NULL on failure.
+ */
+RBTree *nodesFor(const RBTree *tree, RBTree *other, RBTree *adopted)
+{
+    if (compatibleNodes(tree, other))
+    {
+        return other;
+    }
+    return adoptItems(tree, other, adopted) ? adopted : NULL;
+}
+
+
+/**
+ * move all the items of right to the end of tree, in O(log n). every item of right must be larger than every
+ * item of tree.
+ * @param tree: the tree to add the items to.
+ * @param right: the tree of the larger items. it is left empty (and still has to be freed).
+ * @return: 0 on failure (the items are not in order - nothing is moved), other on success.
+ */
+int joinRBTree(RBTree *tree, RBTree *right)
+{
+    if (tree == NULL || right == NULL || tree == right || tree->compFunc != right->compFunc)
+    {
+        return false;
+    }
+    if (right->root == NULL)
+    {
+        return true;
+    }
+    if (tree->root != NULL &&
+        tree->compFunc(maximumNode(tree->root)->data, minimumNode(right->root)->data) >= 0)
+    {
+        return false;
+    }
+    RBTree adopted;
+    RBTree *nodes = nodesFor(tree, right, &adopted);
+    if (nodes == NULL)
+    {
+        return false;
+    }
+    setSubtree(tree, concatSubtrees(tree, wholeTree(tree), wholeTree(nodes)), tree->size + nodes->size);
+    tree->dataBytes += nodes->dataBytes;
+    clearTree(nodes);
+    return true;
+}
+
+
+/**
+ * set the sizes of the two trees made by a split of a tree. the smaller one is counted, in O(min(k, n - k))
+ * (in O(1) with RBTREE_ORDER_STATISTICS when the sizes of the items are not tracked).
+ * @param tree: the tree that was split.
+ */
+void setSplitSizes(const RBTree *tree, RBTree *low, RBTree *high)
+{
+#ifdef RBTREE_ORDER_STATISTICS
+    if (tree->sizeFunc == NULL)
+    {
+        low->size = subtreeSize(low->root);
+        high->size = subtreeSize(high->root);
+        return;
+    }
+#endif
+    long unsigned count = 0;
+    size_t lowBytes = 0, highBytes = 0;
+    Node *lowNode = minimumNode(low->root), *highNode = minimumNode(high->root);
+    for (; lowNode != NULL && highNode != NULL; lowNode = successorNode(lowNode), highNode = successorNode(highNode))
+    {
+        count++;
+        if (tree->sizeFunc != NULL)
+        {
+            lowBytes += tree->sizeFunc(lowNode->data);
+            highBytes += tree->sizeFunc(highNode->data);
+        }
+    }
+    low->size = lowNode == NULL ? count : tree->size - count;
+    high->size = tree->size - low->size;
+    low->dataBytes = lowNode == NULL ? lowBytes : tree->dataBytes - highBytes;
+    high->dataBytes = tree->dataBytes - low->dataBytes;
+}
+
+
+/**
+ * split a tree in two by a key, in O(log n).
+ * @param tree: the tree to split. it is left empty (and still has to be freed).
+ * @param key: the items smaller than key go to lo, the others (including the item equal to key) to hi.
+ * @param lo: set to a new tree of the smaller items, with the functions of tree (but not its NodePool).
+ * @param hi: set to a new tree of the other items, like lo.
+ * @return: 0 on failure (tree is not changed), other on success.
+ */
+int splitRBTree(RBTree *tree, const void *key, RBTree **lo, RBTree **hi)
+{
+    if (tree == NULL || key == NULL || lo == NULL || hi == NULL)
+    {
+        return false;
+    }
+    RBTree *low = newRBTree(tree->compFunc, tree->freeFunc), *high = newRBTree(tree->compFunc, tree->freeFunc);
+    if (low == NULL || high == NULL)
+    {
+        freeRBTree(&low);
+        freeRBTree(&high);
+        return false;
+    }
+    low->sizeFunc = high->sizeFunc = tree->sizeFunc;
+#ifdef RBTREE_MAX_WEIGHT
+    low->weightFunc = high->weightFunc = tree->weightFunc;
+#endif
+    RBTree adopted;
+    RBTree *nodes = nodesFor(low, tree, &adopted);
+    if (nodes == NULL)
+    {
+        freeRBTree(&low);
+        freeRBTree(&high);
+        return false;
+    }
+    Subtree lowSubtree, highSubtree;
+    Node *found = splitSubtree(nodes, wholeTree(nodes), key, &lowSubtree, &highSubtree);
+    if (found != NULL)
+    {
+        highSubtree = joinSubtrees(nodes, emptySubtree(), found, highSubtree);
+    }
+    setSubtree(low, lowSubtree, 0);
+    setSubtree(high, highSubtree, 0);
+    setSplitSizes(nodes, low, high);
+    clearTree(nodes);
+    clearTree(tree);
+    *lo = low;
+    *hi = high;
+    return true;
+}
+
+
+/**
+ * move all the items of other into tree. an item of other that is equal to an item of tree is freed with the
+ * FreeFunc of other, and the item of tree is kept. the moved items are freed with the FreeFunc of tree later.
+ * @param tree: the tree to add the items to.
+ * @param other: the tree to take the items from. it is left empty (and still has to be freed).
+ * @return: 0 on failure (nothing is moved), other on success.
+ */
+int unionRBTree(RBTree *tree, RBTree *other)
+{
+    if (tree == NULL || other == NULL || tree == other || tree->compFunc != other->compFunc)
+    {
+        return false;
+    }
+    RBTree adopted;
+    RBTree *nodes = nodesFor(tree, other, &adopted);
+    if (nodes == NULL)
+    {
+        return false;
+    }
+    long unsigned duplicates = 0, size = tree->size + nodes->size;
+    // the duplicates are dropped from nodes, so its dataBytes counts only the moved items at the end.
+    Subtree subtree = unionSubtrees(tree, nodes, wholeTree(tree), wholeTree(nodes), &duplicates);
+    setSubtree(tree, subtree, size - duplicates);
+    tree->dataBytes += nodes->dataBytes;
+    clearTree(nodes);
+    clearTree(other);
+    return true;
+}
+
+
+/**
+ * remove from tree the items that are not equal to an item of other, and free them with the FreeFunc of tree.
+ * @param tree: the tree to remove the items from.
+ * @param other: the tree of the items to keep, not changed.
+ * @return: 0 on failure, other on success.
+ */
+int intersectRBTree(RBTree *tree, const RBTree *other)
+{
+    if (tree == NULL || other == NULL || tree->compFunc != other->compFunc)
+    {
+        return false;
+    }
+    if (tree == other)
+    {
+        return true;
+    }
+    long unsigned kept = 0;
+    Subtree subtree = intersectSubtrees(tree, wholeTree(tree), other->root, &kept);
+    setSubtree(tree, subtree, kept);
+    return true;
+}
+
+
+/**
+ * remove from tree the items that are equal to an item of other, and free them with the FreeFunc of tree.
+ * @param tree: the tree to remove the items from.
+ * @param other: the tree of the items to remove, not changed.
+ * @return: 0 on failure, other on success.
+ */
+int differenceRBTree(RBTree *tree, const RBTree *other)
+{
+    if (tree == NULL || other == NULL || tree == other || tree->compFunc != other->compFunc)
+    {
+        return false;
+    }
+    long unsigned removed = 0;
+    Subtree subtree = differenceSubtrees(tree, wholeTree(tree), other->root, &removed);
+    setSubtree(tree, subtree, tree->size - removed);
+    return true;
+}
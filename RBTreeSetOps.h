@@ -0,0 +1,58 @@
+#ifndef RBTREE_RBTREESETOPS_H
+#define RBTREE_RBTREESETOPS_H
+
+#include "RBTree.h"
+
+// operations on whole trees by their black heights: two trees are joined in O(log n) by linking the shorter
+// one at the height where it fits into the taller one, and a tree is split in O(log n) by joining the sub trees
+// on the two sides of the path to a key. the set operations are built on them, and go over the smaller tree
+// while splitting the larger one, so they take O(m log(n / m + 1)) comparisons for trees of m <= n items.
+// the nodes are relinked, not allocated - except for trees that use a NodePool (or that track the sizes or the
+// weights of their items with different functions), whose items are first moved to nodes of the other tree in
+// O(m). the trees must have the same CompareFunc.
+
+/**
+ * move all the items of right to the end of tree, in O(log n). every item of right must be larger than every
+ * item of tree.
+ * @param tree: the tree to add the items to.
+ * @param right: the tree of the larger items. it is left empty (and still has to be freed).
+ * @return: 0 on failure (the items are not in order - nothing is moved), other on success.
+ */
+int joinRBTree(RBTree *tree, RBTree *right);
+
+/**
+ * split a tree in two by a key, in O(log n).
+ * @param tree: the tree to split. it is left empty (and still has to be freed).
+ * @param key: the items smaller than key go to lo, the others (including the item equal to key) to hi.
+ * @param lo: set to a new tree of the smaller items, with the functions of tree (but not its NodePool).
+ * @param hi: set to a new tree of the other items, like lo.
+ * @return: 0 on failure (tree is not changed), other on success.
+ */
+int splitRBTree(RBTree *tree, const void *key, RBTree **lo, RBTree **hi);
+
+/**
+ * move all the items of other into tree. an item of other that is equal to an item of tree is freed with the
+ * FreeFunc of other, and the item of tree is kept. the moved items are freed with the FreeFunc of tree later.
+ * @param tree: the tree to add the items to.
+ * @param other: the tree to take the items from. it is left empty (and still has to be freed).
+ * @return: 0 on failure (nothing is moved), other on success.
+ */
+int unionRBTree(RBTree *tree, RBTree *other);
+
+/**
+ * remove from tree the items that are not equal to an item of other, and free them with the FreeFunc of tree.
+ * @param tree: the tree to remove the items from.
+ * @param other: the tree of the items to keep, not changed.
+ * @return: 0 on failure, other on success.
+ */
+int intersectRBTree(RBTree *tree, const RBTree *other);
+
+/**
+ * remove from tree the items that are equal to an item of other, and free them with the FreeFunc of tree.
+ * @param tree: the tree to remove the items from.
+ * @param other: the tree of the items to remove, not changed.
+ * @return: 0 on failure, other on success.
+ */
+int differenceRBTree(RBTree *tree, const RBTree *other);
+
+#endif //RBTREE_RBTREESETOPS_H
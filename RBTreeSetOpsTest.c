@@ -0,0 +1,386 @@
+/**
+ * a randomized test of RBTreeSetOps: random joins, splits, unions, intersections and differences of trees of int
+ * keys are checked against reference sets, and after each of them every tree is checked for the red-black
+ * invariants (black root, no red node with a red child, the same number of black nodes on every path, consistent
+ * parent links, keys in order), its size, its dataBytes and the augmented fields of the layout flags. the trees
+ * mix malloc'ed nodes and NodePools, and different SizeFuncs (and WeightFuncs), so both the relinking and the
+ * adopting paths run.
+ * build and run:
+ *     gcc -std=c99 RBTreeSetOpsTest.c RBTreeSetOps.c RBTree-2.c NodePool.c -o RBTreeSetOpsTest && ./RBTreeSetOpsTest
+ * build it with -DRBTREE_ORDER_STATISTICS, -DRBTREE_MAX_WEIGHT, -DRBTREE_COMPACT_NODE or -DRBTREE_STATS to test
+ * those layouts. it exits with failure at the first broken invariant.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "RBTree.h"
+#include "NodePool.h"
+#include "RBTreeSetOps.h"
+#include "RBTreeInternal.h"
+
+#define KEY_RANGE 256
+#define STEPS 4000
+#define TEST_NODES_PER_SLAB 16
+
+/**
+ * a tree under test and the keys it should hold.
+ */
+typedef struct TestTree
+{
+    RBTree *tree;
+    bool present[KEY_RANGE];
+} TestTree;
+
+
+/**
+ * CompareFunc of int keys.
+ */
+int intCompare(const void *a, const void *b)
+{
+    int x = *(const int *) a, y = *(const int *) b;
+    return (x > y) - (x < y);
+}
+
+
+/**
+ * SizeFunc of the same size for every key.
+ */
+size_t intSize(const void *data)
+{
+    (void) data;
+    return sizeof(int);
+}
+
+
+/**
+ * SizeFunc of a different size for each key.
+ */
+size_t keySize(const void *data)
+{
+    return 1 + (size_t) (*(const int *) data % 7);
+}
+
+
+#ifdef RBTREE_MAX_WEIGHT
+/**
+ * WeightFunc that is not monotonic in the key, with ties.
+ */
+long double keyWeight(const void *data)
+{
+    return (long double) (*(const int *) data * 37 % 101);
+}
+#endif
+
+
+/**
+ * report a broken invariant and stop the test.
+ */
+void fail(const char *what, int step)
+{
+    fprintf(stderr, "step %d: %s\n", step, what);
+    exit(EXIT_FAILURE);
+}
+
+
+/**
+ * check the sub tree of node against the keys it should hold, and count its nodes.
+ * @param low: the key all the keys of the sub tree are greater than, NULL for none.
+ * @param high: the key all the keys of the sub tree are smaller than, NULL for none.
+ * @param count: incremented by the number of nodes of the sub tree.
+ * @return: the number of black nodes on each path from node down to a leaf.
+ */
+int checkSubtree(const RBTree *tree, const Node *node, const bool *present, const int *low, const int *high,
+                 long unsigned *count, int step)
+{
+    if (node == NULL)
+    {
+        return 1;
+    }
+    const int *key = (const int *) node->data;
+    if ((low != NULL && *key <= *low) || (high != NULL && *key >= *high))
+    {
+        fail("keys out of order", step);
+    }
+    if (*key < 0 || *key >= KEY_RANGE || !present[*key])
+    {
+        fail("a key that is not in the reference", step);
+    }
+    if ((node->left != NULL && nodeParent(node->left) != node) ||
+        (node->right != NULL && nodeParent(node->right) != node))
+    {
+        fail("a child does not point at its parent", step);
+    }
+    if (nodeColor(node) == RED && ((node->left != NULL && nodeColor(node->left) == RED) ||
+                                   (node->right != NULL && nodeColor(node->right) == RED)))
+    {
+        fail("a red node has a red child", step);
+    }
+    (*count)++;
+    int leftBlack = checkSubtree(tree, node->left, present, low, key, count, step);
+    int rightBlack = checkSubtree(tree, node->right, present, key, high, count, step);
+    if (leftBlack != rightBlack)
+    {
+        fail("paths with different numbers of black nodes", step);
+    }
+#ifdef RBTREE_ORDER_STATISTICS
+    if (node->subtreeSize != subtreeSize(node->left) + subtreeSize(node->right) + 1)
+    {
+        fail("wrong sub tree size", step);
+    }
+#endif
+#ifdef RBTREE_MAX_WEIGHT
+    long double weight = tree->weightFunc == NULL ? 0 : tree->weightFunc(node->data), heaviest = node->weight;
+    heaviest = node->left != NULL && node->left->maxWeightNode->weight > heaviest ?
+               node->left->maxWeightNode->weight : heaviest;
+    heaviest = node->right != NULL && node->right->maxWeightNode->weight > heaviest ?
+               node->right->maxWeightNode->weight : heaviest;
+    if (node->weight != weight || node->maxWeightNode == NULL || node->maxWeightNode->weight != heaviest)
+    {
+        fail("wrong weight or heaviest node of a sub tree", step);
+    }
+#else
+    (void) tree;
+#endif
+    return leftBlack + (nodeColor(node) == BLACK);
+}
+
+
+/**
+ * check all the invariants of a tree, and that it holds exactly the keys of its reference.
+ */
+void checkTree(const TestTree *test, int step)
+{
+    const RBTree *tree = test->tree;
+    if (tree->root != NULL && (nodeColor(tree->root) != BLACK || nodeParent(tree->root) != NULL))
+    {
+        fail("the root is red or has a parent", step);
+    }
+    long unsigned count = 0, expected = 0;
+    size_t bytes = 0;
+    checkSubtree(tree, tree->root, test->present, NULL, NULL, &count, step);
+    for (int key = 0; key < KEY_RANGE; ++key)
+    {
+        expected += test->present[key];
+        bytes += test->present[key] && tree->sizeFunc != NULL ? tree->sizeFunc(&key) : 0;
+    }
+    if (count != tree->size || count != expected)
+    {
+        fail("the size does not match the reference", step);
+    }
+    if (tree->dataBytes != bytes)
+    {
+        fail("dataBytes does not match the reference", step);
+    }
+}
+
+
+/**
+ * @return: a new key, stops the test on failure.
+ */
+int *newKey(int key, int step)
+{
+    int *data = (int *) malloc(sizeof(int));
+    if (data == NULL)
+    {
+        fail("allocation failed", step);
+    }
+    *data = key;
+    return data;
+}
+
+
+/**
+ * make an empty tree with malloc'ed nodes or a NodePool, and a random SizeFunc (and WeightFunc).
+ */
+void newTestTree(TestTree *test, int step)
+{
+    int variant = rand() % 6;
+    test->tree = variant % 2 == 0 ? newRBTree(intCompare, free) :
+                 newRBTreeWithPool(intCompare, free, newNodePool(TEST_NODES_PER_SLAB));
+    if (test->tree == NULL || !setRBTreeSizeFunc(test->tree, variant / 2 == 0 ? NULL :
+                                                               variant / 2 == 1 ? intSize : keySize))
+    {
+        fail("allocation failed", step);
+    }
+#ifdef RBTREE_MAX_WEIGHT
+    if (!setRBTreeWeightFunc(test->tree, rand() % 2 == 0 ? keyWeight : NULL))
+    {
+        fail("allocation failed", step);
+    }
+#endif
+    memset(test->present, 0, sizeof(test->present));
+}
+
+
+/**
+ * make a tree of random keys, from empty to almost full, inserted in random order.
+ */
+void newRandomTree(TestTree *test, int step)
+{
+    static const int densities[] = {0, 2, 30, 100, 190};
+    newTestTree(test, step);
+    int tries = densities[rand() % (sizeof(densities) / sizeof(densities[0]))] * KEY_RANGE / 100;
+    for (int i = 0; i < tries; ++i)
+    {
+        int key = rand() % KEY_RANGE;
+        if (!test->present[key])
+        {
+            if (!insertToRBTree(test->tree, newKey(key, step)))
+            {
+                fail("insert failed", step);
+            }
+            test->present[key] = true;
+        }
+    }
+}
+
+
+/**
+ * split a at a random key, check both halves, and join them back - or join the upper half, first moved to a tree
+ * of another variant, to the lower half.
+ */
+void splitAndJoin(TestTree *a, int step)
+{
+    int key = rand() % (KEY_RANGE + 1);
+    TestTree lo, hi;
+    if (!splitRBTree(a->tree, &key, &lo.tree, &hi.tree))
+    {
+        fail("split failed", step);
+    }
+    for (int k = 0; k < KEY_RANGE; ++k)
+    {
+        lo.present[k] = a->present[k] && k < key;
+        hi.present[k] = a->present[k] && k >= key;
+    }
+    memset(a->present, 0, sizeof(a->present));
+    checkTree(a, step);
+    checkTree(&lo, step);
+    checkTree(&hi, step);
+    freeRBTree(&a->tree);
+    if (rand() % 2 == 0)
+    {
+        TestTree moved;
+        newTestTree(&moved, step);
+        if (!unionRBTree(moved.tree, hi.tree))
+        {
+            fail("union into an empty tree failed", step);
+        }
+        memcpy(moved.present, hi.present, sizeof(hi.present));
+        memset(hi.present, 0, sizeof(hi.present));
+        checkTree(&moved, step);
+        checkTree(&hi, step);
+        freeRBTree(&hi.tree);
+        hi = moved;
+    }
+    if (!joinRBTree(lo.tree, hi.tree))
+    {
+        fail("join of ordered trees failed", step);
+    }
+    for (int k = 0; k < KEY_RANGE; ++k)
+    {
+        lo.present[k] = lo.present[k] || hi.present[k];
+        hi.present[k] = false;
+    }
+    checkTree(&lo, step);
+    checkTree(&hi, step);
+    freeRBTree(&hi.tree);
+    *a = lo;
+}
+
+
+/**
+ * join two trees whose keys are not in order, which must fail and change nothing.
+ */
+void joinOutOfOrder(TestTree *a, TestTree *b, int step)
+{
+    int lowest = KEY_RANGE, highest = -1;
+    for (int k = 0; k < KEY_RANGE; ++k)
+    {
+        lowest = b->present[k] && k < lowest ? k : lowest;
+        highest = a->present[k] ? k : highest;
+    }
+    if (highest >= lowest && joinRBTree(a->tree, b->tree))
+    {
+        fail("join of trees that are not in order succeeded", step);
+    }
+    checkTree(a, step);
+    checkTree(b, step);
+}
+
+
+/**
+ * run random set operations on two trees, checking them after each one.
+ */
+void runRandomOperations(void)
+{
+    TestTree a, b;
+    newRandomTree(&a, 0);
+    newRandomTree(&b, 0);
+    for (int step = 0; step < STEPS; ++step)
+    {
+        int operation = rand() % 6;
+        if (operation == 0)
+        {
+            splitAndJoin(&a, step);
+        }
+        else if (operation == 1)
+        {
+            joinOutOfOrder(&a, &b, step);
+        }
+        else if (operation == 2)
+        {
+            if (!unionRBTree(a.tree, b.tree))
+            {
+                fail("union failed", step);
+            }
+            for (int k = 0; k < KEY_RANGE; ++k)
+            {
+                a.present[k] = a.present[k] || b.present[k];
+                b.present[k] = false;
+            }
+            checkTree(&b, step);
+            freeRBTree(&b.tree);
+            newRandomTree(&b, step);
+        }
+        else if (operation == 3 || operation == 4)
+        {
+            if (!(operation == 3 ? intersectRBTree(a.tree, b.tree) : differenceRBTree(a.tree, b.tree)))
+            {
+                fail(operation == 3 ? "intersection failed" : "difference failed", step);
+            }
+            for (int k = 0; k < KEY_RANGE; ++k)
+            {
+                a.present[k] = a.present[k] && (operation == 3 ? b.present[k] : !b.present[k]);
+            }
+        }
+        else
+        {
+            // a new other tree, and the two trees swap places now and then so that both shapes get reused.
+            freeRBTree(&b.tree);
+            newRandomTree(&b, step);
+            if (rand() % 2 == 0)
+            {
+                TestTree swapped = a;
+                a = b;
+                b = swapped;
+            }
+        }
+        checkTree(&a, step);
+        checkTree(&b, step);
+    }
+    freeRBTree(&a.tree);
+    freeRBTree(&b.tree);
+}
+
+
+/**
+ * run the test.
+ */
+int main(void)
+{
+    srand(1);
+    runRandomOperations();
+    printf("all the checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+#ifndef RBTREE_RBTREESPECIALIZE_H
+#define RBTREE_RBTREESPECIALIZE_H
+
+#include <stdbool.h>
+#include "RBTree.h"
+#include "RBTreeInternal.h"
+
+/**
+ * generates an RBTree API specialized for one item type, where the compare and free functions are called
+ * directly (and can be inlined) instead of through the function pointers of the tree:
+ *
+ *     RBTree *<name>New(void);
+ *     int <name>Insert(RBTree *tree, void *data);
+ *     int <name>Delete(RBTree *tree, void *data);
+ *     int <name>Contains(const RBTree *tree, const void *data);
+ *
+ * the trees are regular RBTrees whose compFunc and freeFunc are compare and freeData, so all the other
+ * functions of RBTree.h work on them, and the specialized functions behave exactly like insertToRBTree,
+ * deleteFromRBTree and RBTreeContains (with RBTREE_STATS they count their searches and latencies the same way).
+ * @param name: prefix of the generated functions.
+ * @param compare: a CompareFunc, preferably static inline and visible to the compiler.
+ * @param freeData: a FreeFunc, preferably static inline and visible to the compiler.
+ */
+#define RBTREE_SPECIALIZE(name, compare, freeData)                                                          \
+static inline Node *name##FindNodeLocation(const RBTree *tree, const void *data, int *result)               \
+{                                                                                                           \
+    Node *node = tree->root, *parent = NULL;                                                                \
+    long unsigned depth = 0;                                                                                \
+    *result = 1;                                                                                            \
+    while (node != NULL)                                                                                    \
+    {                                                                                                       \
+        parent = node;                                                                                      \
+        *result = compare(node->data, data);                                                                \
+        depth++;                                                                                            \
+        if (*result == 0)                                                                                   \
+        {                                                                                                   \
+            break;                                                                                          \
+        }                                                                                                   \
+        node = *result > 0 ? node->left : node->right;                                                      \
+    }                                                                                                       \
+    STATS_SEARCH(tree, depth);                                                                              \
+    return parent;                                                                                          \
+}                                                                                                           \
+                                                                                                            \
+static inline RBTree *name##New(void)                                                                       \
+{                                                                                                           \
+    return newRBTree(compare, freeData);                                                                    \
+}                                                                                                           \
+                                                                                                            \
+static inline int name##InsertItem(RBTree *tree, void *data)                                                \
+{                                                                                                           \
+    if (tree == NULL || data == NULL)                                                                       \
+    {                                                                                                       \
+        return false;                                                                                       \
+    }                                                                                                       \
+    /* a sequential stream starts at the finger, like insertToRBTree (findNodeNear calls compare through */ \
+    /* the compFunc of the tree, which is O(1) amortized for such streams). */                              \
+    int result;                                                                                             \
+    Node *finger = sequentialFinger(tree);                                                                  \
+    Node *parent = finger == NULL ? name##FindNodeLocation(tree, data, &result) :                           \
+                   findNodeNear(tree, finger, data, &result);                                               \
+    if (result == 0)                                                                                        \
+    {                                                                                                       \
+        return false;                                                                                       \
+    }                                                                                                       \
+    Node *node = getNewNode(tree, data);                                                                    \
+    if (node == NULL)                                                                                       \
+    {                                                                                                       \
+        return false;                                                                                       \
+    }                                                                                                       \
+    insertNodeWithFinger(tree, parent, node, result);                                                       \
+    return true;                                                                                            \
+}                                                                                                           \
+                                                                                                            \
+static inline int name##Insert(RBTree *tree, void *data)                                                    \
+{                                                                                                           \
+    long unsigned start = STATS_START();                                                                    \
+    int inserted = name##InsertItem(tree, data);                                                            \
+    if (tree != NULL)                                                                                       \
+    {                                                                                                       \
+        STATS_LATENCY(tree, RBTREE_INSERT, start);                                                          \
+    }                                                                                                       \
+    return inserted;                                                                                        \
+}                                                                                                           \
+                                                                                                            \
+static inline int name##DeleteItem(RBTree *tree, void *data)                                                \
+{                                                                                                           \
+    if (tree == NULL || data == NULL)                                                                       \
+    {                                                                                                       \
+        return false;                                                                                       \
+    }                                                                                                       \
+    int result;                                                                                             \
+    Node *node = name##FindNodeLocation(tree, data, &result);                                               \
+    if (node == NULL || result != 0)                                                                        \
+    {                                                                                                       \
+        return false;                                                                                       \
+    }                                                                                                       \
+    void *removedData = node->data;                                                                         \
+    deleteNode(tree, node);                                                                                 \
+    tree->size--;                                                                                           \
+    freeData(removedData);                                                                                  \
+    return true;                                                                                            \
+}                                                                                                           \
+                                                                                                            \
+static inline int name##Delete(RBTree *tree, void *data)                                                    \
+{                                                                                                           \
+    long unsigned start = STATS_START();                                                                    \
+    int deleted = name##DeleteItem(tree, data);                                                             \
+    if (tree != NULL)                                                                                       \
+    {                                                                                                       \
+        STATS_LATENCY(tree, RBTREE_DELETE, start);                                                          \
+    }                                                                                                       \
+    return deleted;                                                                                         \
+}                                                                                                           \
+                                                                                                            \
+static inline int name##Contains(const RBTree *tree, const void *data)                                      \
+{                                                                                                           \
+    long unsigned start = STATS_START();                                                                    \
+    int result, found = tree != NULL && data != NULL &&                                                     \
+                        name##FindNodeLocation(tree, data, &result) != NULL && result == 0;                 \
+    if (tree != NULL)                                                                                       \
+    {                                                                                                       \
+        STATS_LATENCY(tree, RBTREE_CONTAINS, start);                                                        \
+    }                                                                                                       \
+    return found;                                                                                           \
+}
+
+#endif //RBTREE_RBTREESPECIALIZE_H
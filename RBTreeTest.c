@@ -0,0 +1,183 @@
+/**
+ * a randomized test of the RBTree library: random inserts, deletes and lookups of int keys are checked against a
+ * reference set, and after each step the tree is checked for the red-black invariants (black root, no red node
+ * with a red child, the same number of black nodes on every path, consistent parent links, keys in order, the
+ * size, and the augmented fields of the layout flags). it runs with malloc'ed nodes and with a NodePool.
+ * build and run:
+ *     gcc -std=c99 RBTreeTest.c RBTree-2.c NodePool.c -o RBTreeTest && ./RBTreeTest
+ * build it with -DRBTREE_ORDER_STATISTICS, -DRBTREE_MAX_WEIGHT, -DRBTREE_COMPACT_NODE or -DRBTREE_STATS to test
+ * those layouts. it exits with failure at the first broken invariant.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "RBTree.h"
+#include "NodePool.h"
+#include "RBTreeInternal.h"
+
+#define KEY_RANGE 512
+#define STEPS 20000
+#define ROUNDS 4
+#define TEST_NODES_PER_SLAB 16
+
+
+/**
+ * CompareFunc of int keys.
+ */
+int intCompare(const void *a, const void *b)
+{
+    int x = *(const int *) a, y = *(const int *) b;
+    return (x > y) - (x < y);
+}
+
+
+/**
+ * report a broken invariant and stop the test.
+ */
+void fail(const char *what, int step)
+{
+    fprintf(stderr, "step %d: %s\n", step, what);
+    exit(EXIT_FAILURE);
+}
+
+
+/**
+ * check the sub tree of node, and count its nodes.
+ * @param low: the key all the keys of the sub tree are greater than, NULL for none.
+ * @param high: the key all the keys of the sub tree are smaller than, NULL for none.
+ * @param count: incremented by the number of nodes of the sub tree.
+ * @return: the number of black nodes on each path from node down to a leaf.
+ */
+int checkSubtree(const Node *node, const int *low, const int *high, long unsigned *count, int step)
+{
+    if (node == NULL)
+    {
+        return 1;
+    }
+    const int *key = (const int *) node->data;
+    if ((low != NULL && *key <= *low) || (high != NULL && *key >= *high))
+    {
+        fail("keys out of order", step);
+    }
+    if ((node->left != NULL && nodeParent(node->left) != node) ||
+        (node->right != NULL && nodeParent(node->right) != node))
+    {
+        fail("a child does not point at its parent", step);
+    }
+    if (nodeColor(node) == RED && ((node->left != NULL && nodeColor(node->left) == RED) ||
+                                   (node->right != NULL && nodeColor(node->right) == RED)))
+    {
+        fail("a red node has a red child", step);
+    }
+    (*count)++;
+    int leftBlack = checkSubtree(node->left, low, key, count, step);
+    int rightBlack = checkSubtree(node->right, key, high, count, step);
+    if (leftBlack != rightBlack)
+    {
+        fail("paths with different numbers of black nodes", step);
+    }
+#ifdef RBTREE_ORDER_STATISTICS
+    if (node->subtreeSize != subtreeSize(node->left) + subtreeSize(node->right) + 1)
+    {
+        fail("wrong sub tree size", step);
+    }
+#endif
+#ifdef RBTREE_MAX_WEIGHT
+    if (node->maxWeightNode == NULL || node->maxWeightNode->weight < node->weight ||
+        (node->left != NULL && node->maxWeightNode->weight < node->left->maxWeightNode->weight) ||
+        (node->right != NULL && node->maxWeightNode->weight < node->right->maxWeightNode->weight))
+    {
+        fail("wrong heaviest node of a sub tree", step);
+    }
+#endif
+    return leftBlack + (nodeColor(node) == BLACK);
+}
+
+
+/**
+ * check all the invariants of tree, and that it holds exactly the keys of present.
+ */
+void checkTree(const RBTree *tree, const bool *present, int step)
+{
+    if (tree->root != NULL && (nodeColor(tree->root) != BLACK || nodeParent(tree->root) != NULL))
+    {
+        fail("the root is red or has a parent", step);
+    }
+    long unsigned count = 0, expected = 0;
+    checkSubtree(tree->root, NULL, NULL, &count, step);
+    for (int key = 0; key < KEY_RANGE; ++key)
+    {
+        expected += present[key];
+    }
+    if (count != tree->size || count != expected)
+    {
+        fail("the size does not match the reference", step);
+    }
+}
+
+
+/**
+ * run random inserts, deletes and lookups on a tree, checking it after each of them.
+ */
+void runRandomOperations(RBTree *tree)
+{
+    bool present[KEY_RANGE] = {false};
+    for (int step = 0; step < STEPS; ++step)
+    {
+        int *key = (int *) malloc(sizeof(int));
+        if (key == NULL)
+        {
+            fail("allocation failed", step);
+        }
+        *key = rand() % KEY_RANGE;
+        int operation = rand() % 4;
+        if (operation < 2)
+        {
+            // half of the inserts start at the last inserted node.
+            int inserted = operation == 0 ? insertToRBTree(tree, key) : insertToRBTreeWithHint(tree, key, NULL);
+            if ((inserted != 0) == present[*key])
+            {
+                fail("insert does not match the reference", step);
+            }
+            present[*key] = true;
+            if (!inserted)
+            {
+                free(key);
+            }
+        }
+        else
+        {
+            int deleted = operation == 2 ? deleteFromRBTree(tree, key) : RBTreeContains(tree, key);
+            if ((deleted != 0) != present[*key])
+            {
+                fail(operation == 2 ? "delete does not match the reference" :
+                     "contains does not match the reference", step);
+            }
+            present[*key] = operation == 2 ? false : present[*key];
+            free(key);
+        }
+        checkTree(tree, present, step);
+    }
+}
+
+
+/**
+ * run the test ROUNDS times with malloc'ed nodes and with a NodePool.
+ */
+int main(void)
+{
+    srand(1);
+    for (int round = 0; round < ROUNDS; ++round)
+    {
+        RBTree *tree = round % 2 == 0 ? newRBTree(intCompare, free) :
+                       newRBTreeWithPool(intCompare, free, newNodePool(TEST_NODES_PER_SLAB));
+        if (tree == NULL)
+        {
+            fail("allocation failed", 0);
+        }
+        runRandomOperations(tree);
+        freeRBTree(&tree);
+    }
+    printf("all the checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,788 @@
+#include <stdlib.h>
+#include <string.h>
+#include "RadixTree.h"
+
+/**
+ * a node of each kind shrinks to the kind below when it has this many children or fewer (a few less than the room
+ * of the kind below, so a node that gains and loses one child is not resized every time).
+ */
+#define RADIX_SHRINK16 3
+#define RADIX_SHRINK48 12
+#define RADIX_SHRINK256 37
+
+
+/*
+ * where a child is kept: a slot of an inner node, or the root of the tree (parent NULL).
+ */
+typedef struct RadixSlot
+{
+    RadixNode *parent;
+    int slot;
+} RadixSlot;
+
+
+/**
+ * @return: the bytes of a node of this kind.
+ */
+size_t radixNodeBytes(uint8_t kind)
+{
+    switch (kind)
+    {
+        case RADIX_NODE4:
+            return sizeof(RadixNode4);
+        case RADIX_NODE16:
+            return sizeof(RadixNode16);
+        case RADIX_NODE48:
+            return sizeof(RadixNode48);
+        default:
+            return sizeof(RadixNode256);
+    }
+}
+
+
+/**
+ * @return: the number of children a node of this kind has room for.
+ */
+int radixCapacity(uint8_t kind)
+{
+    switch (kind)
+    {
+        case RADIX_NODE4:
+            return 4;
+        case RADIX_NODE16:
+            return 16;
+        case RADIX_NODE48:
+            return 48;
+        default:
+            return 256;
+    }
+}
+
+
+/**
+ * allocate an empty inner node, and count its memory in the tree.
+ * @return: the node, NULL on failure.
+ */
+RadixNode *newRadixNode(RadixTree *tree, uint8_t kind)
+{
+    RadixNode *node = (RadixNode *) calloc(1, radixNodeBytes(kind));
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    node->kind = kind;
+    tree->nodeBytes += radixNodeBytes(kind);
+    return node;
+}
+
+
+/**
+ * free an inner node (not its children).
+ */
+void freeRadixNode(RadixTree *tree, RadixNode *node)
+{
+    tree->nodeBytes -= radixNodeBytes(node->kind);
+    free(node);
+}
+
+
+/**
+ * @return: the array of the children of a node.
+ */
+void **radixChildren(const RadixNode *node)
+{
+    switch (node->kind)
+    {
+        case RADIX_NODE4:
+            return ((RadixNode4 *) node)->children;
+        case RADIX_NODE16:
+            return ((RadixNode16 *) node)->children;
+        case RADIX_NODE48:
+            return ((RadixNode48 *) node)->children;
+        default:
+            return ((RadixNode256 *) node)->children;
+    }
+}
+
+
+/**
+ * @return: true if the child in this slot of node is a leaf (a string), false if it is an inner node.
+ */
+bool isRadixLeaf(const RadixNode *node, int slot)
+{
+    switch (node->kind)
+    {
+        case RADIX_NODE4:
+            return (((const RadixNode4 *) node)->leaves >> slot) & 1;
+        case RADIX_NODE16:
+            return (((const RadixNode16 *) node)->leaves >> slot) & 1;
+        case RADIX_NODE48:
+            return (((const RadixNode48 *) node)->leaves >> slot) & 1;
+        default:
+            return (((const RadixNode256 *) node)->leaves[slot / 64] >> (slot % 64)) & 1;
+    }
+}
+
+
+/**
+ * mark the child in this slot of node as a leaf or as an inner node.
+ */
+void setRadixLeaf(RadixNode *node, int slot, bool leaf)
+{
+    switch (node->kind)
+    {
+        case RADIX_NODE4:
+        {
+            RadixNode4 *n = (RadixNode4 *) node;
+            n->leaves = (uint8_t) ((n->leaves & ~(1u << slot)) | ((unsigned) leaf << slot));
+            break;
+        }
+        case RADIX_NODE16:
+        {
+            RadixNode16 *n = (RadixNode16 *) node;
+            n->leaves = (uint16_t) ((n->leaves & ~(1u << slot)) | ((unsigned) leaf << slot));
+            break;
+        }
+        case RADIX_NODE48:
+        {
+            RadixNode48 *n = (RadixNode48 *) node;
+            n->leaves = (n->leaves & ~((uint64_t) 1 << slot)) | ((uint64_t) leaf << slot);
+            break;
+        }
+        default:
+        {
+            RadixNode256 *n = (RadixNode256 *) node;
+            n->leaves[slot / 64] = (n->leaves[slot / 64] & ~((uint64_t) 1 << (slot % 64))) |
+                                   ((uint64_t) leaf << (slot % 64));
+            break;
+        }
+    }
+}
+
+
+/**
+ * @return: the slot of the child of node for byte, -1 if there is none.
+ */
+int findRadixSlot(const RadixNode *node, unsigned char byte)
+{
+    switch (node->kind)
+    {
+        case RADIX_NODE4:
+        case RADIX_NODE16:
+        {
+            const unsigned char *keys = node->kind == RADIX_NODE4 ? ((const RadixNode4 *) node)->keys :
+                                        ((const RadixNode16 *) node)->keys;
+            for (int i = 0; i < node->count && keys[i] <= byte; ++i)
+            {
+                if (keys[i] == byte)
+                {
+                    return i;
+                }
+            }
+            return -1;
+        }
+        case RADIX_NODE48:
+            return ((const RadixNode48 *) node)->index[byte] - 1;
+        default:
+            return ((const RadixNode256 *) node)->children[byte] == NULL ? -1 : byte;
+    }
+}
+
+
+/**
+ * find the next child of node in ascending order of bytes.
+ * @param position: where to look from (0 for the first child), moved past the child that is found.
+ * @param byte: set to the byte of the child.
+ * @return: the slot of the child, -1 if there are no more children.
+ */
+int nextRadixSlot(const RadixNode *node, int *position, unsigned char *byte)
+{
+    switch (node->kind)
+    {
+        case RADIX_NODE4:
+        case RADIX_NODE16:
+            if (*position >= node->count)
+            {
+                return -1;
+            }
+            *byte = node->kind == RADIX_NODE4 ? ((const RadixNode4 *) node)->keys[*position] :
+                    ((const RadixNode16 *) node)->keys[*position];
+            return (*position)++;
+        case RADIX_NODE48:
+            for (; *position < 256; ++(*position))
+            {
+                if (((const RadixNode48 *) node)->index[*position] != 0)
+                {
+                    *byte = (unsigned char) *position;
+                    return ((const RadixNode48 *) node)->index[(*position)++] - 1;
+                }
+            }
+            return -1;
+        default:
+            for (; *position < 256; ++(*position))
+            {
+                if (((const RadixNode256 *) node)->children[*position] != NULL)
+                {
+                    *byte = (unsigned char) *position;
+                    return (*position)++;
+                }
+            }
+            return -1;
+    }
+}
+
+
+/**
+ * add a child to a node that has room for it.
+ */
+void placeRadixChild(RadixNode *node, unsigned char byte, void *child, bool leaf)
+{
+    int slot;
+    if (node->kind == RADIX_NODE4 || node->kind == RADIX_NODE16)
+    {
+        unsigned char *keys = node->kind == RADIX_NODE4 ? ((RadixNode4 *) node)->keys : ((RadixNode16 *) node)->keys;
+        void **children = radixChildren(node);
+        for (slot = node->count; slot > 0 && keys[slot - 1] > byte; --slot)
+        {
+            keys[slot] = keys[slot - 1];
+            children[slot] = children[slot - 1];
+            setRadixLeaf(node, slot, isRadixLeaf(node, slot - 1));
+        }
+        keys[slot] = byte;
+    }
+    else if (node->kind == RADIX_NODE48)
+    {
+        RadixNode48 *n = (RadixNode48 *) node;
+        for (slot = 0; n->children[slot] != NULL; ++slot)
+        {
+        }
+        n->index[byte] = (unsigned char) (slot + 1);
+    }
+    else
+    {
+        slot = byte;
+    }
+    radixChildren(node)[slot] = child;
+    setRadixLeaf(node, slot, leaf);
+    node->count++;
+}
+
+
+/**
+ * remove the child in this slot (for byte) from a node.
+ */
+void takeRadixChild(RadixNode *node, int slot, unsigned char byte)
+{
+    void **children = radixChildren(node);
+    if (node->kind == RADIX_NODE4 || node->kind == RADIX_NODE16)
+    {
+        unsigned char *keys = node->kind == RADIX_NODE4 ? ((RadixNode4 *) node)->keys : ((RadixNode16 *) node)->keys;
+        for (; slot + 1 < node->count; ++slot)
+        {
+            keys[slot] = keys[slot + 1];
+            children[slot] = children[slot + 1];
+            setRadixLeaf(node, slot, isRadixLeaf(node, slot + 1));
+        }
+    }
+    else if (node->kind == RADIX_NODE48)
+    {
+        ((RadixNode48 *) node)->index[byte] = 0;
+    }
+    children[slot] = NULL;
+    setRadixLeaf(node, slot, false);
+    node->count--;
+}
+
+
+/**
+ * set the child kept at a place.
+ */
+void setRadixChild(RadixTree *tree, RadixSlot at, void *child, bool leaf)
+{
+    if (at.parent == NULL)
+    {
+        tree->root = child;
+        tree->rootIsLeaf = leaf;
+        return;
+    }
+    radixChildren(at.parent)[at.slot] = child;
+    setRadixLeaf(at.parent, at.slot, leaf);
+}
+
+
+/**
+ * replace a node by a node of another kind with the same path and children.
+ * @param at: where the node is kept.
+ * @return: the new node, NULL on failure (the node is not changed).
+ */
+RadixNode *resizeRadixNode(RadixTree *tree, RadixSlot at, RadixNode *node, uint8_t kind)
+{
+    RadixNode *resized = newRadixNode(tree, kind);
+    if (resized == NULL)
+    {
+        return NULL;
+    }
+    resized->prefixLength = node->prefixLength;
+    memcpy(resized->prefix, node->prefix, sizeof(node->prefix));
+    int position = 0, slot;
+    unsigned char byte;
+    while ((slot = nextRadixSlot(node, &position, &byte)) >= 0)
+    {
+        placeRadixChild(resized, byte, radixChildren(node)[slot], isRadixLeaf(node, slot));
+    }
+    setRadixChild(tree, at, resized, false);
+    freeRadixNode(tree, node);
+    return resized;
+}
+
+
+/**
+ * @return: the smallest string below an inner node. it holds the whole path of the node.
+ */
+const unsigned char *minimumRadixLeaf(const RadixNode *node)
+{
+    for (;;)
+    {
+        int position = 0;
+        unsigned char byte;
+        int slot = nextRadixSlot(node, &position, &byte);
+        if (isRadixLeaf(node, slot))
+        {
+            return (const unsigned char *) radixChildren(node)[slot];
+        }
+        node = (const RadixNode *) radixChildren(node)[slot];
+    }
+}
+
+
+/**
+ * set the path of a node.
+ */
+void setRadixPrefix(RadixNode *node, const unsigned char *prefix, size_t length)
+{
+    node->prefixLength = (uint32_t) length;
+    memcpy(node->prefix, prefix, length < RADIX_MAX_PREFIX ? length : RADIX_MAX_PREFIX);
+}
+
+
+/**
+ * compare the path of node to key from depth. the path has no "\0", so key is not read past its end.
+ * @return: the number of bytes of the path that match.
+ */
+uint32_t matchRadixPrefix(const RadixNode *node, const unsigned char *key, size_t depth)
+{
+    uint32_t i = 0, stored = node->prefixLength < RADIX_MAX_PREFIX ? node->prefixLength : RADIX_MAX_PREFIX;
+    for (; i < stored; ++i)
+    {
+        if (node->prefix[i] != key[depth + i])
+        {
+            return i;
+        }
+    }
+    if (node->prefixLength > RADIX_MAX_PREFIX)
+    {
+        const unsigned char *leaf = minimumRadixLeaf(node);
+        for (; i < node->prefixLength; ++i)
+        {
+            if (leaf[depth + i] != key[depth + i])
+            {
+                return i;
+            }
+        }
+    }
+    return i;
+}
+
+
+/**
+ * constructs a new RadixTree.
+ * @param freeFunc: a function to free the strings of the tree.
+ * @return: the new tree, NULL on failure.
+ */
+RadixTree *newRadixTree(FreeFunc freeFunc)
+{
+    RadixTree *tree = (RadixTree *) malloc(sizeof(RadixTree));
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    tree->root = NULL;
+    tree->rootIsLeaf = false;
+    tree->freeFunc = freeFunc;
+    tree->size = 0;
+    tree->nodeBytes = 0;
+    return tree;
+}
+
+
+/**
+ * add a child to a node, growing it to the next kind if it is full.
+ * @param at: where the node is kept.
+ * @return: true on success, false on failure.
+ */
+bool addRadixChild(RadixTree *tree, RadixSlot at, RadixNode *node, unsigned char byte, void *child, bool leaf)
+{
+    if (node->count == radixCapacity(node->kind) &&
+        (node = resizeRadixNode(tree, at, node, (uint8_t) (node->kind + 1))) == NULL)
+    {
+        return false;
+    }
+    placeRadixChild(node, byte, child, leaf);
+    return true;
+}
+
+
+/**
+ * split the path above a node (or a leaf) at depth + matched, where key leaves it, into a new node 4 with the node
+ * and key as its children.
+ * @param at: where the node is kept.
+ * @param byte: the byte of the path of the node after the matched bytes.
+ * @return: true on success, false on failure.
+ */
+bool splitRadixPath(RadixTree *tree, RadixSlot at, void *node, bool leaf, unsigned char byte,
+                    const unsigned char *key, size_t depth, size_t matched)
+{
+    RadixNode *split = newRadixNode(tree, RADIX_NODE4);
+    if (split == NULL)
+    {
+        return false;
+    }
+    setRadixPrefix(split, key + depth, matched);
+    placeRadixChild(split, byte, node, leaf);
+    placeRadixChild(split, key[depth + matched], (void *) key, true);
+    setRadixChild(tree, at, split, false);
+    return true;
+}
+
+
+/**
+ * add a string to the tree.
+ * @return: 0 on failure, other on success. (if the string is already in the tree - failure).
+ */
+int insertToRadixTree(RadixTree *tree, void *data)
+{
+    if (tree == NULL || data == NULL)
+    {
+        return false;
+    }
+    const unsigned char *key = (const unsigned char *) data;
+    RadixSlot at = {NULL, 0};
+    size_t depth = 0;
+    bool inserted = false;
+    if (tree->root == NULL)
+    {
+        setRadixChild(tree, at, data, true);
+        tree->size++;
+        return true;
+    }
+    for (;;)
+    {
+        void *node = at.parent == NULL ? tree->root : radixChildren(at.parent)[at.slot];
+        if (at.parent == NULL ? tree->rootIsLeaf : isRadixLeaf(at.parent, at.slot))
+        {
+            // the bytes above depth match (the paths are compared in full on the way down). the compare starts at
+            // the byte of the leaf, which is the "\0" of key if the leaf is the same string.
+            const unsigned char *existing = (const unsigned char *) node;
+            size_t i = depth == 0 ? 0 : depth - 1;
+            while (existing[i] == key[i] && key[i] != '\0')
+            {
+                ++i;
+            }
+            inserted = existing[i] != key[i] && splitRadixPath(tree, at, node, true, existing[i], key, depth,
+                                                                i - depth);
+            break;
+        }
+        RadixNode *inner = (RadixNode *) node;
+        uint32_t matched = matchRadixPrefix(inner, key, depth);
+        if (matched < inner->prefixLength)
+        {
+            // a path longer than the node keeps is read from a string below the node.
+            const unsigned char *leaf = inner->prefixLength > RADIX_MAX_PREFIX ? minimumRadixLeaf(inner) : NULL;
+            unsigned char byte = matched < RADIX_MAX_PREFIX ? inner->prefix[matched] : leaf[depth + matched];
+            uint32_t remaining = inner->prefixLength - matched - 1;
+            if (!splitRadixPath(tree, at, inner, false, byte, key, depth, matched))
+            {
+                break;
+            }
+            if (inner->prefixLength <= RADIX_MAX_PREFIX)
+            {
+                memmove(inner->prefix, inner->prefix + matched + 1, remaining);
+            }
+            else
+            {
+                memcpy(inner->prefix, leaf + depth + matched + 1,
+                       remaining < RADIX_MAX_PREFIX ? remaining : RADIX_MAX_PREFIX);
+            }
+            inner->prefixLength = remaining;
+            inserted = true;
+            break;
+        }
+        depth += inner->prefixLength;
+        int slot = findRadixSlot(inner, key[depth]);
+        if (slot < 0)
+        {
+            inserted = addRadixChild(tree, at, inner, key[depth], data, true);
+            break;
+        }
+        at.parent = inner;
+        at.slot = slot;
+        depth++;
+    }
+    if (inserted)
+    {
+        tree->size++;
+    }
+    return inserted;
+}
+
+
+/**
+ * remove a child from a node, shrink the node if it became small, and replace a node 4 that is left with one child
+ * by the child (the path of the node and the byte of the child are put before the path of the child).
+ * @param at: where the node is kept.
+ */
+void removeRadixChild(RadixTree *tree, RadixSlot at, RadixNode *node, int slot, unsigned char byte)
+{
+    takeRadixChild(node, slot, byte);
+    if (node->kind == RADIX_NODE4 && node->count == 1)
+    {
+        int position = 0;
+        int only = nextRadixSlot(node, &position, &byte);
+        void *child = radixChildren(node)[only];
+        bool leaf = isRadixLeaf(node, only);
+        if (!leaf)
+        {
+            RadixNode *inner = (RadixNode *) child;
+            unsigned char prefix[RADIX_MAX_PREFIX];
+            uint32_t stored = node->prefixLength < RADIX_MAX_PREFIX ? node->prefixLength : RADIX_MAX_PREFIX;
+            memcpy(prefix, node->prefix, stored);
+            if (stored < RADIX_MAX_PREFIX)
+            {
+                prefix[stored++] = byte;
+            }
+            uint32_t rest = RADIX_MAX_PREFIX - stored;
+            rest = inner->prefixLength < rest ? inner->prefixLength : rest;
+            memcpy(prefix + stored, inner->prefix, rest);
+            memcpy(inner->prefix, prefix, stored + rest);
+            inner->prefixLength += node->prefixLength + 1;
+        }
+        setRadixChild(tree, at, child, leaf);
+        freeRadixNode(tree, node);
+    }
+    else if ((node->kind == RADIX_NODE16 && node->count <= RADIX_SHRINK16) ||
+             (node->kind == RADIX_NODE48 && node->count <= RADIX_SHRINK48) ||
+             (node->kind == RADIX_NODE256 && node->count <= RADIX_SHRINK256))
+    {
+        // if there is no memory for the smaller node, the node is kept as it is.
+        resizeRadixNode(tree, at, node, (uint8_t) (node->kind - 1));
+    }
+}
+
+
+/**
+ * remove a string from the tree, and free it.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromRadixTree(RadixTree *tree, void *data)
+{
+    if (tree == NULL || tree->freeFunc == NULL || data == NULL)
+    {
+        return false;
+    }
+    const unsigned char *key = (const unsigned char *) data;
+    size_t length = strlen((const char *) data) + 1, depth = 0;
+    RadixSlot at = {NULL, 0}, parentAt = {NULL, 0};
+    void *node = tree->root;
+    bool leaf = tree->rootIsLeaf;
+    while (node != NULL && !leaf)
+    {
+        RadixNode *inner = (RadixNode *) node;
+        uint32_t stored = inner->prefixLength < RADIX_MAX_PREFIX ? inner->prefixLength : RADIX_MAX_PREFIX;
+        if (depth + inner->prefixLength >= length || memcmp(inner->prefix, key + depth, stored) != 0)
+        {
+            return false;
+        }
+        depth += inner->prefixLength;
+        int slot = findRadixSlot(inner, key[depth++]);
+        if (slot < 0)
+        {
+            return false;
+        }
+        parentAt = at;
+        at.parent = inner;
+        at.slot = slot;
+        node = radixChildren(inner)[slot];
+        leaf = isRadixLeaf(inner, slot);
+    }
+    if (node == NULL || strcmp((const char *) node, (const char *) data) != 0)
+    {
+        return false;
+    }
+    if (at.parent == NULL)
+    {
+        setRadixChild(tree, at, NULL, false);
+    }
+    else
+    {
+        removeRadixChild(tree, parentAt, at.parent, at.slot, key[depth - 1]);
+    }
+    tree->size--;
+    tree->freeFunc(node);
+    return true;
+}
+
+
+/**
+ * check whether the tree contains this string. the paths of the nodes are skipped after their first bytes, and the
+ * string that is reached is compared in full.
+ * @return: 0 if the string is not in the tree, other if it is.
+ */
+int RadixTreeContains(const RadixTree *tree, const void *data)
+{
+    if (tree == NULL || data == NULL)
+    {
+        return false;
+    }
+    const unsigned char *key = (const unsigned char *) data;
+    size_t length = strlen((const char *) data) + 1, depth = 0;
+    const void *node = tree->root;
+    bool leaf = tree->rootIsLeaf;
+    while (node != NULL && !leaf)
+    {
+        const RadixNode *inner = (const RadixNode *) node;
+        uint32_t stored = inner->prefixLength < RADIX_MAX_PREFIX ? inner->prefixLength : RADIX_MAX_PREFIX;
+        if (depth + inner->prefixLength >= length || memcmp(inner->prefix, key + depth, stored) != 0)
+        {
+            return false;
+        }
+        depth += inner->prefixLength;
+        int slot = findRadixSlot(inner, key[depth++]);
+        if (slot < 0)
+        {
+            return false;
+        }
+        node = radixChildren(inner)[slot];
+        leaf = isRadixLeaf(inner, slot);
+    }
+    return node != NULL && strcmp((const char *) node, (const char *) data) == 0;
+}
+
+
+/**
+ * Activate a function on each string below a child in ascending order.
+ * @return: false if one of the activations returned 0, true otherwise.
+ */
+bool forEachRadixChild(const void *node, bool leaf, forEachFunc func, void *args)
+{
+    if (leaf)
+    {
+        return func(node, args);
+    }
+    const RadixNode *inner = (const RadixNode *) node;
+    int position = 0, slot;
+    unsigned char byte;
+    while ((slot = nextRadixSlot(inner, &position, &byte)) >= 0)
+    {
+        if (!forEachRadixChild(radixChildren(inner)[slot], isRadixLeaf(inner, slot), func, args))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Activate a function on each string of the tree in ascending order. if one of the activations of the function
+ * returns 0, the process stops.
+ * @return: 0 on failure, other on success.
+ */
+int forEachRadixTree(const RadixTree *tree, forEachFunc func, void *args)
+{
+    if (tree == NULL || func == NULL)
+    {
+        return false;
+    }
+    return tree->root == NULL || forEachRadixChild(tree->root, tree->rootIsLeaf, func, args);
+}
+
+
+/**
+ * Activate a function on each string of the tree that starts with prefix, in ascending order. if one of the
+ * activations of the function returns 0, the process stops.
+ * @return: 0 on failure, other on success.
+ */
+int forEachWithPrefix(const RadixTree *tree, const char *prefix, forEachFunc func, void *args)
+{
+    if (tree == NULL || prefix == NULL || func == NULL)
+    {
+        return false;
+    }
+    const unsigned char *bytes = (const unsigned char *) prefix;
+    size_t length = strlen(prefix), depth = 0;
+    const void *node = tree->root;
+    bool leaf = tree->rootIsLeaf;
+    // go down by the bytes of prefix, skipping the paths of the nodes, to the first node whose path covers all of
+    // prefix. the strings below it share their first bytes, so one of them tells whether they all start with prefix.
+    while (node != NULL && !leaf && depth + ((const RadixNode *) node)->prefixLength < length)
+    {
+        const RadixNode *inner = (const RadixNode *) node;
+        depth += inner->prefixLength;
+        int slot = findRadixSlot(inner, bytes[depth++]);
+        if (slot < 0)
+        {
+            return true;
+        }
+        node = radixChildren(inner)[slot];
+        leaf = isRadixLeaf(inner, slot);
+    }
+    if (node == NULL)
+    {
+        return true;
+    }
+    const char *first = leaf ? (const char *) node : (const char *) minimumRadixLeaf((const RadixNode *) node);
+    return strncmp(first, prefix, length) != 0 || forEachRadixChild(node, leaf, func, args);
+}
+
+
+/**
+ * free the nodes below a child, and the strings.
+ */
+void freeRadixChild(RadixTree *tree, void *node, bool leaf)
+{
+    if (leaf)
+    {
+        if (tree->freeFunc != NULL)
+        {
+            tree->freeFunc(node);
+        }
+        return;
+    }
+    RadixNode *inner = (RadixNode *) node;
+    int position = 0, slot;
+    unsigned char byte;
+    while ((slot = nextRadixSlot(inner, &position, &byte)) >= 0)
+    {
+        freeRadixChild(tree, radixChildren(inner)[slot], isRadixLeaf(inner, slot));
+    }
+    freeRadixNode(tree, inner);
+}
+
+
+/**
+ * free all memory of the tree, and its strings.
+ * @param tree: pointer to the tree to free.
+ */
+void freeRadixTree(RadixTree **tree)
+{
+    if (tree == NULL || (*tree) == NULL)
+    {
+        return;
+    }
+    if ((*tree)->root != NULL)
+    {
+        freeRadixChild(*tree, (*tree)->root, (*tree)->rootIsLeaf);
+    }
+    free(*tree);
+    (*tree) = NULL;
+}
@@ -0,0 +1,140 @@
+#ifndef RBTREE_RADIXTREE_H
+#define RBTREE_RADIXTREE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "RBTree.h"
+
+/**
+ * the bytes of the compressed path of a node that are kept in the node. the rest of a longer path is read from one
+ * of the strings below the node.
+ */
+#define RADIX_MAX_PREFIX 10
+
+/**
+ * the kinds of inner nodes, by the number of children they have room for.
+ */
+typedef enum RadixKind
+{
+	RADIX_NODE4, RADIX_NODE16, RADIX_NODE48, RADIX_NODE256
+} RadixKind;
+
+/*
+ * the header of all the inner nodes. the path from the parent is compressed: the node stands for prefixLength bytes
+ * that all the strings below it share, followed by the byte of each child. a child is an inner node, or a leaf,
+ * which is the string itself (the leaves bit of its slot is set).
+ */
+typedef struct RadixNode
+{
+	uint8_t kind;
+	uint16_t count;
+	uint32_t prefixLength;
+	unsigned char prefix[RADIX_MAX_PREFIX]; // the first bytes of the path.
+} RadixNode;
+
+/*
+ * up to 4 children, keys sorted.
+ */
+typedef struct RadixNode4
+{
+	RadixNode header;
+	uint8_t leaves;
+	unsigned char keys[4];
+	void *children[4];
+} RadixNode4;
+
+/*
+ * up to 16 children, keys sorted.
+ */
+typedef struct RadixNode16
+{
+	RadixNode header;
+	uint16_t leaves;
+	unsigned char keys[16];
+	void *children[16];
+} RadixNode16;
+
+/*
+ * up to 48 children: index holds the slot of each byte plus 1, 0 for no child.
+ */
+typedef struct RadixNode48
+{
+	RadixNode header;
+	uint64_t leaves;
+	unsigned char index[256];
+	void *children[48];
+} RadixNode48;
+
+/*
+ * a child for every byte.
+ */
+typedef struct RadixNode256
+{
+	RadixNode header;
+	uint64_t leaves[4];
+	void *children[256];
+} RadixNode256;
+
+/**
+ * an adaptive radix tree of C strings, with the operations of RBTree.h. a lookup reads each byte of the string
+ * once, instead of comparing shared prefixes again at every level of an RBTree, and paths with one child are
+ * compressed into their node, so long common prefixes (URLs, paths) cost one node. inner nodes grow from 4 to 16,
+ * 48 and 256 children and shrink back. the strings are the leaves (there is no node per item), and are kept in
+ * ascending strcmp order (the order of stringCompare).
+ */
+typedef struct RadixTree
+{
+	void *root;
+	bool rootIsLeaf;
+	FreeFunc freeFunc;
+	long unsigned size;
+	size_t nodeBytes; // the memory of the inner nodes.
+} RadixTree;
+
+/**
+ * constructs a new RadixTree.
+ * @param freeFunc: a function to free the strings of the tree.
+ * @return: the new tree, NULL on failure.
+ */
+RadixTree *newRadixTree(FreeFunc freeFunc);
+
+/**
+ * add a string to the tree.
+ * @return: 0 on failure, other on success. (if the string is already in the tree - failure).
+ */
+int insertToRadixTree(RadixTree *tree, void *data);
+
+/**
+ * remove a string from the tree, and free it.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromRadixTree(RadixTree *tree, void *data);
+
+/**
+ * check whether the tree contains this string.
+ * @return: 0 if the string is not in the tree, other if it is.
+ */
+int RadixTreeContains(const RadixTree *tree, const void *data);
+
+/**
+ * Activate a function on each string of the tree in ascending order. if one of the activations of the function
+ * returns 0, the process stops.
+ * @return: 0 on failure, other on success.
+ */
+int forEachRadixTree(const RadixTree *tree, forEachFunc func, void *args);
+
+/**
+ * Activate a function on each string of the tree that starts with prefix, in ascending order. if one of the
+ * activations of the function returns 0, the process stops.
+ * @return: 0 on failure, other on success.
+ */
+int forEachWithPrefix(const RadixTree *tree, const char *prefix, forEachFunc func, void *args);
+
+/**
+ * free all memory of the tree, and its strings.
+ * @param tree: pointer to the tree to free.
+ */
+void freeRadixTree(RadixTree **tree);
+
+#endif //RBTREE_RADIXTREE_H
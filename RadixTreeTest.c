@@ -0,0 +1,295 @@
+/**
+ * a randomized test of RadixTree: random inserts, deletes and lookups of strings are checked against a sorted
+ * reference, and after each step all the strings of the tree (forEachRadixTree) must come in the order of the
+ * reference, and the strings with a random prefix (forEachWithPrefix) must be exactly those of the reference that
+ * start with it. the strings share prefixes longer than RADIX_MAX_PREFIX, have bytes of 0x80 and above, are
+ * prefixes of each other and include the empty string, and some nodes have enough children to grow to 256 and
+ * shrink back. at the end the tree is emptied and must have no nodes left.
+ * build and run:
+ *     gcc -std=c99 RadixTreeTest.c RadixTree.c -o RadixTreeTest && ./RadixTreeTest
+ * it exits with failure at the first wrong result.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "RadixTree.h"
+
+#define CANDIDATES 1000
+#define MAX_SUFFIX 5
+#define STEPS 8000
+#define ROUNDS 8
+#define BASES (sizeof(bases) / sizeof(bases[0]))
+
+/**
+ * the paths the strings start with: none, short ones, ones longer than RADIX_MAX_PREFIX (one of them extending
+ * the other), and ones of bytes of 0x80 and above.
+ */
+static const char *const bases[] = {"", "a", "ab", "common/prefix/longer/than/ten/",
+                                    "common/prefix/longer/than/ten/\x80\xff\x80\xff/sub/",
+                                    "\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9",
+                                    "\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"};
+
+/**
+ * the sorted strings the test picks from, and which of them should be in the tree.
+ */
+typedef struct Reference
+{
+    char *strings[CANDIDATES];
+    bool present[CANDIDATES];
+    size_t count;
+} Reference;
+
+/**
+ * the strings a forEach visited, in order.
+ */
+typedef struct Visited
+{
+    const char *strings[CANDIDATES];
+    size_t count;
+} Visited;
+
+
+/**
+ * report a wrong result and stop the test.
+ */
+void fail(const char *what, int step)
+{
+    fprintf(stderr, "step %d: %s\n", step, what);
+    exit(EXIT_FAILURE);
+}
+
+
+/**
+ * qsort compare of strings, in the order of strcmp (bytes as unsigned char).
+ */
+int compareStrings(const void *a, const void *b)
+{
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+
+/**
+ * @return: a copy of string, stops the test on failure.
+ */
+char *copyString(const char *string, int step)
+{
+    char *copy = (char *) malloc(strlen(string) + 1);
+    if (copy == NULL)
+    {
+        fail("allocation failed", step);
+    }
+    return strcpy(copy, string);
+}
+
+
+/**
+ * fill the reference with distinct random strings: a base followed by a few bytes, each either from a small set
+ * (so that the strings share prefixes) or any byte but "\0". a third of the bases are cut at a random length, so
+ * that the long paths are split at every depth. the first byte after the empty base is always any byte, so that
+ * the root gets enough children to grow to a node 256. each round uses some of the bases, so that in some rounds
+ * all the strings share a long path from the root.
+ */
+void makeReference(Reference *reference)
+{
+    static const char small[] = {'a', 'b', '/', (char) 0x80, (char) 0xff};
+    char buffer[128];
+    size_t used[BASES], usedCount = 0, count = 0;
+    for (size_t i = 0; i < BASES; ++i)
+    {
+        if (rand() % 2 == 0)
+        {
+            used[usedCount++] = i;
+        }
+    }
+    if (usedCount == 0)
+    {
+        used[usedCount++] = (size_t) rand() % BASES;
+    }
+    for (int i = 0; i < 4 * CANDIDATES && count < CANDIDATES; ++i)
+    {
+        strcpy(buffer, bases[used[(size_t) rand() % usedCount]]);
+        size_t length = strlen(buffer);
+        length = rand() % 3 == 0 ? (size_t) rand() % (length + 1) : length;
+        size_t suffix = (size_t) (rand() % (MAX_SUFFIX + 1));
+        bool wide = length == 0;
+        for (size_t j = 0; j < suffix; ++j)
+        {
+            bool any = (wide && j == 0) || rand() % 2 == 0;
+            buffer[length++] = any ? (char) (1 + rand() % 255) : small[rand() % sizeof(small)];
+        }
+        buffer[length] = '\0';
+        reference->strings[count++] = copyString(buffer, 0);
+    }
+    qsort(reference->strings, count, sizeof(char *), compareStrings);
+    size_t distinct = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (distinct > 0 && strcmp(reference->strings[distinct - 1], reference->strings[i]) == 0)
+        {
+            free(reference->strings[i]);
+            continue;
+        }
+        reference->strings[distinct] = reference->strings[i];
+        reference->present[distinct++] = false;
+    }
+    reference->count = distinct;
+}
+
+
+/**
+ * forEachFunc that adds the string to a Visited.
+ */
+int visit(const void *object, void *args)
+{
+    Visited *visited = (Visited *) args;
+    if (visited->count == CANDIDATES)
+    {
+        return false;
+    }
+    visited->strings[visited->count++] = (const char *) object;
+    return true;
+}
+
+
+/**
+ * check that a forEach visited exactly the strings of the reference that start with prefix, in order.
+ */
+void checkVisited(const Reference *reference, const Visited *visited, const char *prefix, int step)
+{
+    size_t length = strlen(prefix), next = 0;
+    for (size_t i = 0; i < reference->count; ++i)
+    {
+        if (!reference->present[i] || strncmp(reference->strings[i], prefix, length) != 0)
+        {
+            continue;
+        }
+        if (next == visited->count || strcmp(visited->strings[next], reference->strings[i]) != 0)
+        {
+            fail(length == 0 ? "forEachRadixTree does not match the reference" :
+                 "forEachWithPrefix does not match the reference", step);
+        }
+        next++;
+    }
+    if (next != visited->count)
+    {
+        fail("a forEach visited a string that is not in the reference", step);
+    }
+}
+
+
+/**
+ * check all the strings of the tree, and the strings with a prefix of a random candidate (which may end inside a
+ * path of a node, or after the candidate ends).
+ */
+void checkTree(const RadixTree *tree, const Reference *reference, int step)
+{
+    Visited visited = {{NULL}, 0};
+    size_t size = 0;
+    for (size_t i = 0; i < reference->count; ++i)
+    {
+        size += reference->present[i];
+    }
+    if (tree->size != size || !forEachRadixTree(tree, visit, &visited))
+    {
+        fail("the size does not match the reference", step);
+    }
+    checkVisited(reference, &visited, "", step);
+    char prefix[128];
+    strcpy(prefix, reference->strings[rand() % reference->count]);
+    size_t length = strlen(prefix), cut = (size_t) rand() % (length + 2);
+    if (cut > length)
+    {
+        prefix[length++] = (char) (1 + rand() % 255);
+        prefix[length] = '\0';
+    }
+    else
+    {
+        prefix[cut] = '\0';
+    }
+    visited.count = 0;
+    if (!forEachWithPrefix(tree, prefix, visit, &visited))
+    {
+        fail("forEachWithPrefix failed", step);
+    }
+    checkVisited(reference, &visited, prefix, step);
+}
+
+
+/**
+ * run random inserts, deletes and lookups, checking the tree after each of them, and then empty it.
+ */
+void runRandomOperations(RadixTree *tree, Reference *reference)
+{
+    for (int step = 0; step < STEPS; ++step)
+    {
+        size_t i = (size_t) rand() % reference->count;
+        char *string = copyString(reference->strings[i], step);
+        int operation = rand() % 3;
+        if (operation == 0)
+        {
+            int inserted = insertToRadixTree(tree, string);
+            if ((inserted != 0) == reference->present[i])
+            {
+                fail("insert does not match the reference", step);
+            }
+            reference->present[i] = true;
+            if (!inserted)
+            {
+                free(string);
+            }
+        }
+        else
+        {
+            int found = operation == 1 ? deleteFromRadixTree(tree, string) : RadixTreeContains(tree, string);
+            if ((found != 0) != reference->present[i])
+            {
+                fail(operation == 1 ? "delete does not match the reference" :
+                     "contains does not match the reference", step);
+            }
+            reference->present[i] = operation == 1 ? false : reference->present[i];
+            free(string);
+        }
+        checkTree(tree, reference, step);
+    }
+    for (size_t i = 0; i < reference->count; ++i)
+    {
+        if (reference->present[i] && !deleteFromRadixTree(tree, reference->strings[i]))
+        {
+            fail("delete of a string of the tree failed", STEPS);
+        }
+        reference->present[i] = false;
+    }
+    checkTree(tree, reference, STEPS);
+    if (tree->root != NULL || tree->nodeBytes != 0)
+    {
+        fail("the empty tree has nodes left", STEPS);
+    }
+}
+
+
+/**
+ * run the test ROUNDS times, with different strings.
+ */
+int main(void)
+{
+    srand(1);
+    for (int round = 0; round < ROUNDS; ++round)
+    {
+        Reference reference;
+        makeReference(&reference);
+        RadixTree *tree = newRadixTree(free);
+        if (tree == NULL)
+        {
+            fail("allocation failed", 0);
+        }
+        runRandomOperations(tree, &reference);
+        freeRadixTree(&tree);
+        for (size_t i = 0; i < reference.count; ++i)
+        {
+            free(reference.strings[i]);
+        }
+    }
+    printf("all the checks passed\n");
+    return EXIT_SUCCESS;
+}
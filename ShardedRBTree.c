@@ -0,0 +1,292 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdbool.h>
+#include "ShardedRBTree.h"
+
+
+/**
+ * free the first count shards of a tree (their trees and their locks) and the tree.
+ */
+void freeShards(ShardedRBTree *tree, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        freeRBTree(&tree->shards[i].tree);
+        pthread_rwlock_destroy(&tree->shards[i].lock);
+    }
+    free(tree->shards);
+    free(tree);
+}
+
+
+/**
+ * constructs a new ShardedRBTree.
+ * @param shardCount: number of shards (at least 1), a few times the number of writing threads.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free the items of the tree.
+ * @param hashFunc: the function that chooses the shard of an item.
+ * @return: the new tree, NULL on failure.
+ */
+ShardedRBTree *newShardedRBTree(size_t shardCount, CompareFunc compFunc, FreeFunc freeFunc, HashFunc hashFunc)
+{
+    if (shardCount == 0 || compFunc == NULL || hashFunc == NULL)
+    {
+        return NULL;
+    }
+    ShardedRBTree *tree = (ShardedRBTree *) malloc(sizeof(ShardedRBTree));
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    void *shards = NULL;
+    if (posix_memalign(&shards, SHARD_ALIGNMENT, shardCount * sizeof(RBTreeShard)) != 0)
+    {
+        free(tree);
+        return NULL;
+    }
+    tree->shards = (RBTreeShard *) shards;
+    tree->shardCount = shardCount;
+    tree->hashFunc = hashFunc;
+    tree->compFunc = compFunc;
+    for (size_t i = 0; i < shardCount; ++i)
+    {
+        if ((tree->shards[i].tree = newRBTree(compFunc, freeFunc)) == NULL)
+        {
+            freeShards(tree, i);
+            return NULL;
+        }
+        if (pthread_rwlock_init(&tree->shards[i].lock, NULL) != 0)
+        {
+            freeRBTree(&tree->shards[i].tree);
+            freeShards(tree, i);
+            return NULL;
+        }
+    }
+    return tree;
+}
+
+
+/**
+ * @return: the shard of an item.
+ */
+RBTreeShard *shardOf(const ShardedRBTree *tree, const void *data)
+{
+    return &tree->shards[tree->hashFunc(data) % tree->shardCount];
+}
+
+
+/**
+ * add an item to the tree, locking only its shard exclusively.
+ * @param tree: the tree to add an item to.
+ * @param data: item to add to the tree.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToShardedRBTree(ShardedRBTree *tree, void *data)
+{
+    if (tree == NULL || data == NULL)
+    {
+        return false;
+    }
+    RBTreeShard *shard = shardOf(tree, data);
+    if (pthread_rwlock_wrlock(&shard->lock) != 0)
+    {
+        return false;
+    }
+    int result = insertToRBTree(shard->tree, data);
+    pthread_rwlock_unlock(&shard->lock);
+    return result;
+}
+
+
+/**
+ * remove an item from the tree, locking only its shard exclusively.
+ * @param tree: the tree to remove an item from.
+ * @param data: item to remove from the tree.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromShardedRBTree(ShardedRBTree *tree, void *data)
+{
+    if (tree == NULL || data == NULL)
+    {
+        return false;
+    }
+    RBTreeShard *shard = shardOf(tree, data);
+    if (pthread_rwlock_wrlock(&shard->lock) != 0)
+    {
+        return false;
+    }
+    int result = deleteFromRBTree(shard->tree, data);
+    pthread_rwlock_unlock(&shard->lock);
+    return result;
+}
+
+
+/**
+ * check whether the tree contains this item, in parallel with the other readers of its shard.
+ * @param tree: the tree to check an item in.
+ * @param data: item to check.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int ShardedRBTreeContains(ShardedRBTree *tree, const void *data)
+{
+    if (tree == NULL || data == NULL)
+    {
+        return false;
+    }
+    RBTreeShard *shard = shardOf(tree, data);
+    if (pthread_rwlock_rdlock(&shard->lock) != 0)
+    {
+        return false;
+    }
+    int result = RBTreeContains(shard->tree, data);
+    pthread_rwlock_unlock(&shard->lock);
+    return result;
+}
+
+
+/**
+ * @param tree: the tree to count the items of.
+ * @return: the number of items in all the shards (each shard is counted at a different moment).
+ */
+long unsigned ShardedRBTreeSize(ShardedRBTree *tree)
+{
+    long unsigned size = 0;
+    for (size_t i = 0; tree != NULL && i < tree->shardCount; ++i)
+    {
+        if (pthread_rwlock_rdlock(&tree->shards[i].lock) == 0)
+        {
+            size += tree->shards[i].tree->size;
+            pthread_rwlock_unlock(&tree->shards[i].lock);
+        }
+    }
+    return size;
+}
+
+
+/**
+ * the state of the k-way merge of forEachShardedRBTree: a binary min heap of the shards that were not
+ * exhausted yet, ordered by the item their iterator points at.
+ */
+typedef struct ShardMerge
+{
+    RBTreeIterator *iterators; // one for each shard.
+    size_t *heap; // indices of shards.
+    size_t count;
+    CompareFunc compFunc;
+} ShardMerge;
+
+
+/**
+ * @return: whether the current item of shard a is smaller than the current item of shard b.
+ */
+bool shardIsBefore(const ShardMerge *merge, size_t a, size_t b)
+{
+    return merge->compFunc(RBTreeIteratorData(&merge->iterators[a]), RBTreeIteratorData(&merge->iterators[b])) < 0;
+}
+
+
+/**
+ * move the shard at position i of the heap down to its place.
+ */
+void siftShardDown(ShardMerge *merge, size_t i)
+{
+    while (2 * i + 1 < merge->count)
+    {
+        size_t child = 2 * i + 1;
+        if (child + 1 < merge->count && shardIsBefore(merge, merge->heap[child + 1], merge->heap[child]))
+        {
+            child++;
+        }
+        if (!shardIsBefore(merge, merge->heap[child], merge->heap[i]))
+        {
+            return;
+        }
+        size_t shard = merge->heap[i];
+        merge->heap[i] = merge->heap[child];
+        merge->heap[child] = shard;
+        i = child;
+    }
+}
+
+
+/**
+ * merge the locked shards of tree in ascending order, activating func on each item.
+ * @return: 0 on failure, other on success.
+ */
+bool mergeShards(const ShardedRBTree *tree, ShardMerge *merge, forEachFunc func, void *args)
+{
+    for (size_t i = 0; i < tree->shardCount; ++i)
+    {
+        if (RBTreeBegin(tree->shards[i].tree, &merge->iterators[i]))
+        {
+            merge->heap[merge->count++] = i;
+        }
+    }
+    for (size_t i = merge->count / 2; i > 0; --i)
+    {
+        siftShardDown(merge, i - 1);
+    }
+    while (merge->count > 0)
+    {
+        RBTreeIterator *smallest = &merge->iterators[merge->heap[0]];
+        if (!func(RBTreeIteratorData(smallest), args))
+        {
+            return false;
+        }
+        if (!RBTreeIteratorNext(smallest))
+        {
+            merge->heap[0] = merge->heap[--merge->count];
+        }
+        siftShardDown(merge, 0);
+    }
+    return true;
+}
+
+
+/**
+ * Activate a function on each item of the tree in ascending order, by a k-way merge of the shards in
+ * O(n log k). all the shards are read locked during the traversal.
+ * @param tree: the tree with all the items.
+ * @param func: the function to activate on all items.
+ * @param args: more optional arguments to the function.
+ * @return: 0 on failure, other on success.
+ */
+int forEachShardedRBTree(ShardedRBTree *tree, forEachFunc func, void *args)
+{
+    if (tree == NULL || func == NULL)
+    {
+        return false;
+    }
+    ShardMerge merge = {(RBTreeIterator *) malloc(tree->shardCount * sizeof(RBTreeIterator)),
+                        (size_t *) malloc(tree->shardCount * sizeof(size_t)), 0, tree->compFunc};
+    bool result = merge.iterators != NULL && merge.heap != NULL;
+    size_t locked = 0;
+    // the shards are locked in the same order by every traversal, and a writer holds one lock at a time.
+    while (result && locked < tree->shardCount && pthread_rwlock_rdlock(&tree->shards[locked].lock) == 0)
+    {
+        locked++;
+    }
+    result = result && locked == tree->shardCount && mergeShards(tree, &merge, func, args);
+    while (locked > 0)
+    {
+        pthread_rwlock_unlock(&tree->shards[--locked].lock);
+    }
+    free(merge.iterators);
+    free(merge.heap);
+    return result;
+}
+
+
+/**
+ * free all memory of the data structure.
+ * @param tree: pointer to the tree to free.
+ */
+void freeShardedRBTree(ShardedRBTree **tree)
+{
+    if (tree == NULL || (*tree) == NULL)
+    {
+        return;
+    }
+    freeShards(*tree, (*tree)->shardCount);
+    (*tree) = NULL;
+}
@@ -0,0 +1,89 @@
+#ifndef RBTREE_SHARDEDRBTREE_H
+#define RBTREE_SHARDEDRBTREE_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "RBTree.h"
+
+/**
+ * a function that hashes an item. items that the CompareFunc finds equal must have the same hash.
+ * (stringHash and vectorHash of Structs.h hash strings and Vectors).
+ */
+typedef size_t (*HashFunc)(const void *data);
+
+/**
+ * the shards are placed this many bytes apart (a cache line), so the locks of two shards do not share a line.
+ */
+#define SHARD_ALIGNMENT 64
+
+/**
+ * one RBTree of a ShardedRBTree and its lock, padded to a multiple of SHARD_ALIGNMENT.
+ */
+typedef struct RBTreeShard
+{
+	pthread_rwlock_t lock;
+	RBTree *tree;
+	char padding[SHARD_ALIGNMENT - (sizeof(pthread_rwlock_t) + sizeof(RBTree *)) % SHARD_ALIGNMENT];
+} RBTreeShard;
+
+/**
+ * a set of independent RBTrees (shards), each with its own lock, that many threads can write to at once. the
+ * hash of an item chooses its shard, so inserts, deletes and lookups lock a single shard: writers of different
+ * shards do not wait for each other, and readers of a shard run in parallel. forEach merges the shards, so it
+ * still visits the items in ascending order.
+ */
+typedef struct ShardedRBTree
+{
+	RBTreeShard *shards;
+	size_t shardCount;
+	HashFunc hashFunc;
+	CompareFunc compFunc;
+} ShardedRBTree;
+
+/**
+ * constructs a new ShardedRBTree.
+ * @param shardCount: number of shards (at least 1), a few times the number of writing threads.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free the items of the tree.
+ * @param hashFunc: the function that chooses the shard of an item.
+ * @return: the new tree, NULL on failure.
+ */
+ShardedRBTree *newShardedRBTree(size_t shardCount, CompareFunc compFunc, FreeFunc freeFunc, HashFunc hashFunc);
+
+/**
+ * add an item to the tree, locking only its shard exclusively.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToShardedRBTree(ShardedRBTree *tree, void *data);
+
+/**
+ * remove an item from the tree, locking only its shard exclusively.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromShardedRBTree(ShardedRBTree *tree, void *data);
+
+/**
+ * check whether the tree contains this item, in parallel with the other readers of its shard.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int ShardedRBTreeContains(ShardedRBTree *tree, const void *data);
+
+/**
+ * @return: the number of items in all the shards (each shard is counted at a different moment).
+ */
+long unsigned ShardedRBTreeSize(ShardedRBTree *tree);
+
+/**
+ * Activate a function on each item of the tree in ascending order, by a k-way merge of the shards in
+ * O(n log k). all the shards are read locked during the traversal, so func must not change the tree.
+ * @return: 0 on failure, other on success.
+ */
+int forEachShardedRBTree(ShardedRBTree *tree, forEachFunc func, void *args);
+
+/**
+ * free all memory of the data structure. no other thread may use the tree any more.
+ * @param tree: pointer to the tree to free.
+ */
+void freeShardedRBTree(ShardedRBTree **tree);
+
+#endif //RBTREE_SHARDEDRBTREE_H
@@ -0,0 +1,61 @@
+#ifndef RBTREE_SPECIALIZEDTREES_H
+#define RBTREE_SPECIALIZEDTREES_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "Structs.h"
+#include "VectorKernels.h"
+#include "RBTreeSpecialize.h"
+
+/**
+ * stringCompare that the compiler can inline.
+ */
+static inline int stringCompareInline(const void *a, const void *b)
+{
+    return (a == NULL || b == NULL) ? 0 : strcmp(a, b);
+}
+
+
+/**
+ * freeString that the compiler can inline.
+ */
+static inline void freeStringInline(void *s)
+{
+    free(s);
+}
+
+
+/**
+ * vectorCompare1By1 that the compiler can inline.
+ */
+static inline int vectorCompareInline(const void *a, const void *b)
+{
+    const Vector *v1 = (const Vector *) a, *v2 = (const Vector *) b;
+    size_t minimalLength = v1->len > v2->len ? v2->len : v1->len;
+    size_t i = firstDifference(v1->vector, v2->vector, minimalLength);
+    if (i < minimalLength)
+    {
+        double result = v1->vector[i] - v2->vector[i];
+        return result > 0 ? 1 : (result < 0 ? -1 : 0);
+    }
+    return v1->len > v2->len ? 1 : (v1->len < v2->len ? -1 : 0);
+}
+
+
+/**
+ * freeVector that the compiler can inline.
+ */
+static inline void freeVectorInline(void *pVector)
+{
+    free(((Vector *) pVector)->vector);
+    free(pVector);
+}
+
+
+// stringTreeNew, stringTreeInsert, stringTreeDelete and stringTreeContains.
+RBTREE_SPECIALIZE(stringTree, stringCompareInline, freeStringInline)
+
+// vectorTreeNew, vectorTreeInsert, vectorTreeDelete and vectorTreeContains.
+RBTREE_SPECIALIZE(vectorTree, vectorCompareInline, freeVectorInline)
+
+#endif //RBTREE_SPECIALIZEDTREES_H
@@ -1,182 +1,496 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdbool.h>
-#include <string.h>
-#include "RBTree.h"
-#include "Structs.h"
-
-
-/**
- * check
- * @param str
- * @return
- */
-unsigned int stringLength(const char * str)
-{
-    unsigned int count = 0;
-    while ((char) str[count] != '\0')
-    {
-        count++;
-    }
-    return count;
-}
-
-
-/**
- * CompFunc for strings (assumes strings end with "\0")
- * @param a - char* pointer
- * @param b - char* pointer
- * @return equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a. (lexicographic
- * order)
- */
-int stringCompare(const void *a, const void *b)
-{
-    return (a == NULL || b == NULL) ? false : strcmp(a,b);
-}
-
-
-/**
- * ForEach function that concatenates the given word and \n to pConcatenated. pConcatenated is
- * already allocated with enough space.
- * @param word - char* to add to pConcatenated
- * @param pConcatenated - char*
- * @return 0 on failure, other on success
- */
-int concatenate(const void *word, void *pConcatenated)
-{
-    if (word == NULL || pConcatenated == NULL)
-    {
-        return false;
-    }
-    char * concatenated = (char *) pConcatenated;
-    const char * strToAdd = (char *) word;
-    unsigned int concatenatedLen = 0, strToAddLen = 0;
-    while (concatenated[concatenatedLen] != '\0')
-    {
-        concatenatedLen++;
-    }
-    while (strToAdd[strToAddLen] != '\0')
-    {
-        concatenated[concatenatedLen + strToAddLen] = strToAdd[strToAddLen];
-        strToAddLen++;
-    }
-    return true;
-}
-
-
-/**
- * FreeFunc for strings
- */
-void freeString(void *s)
-{
-    free(s);
-}
-
-
-double compareVectors(const Vector * v1, const Vector * v2)
-{
-    unsigned int minimalLength = v1->len > v2->len ? v2->len : v1->len;
-    for (unsigned int i = 0; i < minimalLength; ++i)
-    {
-        if (v1->vector[i] != v2->vector[i])
-        {
-            return (v1->vector[i] - v2->vector[i]);
-        }
-    }
-    return v1->len - v2->len;
-}
-
-
-
-/**
- * CompFunc for Vectors, compares element by element, the vector that has the first larger
- * element is considered larger. If vectors are of different lengths and identify for the length
- * of the shorter vector, the shorter vector is considered smaller.
- * @param a - first vector
- * @param b - second vector
- * @return equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a.
- */
-int vectorCompare1By1(const void *a, const void *b)
-{
-    double result = compareVectors((Vector *) a, (Vector *) b);
-    if (-1 < result && result < 1)
-    {
-        return result > 0 ? 1 : (result < 0 ? -1 : 0);
-    }
-    return (int) result;
-}
-
-
-/**
- * FreeFunc for vectors
- */
-void freeVector(void *pVector)
-{
-    free(((Vector *) pVector)->vector);
-    free(pVector);
-}
-
-
-long double normCalculator(Vector * v)
-{
-    long double sum = 0;
-    for (int i = 0; i < v->len; ++i)
-    {
-        sum += v->vector[i] * v->vector[i];
-    }
-    return sum;
-}
-
-
-void deepcopyVector(const Vector *pVector, Vector *pMaxVector)
-{
-    pMaxVector->len = pVector->len;
-    free(pMaxVector->vector);
-    pMaxVector->vector = realloc(pVector->vector, pVector->len * sizeof(double));
-}
-
-
-/**
- * copy pVector to pMaxVector if : 1. The norm of pVector is greater then the norm of pMaxVector.
- * 								   2. pMaxVector->vector == NULL.
- * @param pVector pointer to Vector
- * @param pMaxVector pointer to Vector that will hold a copy of the data of pVector.
- * @return 1 on success, 0 on failure (if pVector == NULL || pMaxVector==NULL: failure).
- */
-int copyIfNormIsLarger(const void *pVector, void *pMaxVector)
-{
-    if (pVector == NULL || pMaxVector==NULL)
-    {
-        return false;
-    }
-    long double pVectorNorm = normCalculator((Vector *) pVector);
-    long double pMaxVectorNorm = normCalculator((Vector *) pMaxVector);
-    if (pVectorNorm > pMaxVectorNorm)
-    {
-        deepcopyVector(pVector, pMaxVector);
-    }
-    return true;
-}
-
-
-/**
- * This function allocates memory it does not free.
- * @param tree a pointer to a tree of Vectors
- * @return pointer to a *copy* of the vector that has the largest norm (L2 Norm), NULL on failure.
- */
-Vector * findMaxNormVectorInTree(RBTree *tree)
-{
-    if (tree == NULL || tree->root == NULL)
-    {
-        return NULL;
-    }
-    Vector *resVector = NULL;
-    resVector = (Vector *) malloc(sizeof(Vector));
-    if (resVector == NULL)
-    {
-        return NULL;
-    }
-    resVector->len = 0;
-    forEachRBTree(tree, copyIfNormIsLarger, resVector);
-    return resVector;
-}
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include "RBTree.h"
+#include "Structs.h"
+#include "VectorKernels.h"
+
+/**
+ * the parameters of the 64 bit FNV-1a hash of stringHash and vectorHash.
+ */
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+
+/**
+ * check
+ * @param str
+ * @return
+ */
+unsigned int stringLength(const char * str)
+{
+    unsigned int count = 0;
+    while ((char) str[count] != '\0')
+    {
+        count++;
+    }
+    return count;
+}
+
+
+/**
+ * CompFunc for strings (assumes strings end with "\0")
+ * @param a - char* pointer
+ * @param b - char* pointer
+ * @return equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a. (lexicographic
+ * order)
+ */
+int stringCompare(const void *a, const void *b)
+{
+    return (a == NULL || b == NULL) ? false : strcmp(a,b);
+}
+
+
+/**
+ * ForEach function that concatenates the given word and \n to pConcatenated. pConcatenated is
+ * already allocated with enough space.
+ * @param word - char* to add to pConcatenated
+ * @param pConcatenated - char*
+ * @return 0 on failure, other on success
+ */
+int concatenate(const void *word, void *pConcatenated)
+{
+    if (word == NULL || pConcatenated == NULL)
+    {
+        return false;
+    }
+    char * concatenated = (char *) pConcatenated;
+    const char * strToAdd = (char *) word;
+    unsigned int concatenatedLen = 0, strToAddLen = 0;
+    while (concatenated[concatenatedLen] != '\0')
+    {
+        concatenatedLen++;
+    }
+    while (strToAdd[strToAddLen] != '\0')
+    {
+        concatenated[concatenatedLen + strToAddLen] = strToAdd[strToAddLen];
+        strToAddLen++;
+    }
+    concatenated[concatenatedLen + strToAddLen] = '\n';
+    concatenated[concatenatedLen + strToAddLen + 1] = '\0';
+    return true;
+}
+
+
+/**
+ * FreeFunc for strings
+ */
+void freeString(void *s)
+{
+    free(s);
+}
+
+
+/**
+ * HashFunc for strings: FNV-1a of the bytes of the string.
+ * @param s - char* pointer
+ * @return the hash, equal for strings that stringCompare finds equal.
+ */
+size_t stringHash(const void *s)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (const unsigned char *c = (const unsigned char *) s; *c != '\0'; ++c)
+    {
+        hash = (hash ^ *c) * FNV_PRIME;
+    }
+    return (size_t) hash;
+}
+
+
+double compareVectors(const Vector * v1, const Vector * v2)
+{
+    size_t minimalLength = v1->len > v2->len ? v2->len : v1->len;
+    size_t i = firstDifference(v1->vector, v2->vector, minimalLength);
+    if (i < minimalLength)
+    {
+        return (v1->vector[i] - v2->vector[i]);
+    }
+    return v1->len - v2->len;
+}
+
+
+
+/**
+ * SizeFunc for strings (see setRBTreeSizeFunc): the length of the string, without the "\0".
+ */
+size_t stringSize(const void *s)
+{
+    return strlen((const char *) s);
+}
+
+
+/**
+ * the state of serializeStrings and writeStrings: the buffer, the end of what was written to it so far and
+ * the file descriptor to flush it to (-1 for serializeStrings).
+ */
+typedef struct StringWriter
+{
+    char *buffer;
+    size_t offset, capacity;
+    const char *separator;
+    size_t separatorLength;
+    int fd;
+} StringWriter;
+
+
+/**
+ * ForEach function that adds the length of the string and the separator to the offset of pWriter.
+ */
+int addSerializedLength(const void *word, void *pWriter)
+{
+    StringWriter *writer = (StringWriter *) pWriter;
+    writer->offset += strlen((const char *) word) + writer->separatorLength;
+    return true;
+}
+
+
+/**
+ * the length of the output of serializeStrings, without the final "\0".
+ * @param tree - a tree of strings
+ * @param separator - the string written after each string of the tree
+ */
+size_t serializedStringsLength(const RBTree *tree, const char *separator)
+{
+    if (tree == NULL || separator == NULL)
+    {
+        return 0;
+    }
+    StringWriter writer = {NULL, 0, 0, separator, strlen(separator), -1};
+    if (tree->sizeFunc == stringSize)
+    {
+        return tree->dataBytes + tree->size * writer.separatorLength;
+    }
+    forEachRBTree(tree, addSerializedLength, &writer);
+    return writer.offset;
+}
+
+
+/**
+ * write all of bytes to fd, retrying interrupted and partial writes.
+ * @return false on failure, true otherwise.
+ */
+bool writeAll(int fd, const char *bytes, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t written = write(fd, bytes, length);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            return false;
+        }
+        bytes += written;
+        length -= (size_t) written;
+    }
+    return true;
+}
+
+
+/**
+ * write the buffer of writer to its file descriptor and empty it.
+ * @return false on failure, true otherwise.
+ */
+bool flushWriter(StringWriter *writer)
+{
+    bool written = writeAll(writer->fd, writer->buffer, writer->offset);
+    writer->offset = 0;
+    return written;
+}
+
+
+/**
+ * add bytes to the buffer of writer, flushing it first to its file descriptor if they do not fit. bytes that
+ * do not fit in an empty buffer are written directly.
+ * @return false on failure (of a write, or of a buffer without a file descriptor that is too small).
+ */
+bool appendBytes(StringWriter *writer, const char *bytes, size_t length)
+{
+    if (writer->offset + length > writer->capacity)
+    {
+        if (writer->fd < 0 || !flushWriter(writer))
+        {
+            return false;
+        }
+        if (length > writer->capacity)
+        {
+            return writeAll(writer->fd, bytes, length);
+        }
+    }
+    memcpy(writer->buffer + writer->offset, bytes, length);
+    writer->offset += length;
+    return true;
+}
+
+
+/**
+ * ForEach function that appends the string and the separator to pWriter, a StringWriter.
+ */
+int appendString(const void *word, void *pWriter)
+{
+    StringWriter *writer = (StringWriter *) pWriter;
+    return appendBytes(writer, (const char *) word, strlen((const char *) word)) &&
+           appendBytes(writer, writer->separator, writer->separatorLength);
+}
+
+
+/**
+ * write all the strings of the tree, in ascending order and each followed by separator, into a new buffer of
+ * exactly the right size, in one pass.
+ * @param tree - a tree of strings
+ * @param separator - the string written after each string of the tree, for example "\n"
+ * @return the new "\0" terminated buffer, NULL on failure.
+ */
+char *serializeStrings(const RBTree *tree, const char *separator)
+{
+    if (tree == NULL || separator == NULL)
+    {
+        return NULL;
+    }
+    size_t length = serializedStringsLength(tree, separator);
+    StringWriter writer = {(char *) malloc(length + 1), 0, length, separator, strlen(separator), -1};
+    if (writer.buffer == NULL)
+    {
+        return NULL;
+    }
+    if (!forEachRBTree(tree, appendString, &writer))
+    {
+        free(writer.buffer);
+        return NULL;
+    }
+    writer.buffer[writer.offset] = '\0';
+    return writer.buffer;
+}
+
+
+/**
+ * write all the strings of the tree, in ascending order and each followed by separator, to a file descriptor
+ * in chunks of SERIALIZE_CHUNK_BYTES.
+ * @param tree - a tree of strings
+ * @param separator - the string written after each string of the tree
+ * @param fd - an open file descriptor
+ * @return 0 on failure (the output may be partly written), other on success.
+ */
+int writeStrings(const RBTree *tree, const char *separator, int fd)
+{
+    if (tree == NULL || separator == NULL || fd < 0)
+    {
+        return false;
+    }
+    StringWriter writer = {(char *) malloc(SERIALIZE_CHUNK_BYTES), 0, SERIALIZE_CHUNK_BYTES, separator,
+                           strlen(separator), fd};
+    if (writer.buffer == NULL)
+    {
+        return false;
+    }
+    bool written = forEachRBTree(tree, appendString, &writer) && flushWriter(&writer);
+    free(writer.buffer);
+    return written;
+}
+
+
+/**
+ * CompFunc for Vectors, compares element by element, the vector that has the first larger
+ * element is considered larger. If vectors are of different lengths and identify for the length
+ * of the shorter vector, the shorter vector is considered smaller.
+ * @param a - first vector
+ * @param b - second vector
+ * @return equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a.
+ */
+int vectorCompare1By1(const void *a, const void *b)
+{
+    double result = compareVectors((Vector *) a, (Vector *) b);
+    return result > 0 ? 1 : (result < 0 ? -1 : 0);
+}
+
+
+/**
+ * FreeFunc for vectors
+ */
+void freeVector(void *pVector)
+{
+    free(((Vector *) pVector)->vector);
+    free(pVector);
+}
+
+
+/**
+ * HashFunc for Vectors: FNV-1a of the length and the elements of the vector.
+ * @param pVector - pointer to Vector
+ * @return the hash, equal for vectors that vectorCompare1By1 finds equal (0.0 and -0.0 hash alike).
+ */
+size_t vectorHash(const void *pVector)
+{
+    const Vector *v = (const Vector *) pVector;
+    uint64_t hash = (FNV_OFFSET_BASIS ^ (uint64_t) (unsigned int) v->len) * FNV_PRIME;
+    for (int i = 0; i < v->len; ++i)
+    {
+        double element = v->vector[i] == 0 ? 0 : v->vector[i];
+        uint64_t bits;
+        memcpy(&bits, &element, sizeof(bits));
+        for (int byte = 0; byte < 8; ++byte)
+        {
+            hash = (hash ^ ((bits >> (8 * byte)) & 0xff)) * FNV_PRIME;
+        }
+    }
+    return (size_t) hash;
+}
+
+
+/**
+ * allocate a Vector and its elements in one block (a ContiguousVector).
+ * @param len - number of elements, not initialized.
+ * @return the new Vector, to free with freeContiguousVector. NULL on failure.
+ */
+Vector *newContiguousVector(int len)
+{
+    ContiguousVector *v = (ContiguousVector *) malloc(sizeof(ContiguousVector) + len * sizeof(double));
+    if (v == NULL)
+    {
+        return NULL;
+    }
+    v->header.len = len;
+    v->header.vector = v->elements;
+    return &v->header;
+}
+
+
+/**
+ * FreeFunc for Vectors made by newContiguousVector
+ */
+void freeContiguousVector(void *pVector)
+{
+    free(pVector);
+}
+
+
+/**
+ * make a Vector over elements that are already in memory, without copying them.
+ * @param elements - the elements, owned by the caller. they must outlive the Vector.
+ * @param len - number of elements.
+ * @return the new Vector, to free with freeVectorView (which leaves elements alone). NULL on failure.
+ */
+Vector *newVectorView(double *elements, int len)
+{
+    Vector *v = (Vector *) malloc(sizeof(Vector));
+    if (v == NULL)
+    {
+        return NULL;
+    }
+    v->len = len;
+    v->vector = elements;
+    return v;
+}
+
+
+/**
+ * FreeFunc for Vectors made by newVectorView
+ */
+void freeVectorView(void *pVector)
+{
+    free(pVector);
+}
+
+
+long double normCalculator(Vector * v)
+{
+    return sumOfSquares(v->vector, v->len);
+}
+
+
+/**
+ * WeightFunc for Vectors (see setRBTreeWeightFunc): the squared L2 norm of the vector.
+ * @param pVector - pointer to Vector
+ * @return the sum of the squares of the elements of the vector.
+ */
+long double vectorSquaredNorm(const void *pVector)
+{
+    return normCalculator((Vector *) pVector);
+}
+
+
+/**
+ * copy the elements of pVector into pMaxVector, reusing the memory of pMaxVector.
+ * @return: false on allocation failure (pMaxVector is unchanged), true otherwise.
+ */
+bool deepcopyVector(const Vector *pVector, Vector *pMaxVector)
+{
+    double *elements = (double *) realloc(pMaxVector->vector, (pVector->len > 0 ? pVector->len : 1) * sizeof(double));
+    if (elements == NULL)
+    {
+        return false;
+    }
+    memcpy(elements, pVector->vector, pVector->len * sizeof(double));
+    pMaxVector->vector = elements;
+    pMaxVector->len = pVector->len;
+    return true;
+}
+
+
+/**
+ * copy pVector to pMaxVector if : 1. The norm of pVector is greater then the norm of pMaxVector.
+ * 								   2. pMaxVector->vector == NULL.
+ * @param pVector pointer to Vector
+ * @param pMaxVector pointer to Vector that will hold a copy of the data of pVector.
+ * @return 1 on success, 0 on failure (if pVector == NULL || pMaxVector==NULL: failure).
+ */
+int copyIfNormIsLarger(const void *pVector, void *pMaxVector)
+{
+    if (pVector == NULL || pMaxVector==NULL)
+    {
+        return false;
+    }
+    long double pVectorNorm = normCalculator((Vector *) pVector);
+    long double pMaxVectorNorm = normCalculator((Vector *) pMaxVector);
+    if (((Vector *) pMaxVector)->vector == NULL || pVectorNorm > pMaxVectorNorm)
+    {
+        return deepcopyVector(pVector, pMaxVector);
+    }
+    return true;
+}
+
+
+/**
+ * This function allocates memory it does not free.
+ * @param tree a pointer to a tree of Vectors
+ * @return pointer to a *copy* of the vector that has the largest norm (L2 Norm), NULL on failure.
+ */
+Vector * findMaxNormVectorInTree(RBTree *tree)
+{
+    if (tree == NULL || tree->root == NULL)
+    {
+        return NULL;
+    }
+    Vector *resVector = NULL;
+    resVector = (Vector *) malloc(sizeof(Vector));
+    if (resVector == NULL)
+    {
+        return NULL;
+    }
+    resVector->len = 0;
+    resVector->vector = NULL;
+#ifdef RBTREE_MAX_WEIGHT
+    if (tree->weightFunc == vectorSquaredNorm) // the tree keeps its heaviest vector
+    {
+        if (!copyIfNormIsLarger(RBTreeMaxWeight(tree), resVector))
+        {
+            freeVector(resVector);
+            return NULL;
+        }
+        return resVector;
+    }
+#endif
+    if (!forEachRBTree(tree, copyIfNormIsLarger, resVector))
+    {
+        freeVector(resVector);
+        return NULL;
+    }
+    return resVector;
+}
@@ -1,75 +1,172 @@
-//
-// Created by evyat on 10/13/2019.
-//
-
-#include "RBTree.h"
-
-#ifndef TA_EX3_STRUCTS_H
-#define TA_EX3_STRUCTS_H
-
-/**
- * Represents a vector. The double* should be dynamically allocated
- */
-typedef struct Vector
-{
-	int len;
-	double *vector;
-} Vector;
-
-
-/**
- * CompFunc for strings (assumes strings end with "\0")
- * @param a - char* pointer
- * @param b - char* pointer
- * @return equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a. (lexicographic
- * order)
- */
-int stringCompare(const void *a, const void *b); // implement it in Structs.c
-
-/**
- * ForEach function that concatenates the given word and \n to pConcatenated. pConcatenated is
- * already allocated with enough space.
- * @param word - char* to add to pConcatenated
- * @param pConcatenated - char*
- * @return 0 on failure, other on success
- */
-int concatenate(const void *word, void *pConcatenated); // implement it in Structs.c
-
-/**
- * FreeFunc for strings
- */
-void freeString(void *s); // implement it in Structs.c
-
-/**
- * CompFunc for Vectors, compares element by element, the vector that has the first larger
- * element is considered larger. If vectors are of different lengths and identify for the length
- * of the shorter vector, the shorter vector is considered smaller.
- * @param a - first vector
- * @param b - second vector
- * @return equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a.
- */
-int vectorCompare1By1(const void *a, const void *b); // implement it in Structs.c
-
-/**
- * FreeFunc for vectors
- */
-void freeVector(void *pVector); // implement it in Structs.c
-
-/**
- * copy pVector to pMaxVector if : 1. The norm of pVector is greater then the norm of pMaxVector.
- * 								   2. pMaxVector->vector == NULL.
- * @param pVector pointer to Vector
- * @param pMaxVector pointer to Vector that will hold a copy of the data of pVector.
- * @return 1 on success, 0 on failure (if pVector == NULL || pMaxVector==NULL: failure).
- */
-int copyIfNormIsLarger(const void *pVector, void *pMaxVector); // implement it in Structs.c
-
-/**
- * This function allocates memory it does not free.
- * @param tree a pointer to a tree of Vectors
- * @return pointer to a *copy* of the vector that has the largest norm (L2 Norm), NULL on failure.
- */
-Vector *findMaxNormVectorInTree(RBTree *tree); // implement it in Structs.c You must use copyIfNormIsLarger in the implementation!
-
-
-#endif //TA_EX3_STRUCTS_H
+//
+// Created by evyat on 10/13/2019.
+//
+
+#include "RBTree.h"
+
+#ifndef TA_EX3_STRUCTS_H
+#define TA_EX3_STRUCTS_H
+
+/**
+ * Represents a vector. The double* should be dynamically allocated
+ */
+typedef struct Vector
+{
+	int len;
+	double *vector;
+} Vector;
+
+
+/**
+ * a Vector and its elements in a single allocation (the vector of the header points at elements), so a compare
+ * reads the length and the first elements from the same cache line. it is used through its header, as any
+ * Vector.
+ */
+typedef struct ContiguousVector
+{
+	Vector header;
+	double elements[];
+} ContiguousVector;
+
+
+/**
+ * CompFunc for strings (assumes strings end with "\0")
+ * @param a - char* pointer
+ * @param b - char* pointer
+ * @return equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a. (lexicographic
+ * order)
+ */
+int stringCompare(const void *a, const void *b); // implement it in Structs.c
+
+/**
+ * ForEach function that concatenates the given word and \n to pConcatenated. pConcatenated is
+ * already allocated with enough space. each call scans pConcatenated from its start, so serializeStrings
+ * should be used for large trees.
+ * @param word - char* to add to pConcatenated
+ * @param pConcatenated - char*
+ * @return 0 on failure, other on success
+ */
+int concatenate(const void *word, void *pConcatenated); // implement it in Structs.c
+
+/**
+ * FreeFunc for strings
+ */
+void freeString(void *s); // implement it in Structs.c
+
+/**
+ * HashFunc for strings (see newShardedRBTree): FNV-1a of the bytes of the string.
+ * @param s - char* pointer
+ * @return the hash, equal for strings that stringCompare finds equal.
+ */
+size_t stringHash(const void *s);
+
+/**
+ * number of bytes writeStrings buffers before each write.
+ */
+#define SERIALIZE_CHUNK_BYTES (64 * 1024)
+
+/**
+ * SizeFunc for strings (see setRBTreeSizeFunc): the length of the string, without the "\0".
+ */
+size_t stringSize(const void *s);
+
+/**
+ * the length of the output of serializeStrings, without the final "\0". O(1) if the tree tracks the sizes of
+ * its strings with stringSize, O(n) otherwise.
+ * @param tree - a tree of strings
+ * @param separator - the string written after each string of the tree
+ */
+size_t serializedStringsLength(const RBTree *tree, const char *separator);
+
+/**
+ * write all the strings of the tree, in ascending order and each followed by separator, into a new buffer of
+ * exactly the right size, in one pass.
+ * @param tree - a tree of strings
+ * @param separator - the string written after each string of the tree, for example "\n"
+ * @return the new "\0" terminated buffer, NULL on failure.
+ */
+char *serializeStrings(const RBTree *tree, const char *separator);
+
+/**
+ * write all the strings of the tree, in ascending order and each followed by separator, to a file descriptor
+ * in chunks of SERIALIZE_CHUNK_BYTES.
+ * @param tree - a tree of strings
+ * @param separator - the string written after each string of the tree
+ * @param fd - an open file descriptor
+ * @return 0 on failure (the output may be partly written), other on success.
+ */
+int writeStrings(const RBTree *tree, const char *separator, int fd);
+
+/**
+ * CompFunc for Vectors, compares element by element, the vector that has the first larger
+ * element is considered larger. If vectors are of different lengths and identify for the length
+ * of the shorter vector, the shorter vector is considered smaller.
+ * @param a - first vector
+ * @param b - second vector
+ * @return equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a.
+ */
+int vectorCompare1By1(const void *a, const void *b); // implement it in Structs.c
+
+/**
+ * FreeFunc for vectors
+ */
+void freeVector(void *pVector); // implement it in Structs.c
+
+/**
+ * HashFunc for Vectors (see newShardedRBTree): FNV-1a of the length and the elements of the vector.
+ * @param pVector - pointer to Vector
+ * @return the hash, equal for vectors that vectorCompare1By1 finds equal (0.0 and -0.0 hash alike).
+ */
+size_t vectorHash(const void *pVector);
+
+/**
+ * WeightFunc for Vectors (see setRBTreeWeightFunc): the squared L2 norm of the vector. trees of Vectors that
+ * use it answer findMaxNormVectorInTree in O(1) when built with RBTREE_MAX_WEIGHT.
+ * @param pVector - pointer to Vector
+ * @return the sum of the squares of the elements of the vector.
+ */
+long double vectorSquaredNorm(const void *pVector);
+
+/**
+ * allocate a Vector and its elements in one block (a ContiguousVector).
+ * @param len - number of elements, not initialized.
+ * @return the new Vector, to free with freeContiguousVector. NULL on failure.
+ */
+Vector *newContiguousVector(int len);
+
+/**
+ * FreeFunc for Vectors made by newContiguousVector
+ */
+void freeContiguousVector(void *pVector);
+
+/**
+ * make a Vector over elements that are already in memory, without copying them.
+ * @param elements - the elements, owned by the caller. they must outlive the Vector.
+ * @param len - number of elements.
+ * @return the new Vector, to free with freeVectorView (which leaves elements alone). NULL on failure.
+ */
+Vector *newVectorView(double *elements, int len);
+
+/**
+ * FreeFunc for Vectors made by newVectorView
+ */
+void freeVectorView(void *pVector);
+
+/**
+ * copy pVector to pMaxVector if : 1. The norm of pVector is greater then the norm of pMaxVector.
+ * 								   2. pMaxVector->vector == NULL.
+ * @param pVector pointer to Vector
+ * @param pMaxVector pointer to Vector that will hold a copy of the data of pVector.
+ * @return 1 on success, 0 on failure (if pVector == NULL || pMaxVector==NULL: failure).
+ */
+int copyIfNormIsLarger(const void *pVector, void *pMaxVector); // implement it in Structs.c
+
+/**
+ * This function allocates memory it does not free.
+ * @param tree a pointer to a tree of Vectors
+ * @return pointer to a *copy* of the vector that has the largest norm (L2 Norm), NULL on failure.
+ */
+Vector *findMaxNormVectorInTree(RBTree *tree); // implement it in Structs.c You must use copyIfNormIsLarger in the implementation!
+
+
+#endif //TA_EX3_STRUCTS_H
@@ -0,0 +1,174 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "VectorArena.h"
+
+/**
+ * the hidden header of each block: the size class of the block, NULL for blocks allocated with malloc. while
+ * the block is free it holds the next free block instead.
+ */
+typedef union VectorBlockHeader
+{
+    VectorSizeClass *sizeClass;
+    void *nextFree;
+} VectorBlockHeader;
+
+
+/**
+ * @return: the bytes of a block holding a vector of len elements.
+ */
+size_t vectorBlockBytes(int len)
+{
+    size_t bytes = sizeof(VectorBlockHeader) + sizeof(ContiguousVector) + (size_t) len * sizeof(double);
+    return (bytes + VECTOR_ARENA_ALIGNMENT - 1) / VECTOR_ARENA_ALIGNMENT * VECTOR_ARENA_ALIGNMENT;
+}
+
+
+/**
+ * constructs a new empty VectorArena.
+ * @return: the new arena, NULL on failure.
+ */
+VectorArena *newVectorArena(void)
+{
+    VectorArena *arena = (VectorArena *) malloc(sizeof(VectorArena));
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+    for (size_t i = 0; i < VECTOR_ARENA_CLASSES; ++i)
+    {
+        VectorSizeClass *sizeClass = &arena->classes[i];
+        sizeClass->blockBytes = i * VECTOR_ARENA_ALIGNMENT;
+        sizeClass->blocksPerSlab = i == 0 ? 0 : VECTOR_ARENA_SLAB_BYTES / sizeClass->blockBytes;
+        sizeClass->blocksPerSlab = sizeClass->blocksPerSlab == 0 ? 1 : sizeClass->blocksPerSlab;
+        sizeClass->slabs = NULL;
+        sizeClass->freeList = NULL;
+    }
+    return arena;
+}
+
+
+/**
+ * add a new slab in front of the slabs list of a size class.
+ * @param sizeClass: the size class to add a slab to.
+ * @return: the new slab, NULL on failure.
+ */
+VectorArenaSlab *addVectorSlab(VectorSizeClass *sizeClass)
+{
+    VectorArenaSlab *slab = (VectorArenaSlab *) malloc(sizeof(VectorArenaSlab) + VECTOR_ARENA_ALIGNMENT +
+                                                       sizeClass->blocksPerSlab * sizeClass->blockBytes);
+    if (slab == NULL)
+    {
+        return NULL;
+    }
+    uintptr_t first = (uintptr_t) (slab + 1);
+    slab->blocks = (void *) ((first + VECTOR_ARENA_ALIGNMENT - 1) / VECTOR_ARENA_ALIGNMENT * VECTOR_ARENA_ALIGNMENT);
+    slab->used = 0;
+    slab->next = sizeClass->slabs;
+    sizeClass->slabs = slab;
+    return slab;
+}
+
+
+/**
+ * take a block from a size class.
+ * @return: the block, NULL on failure.
+ */
+VectorBlockHeader *allocateVectorBlock(VectorSizeClass *sizeClass)
+{
+    if (sizeClass->freeList != NULL)
+    {
+        VectorBlockHeader *block = (VectorBlockHeader *) sizeClass->freeList;
+        sizeClass->freeList = block->nextFree;
+        return block;
+    }
+    VectorArenaSlab *slab = sizeClass->slabs;
+    if ((slab == NULL || slab->used == sizeClass->blocksPerSlab) && (slab = addVectorSlab(sizeClass)) == NULL)
+    {
+        return NULL;
+    }
+    return (VectorBlockHeader *) ((char *) slab->blocks + sizeClass->blockBytes * slab->used++);
+}
+
+
+/**
+ * allocate a Vector and its elements in one block of the arena.
+ * @param arena: the arena to allocate from.
+ * @param len: number of elements, not initialized.
+ * @return: the new Vector, to free with freeArenaVector. NULL on failure.
+ */
+Vector *allocateArenaVector(VectorArena *arena, int len)
+{
+    if (arena == NULL || len < 0)
+    {
+        return NULL;
+    }
+    VectorBlockHeader *block;
+    if (len > VECTOR_ARENA_MAX_ELEMENTS)
+    {
+        if ((block = (VectorBlockHeader *) malloc(vectorBlockBytes(len))) == NULL)
+        {
+            return NULL;
+        }
+        block->sizeClass = NULL;
+    }
+    else
+    {
+        VectorSizeClass *sizeClass = &arena->classes[vectorBlockBytes(len) / VECTOR_ARENA_ALIGNMENT];
+        if ((block = allocateVectorBlock(sizeClass)) == NULL)
+        {
+            return NULL;
+        }
+        block->sizeClass = sizeClass;
+    }
+    ContiguousVector *v = (ContiguousVector *) (block + 1);
+    v->header.len = len;
+    v->header.vector = v->elements;
+    return &v->header;
+}
+
+
+/**
+ * FreeFunc for Vectors made by allocateArenaVector: return the block to its size class.
+ */
+void freeArenaVector(void *pVector)
+{
+    if (pVector == NULL)
+    {
+        return;
+    }
+    VectorBlockHeader *block = (VectorBlockHeader *) pVector - 1;
+    VectorSizeClass *sizeClass = block->sizeClass;
+    if (sizeClass == NULL)
+    {
+        free(block);
+        return;
+    }
+    block->nextFree = sizeClass->freeList;
+    sizeClass->freeList = block;
+}
+
+
+/**
+ * free all the slabs of the arena at once. all the vectors allocated from it become invalid (vectors larger
+ * than VECTOR_ARENA_MAX_ELEMENTS are not in slabs, and must be freed with freeArenaVector before).
+ * @param arena: pointer to the arena to free.
+ */
+void freeVectorArena(VectorArena **arena)
+{
+    if (arena == NULL || (*arena) == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < VECTOR_ARENA_CLASSES; ++i)
+    {
+        VectorArenaSlab *slab = (*arena)->classes[i].slabs;
+        while (slab != NULL)
+        {
+            VectorArenaSlab *next = slab->next;
+            free(slab);
+            slab = next;
+        }
+    }
+    free(*arena);
+    (*arena) = NULL;
+}
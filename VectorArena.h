@@ -0,0 +1,87 @@
+#ifndef RBTREE_VECTORARENA_H
+#define RBTREE_VECTORARENA_H
+
+#include <stddef.h>
+#include "Structs.h"
+
+/**
+ * the blocks of an arena are multiples of this size (a cache line).
+ */
+#define VECTOR_ARENA_ALIGNMENT 64
+
+/**
+ * vectors with more elements than this are allocated with malloc (still in one block).
+ */
+#define VECTOR_ARENA_MAX_ELEMENTS 1024
+
+/**
+ * the bytes of each slab of a size class (a slab holds at least one block).
+ */
+#define VECTOR_ARENA_SLAB_BYTES (256 * 1024)
+
+/**
+ * number of size classes: one for each multiple of VECTOR_ARENA_ALIGNMENT up to the largest block.
+ */
+#define VECTOR_ARENA_CLASSES \
+	((sizeof(void *) + sizeof(ContiguousVector) + VECTOR_ARENA_MAX_ELEMENTS * sizeof(double) + \
+	  VECTOR_ARENA_ALIGNMENT - 1) / VECTOR_ARENA_ALIGNMENT + 1)
+
+/*
+ * a slab of blocks of one size class, allocated in one malloc.
+ */
+typedef struct VectorArenaSlab
+{
+	struct VectorArenaSlab *next;
+	size_t used;
+	void *blocks; // the first block, aligned to VECTOR_ARENA_ALIGNMENT.
+} VectorArenaSlab;
+
+/*
+ * the blocks of one size. free blocks are linked through their first word.
+ */
+typedef struct VectorSizeClass
+{
+	size_t blockBytes;
+	size_t blocksPerSlab;
+	VectorArenaSlab *slabs;
+	void *freeList;
+} VectorSizeClass;
+
+/**
+ * a size class allocator of ContiguousVectors, so that the vectors of a large tree are packed densely in a few
+ * large slabs. each block starts with a hidden pointer to its size class, followed by the ContiguousVector, so
+ * freeArenaVector can be the FreeFunc of a tree. not thread safe; all the slabs are released together.
+ */
+typedef struct VectorArena
+{
+	VectorSizeClass classes[VECTOR_ARENA_CLASSES];
+} VectorArena;
+
+/**
+ * constructs a new empty VectorArena.
+ * @return: the new arena, NULL on failure.
+ */
+VectorArena *newVectorArena(void);
+
+/**
+ * allocate a Vector and its elements in one block of the arena.
+ * @param arena: the arena to allocate from.
+ * @param len: number of elements, not initialized.
+ * @return: the new Vector, to free with freeArenaVector. NULL on failure.
+ */
+Vector *allocateArenaVector(VectorArena *arena, int len);
+
+/**
+ * FreeFunc for Vectors made by allocateArenaVector: return the block to its size class. the arena must still
+ * be alive.
+ */
+void freeArenaVector(void *pVector);
+
+/**
+ * free all the slabs of the arena at once. all the vectors allocated from it become invalid (vectors larger
+ * than VECTOR_ARENA_MAX_ELEMENTS are not in slabs, and must be freed with freeArenaVector before).
+ * @param arena: pointer to the arena to free.
+ */
+void freeVectorArena(VectorArena **arena);
+
+#endif //RBTREE_VECTORARENA_H
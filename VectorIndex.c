@@ -0,0 +1,525 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "VectorIndex.h"
+
+
+/**
+ * @return: the L2 distance between two vectors, the shorter one padded with zeros.
+ */
+double vectorDistance(const Vector *a, const Vector *b)
+{
+    const Vector *longer = a->len >= b->len ? a : b, *shorter = a->len >= b->len ? b : a;
+    double sum = 0;
+    int i = 0;
+    for (; i < shorter->len; ++i)
+    {
+        double difference = a->vector[i] - b->vector[i];
+        sum += difference * difference;
+    }
+    for (; i < longer->len; ++i)
+    {
+        sum += longer->vector[i] * longer->vector[i];
+    }
+    return sqrt(sum);
+}
+
+
+/**
+ * swap two points and their distances.
+ */
+void swapPoints(const Vector **points, double *distances, size_t a, size_t b)
+{
+    const Vector *point = points[a];
+    points[a] = points[b];
+    points[b] = point;
+    double distance = distances[a];
+    distances[a] = distances[b];
+    distances[b] = distance;
+}
+
+
+/**
+ * reorder points (and their distances along with them) so that the k-th smallest distance is at k, the ones up
+ * to it before it and the ones from it on after it (quickselect, with a three way partition for equal distances).
+ */
+void selectByDistance(const Vector **points, double *distances, size_t n, size_t k)
+{
+    size_t low = 0, high = n;
+    while (high - low > 1)
+    {
+        double pivot = distances[low + (high - low) / 2];
+        size_t less = low, i = low, greater = high; // [low, less) < pivot, [greater, high) > pivot.
+        while (i < greater)
+        {
+            if (distances[i] < pivot)
+            {
+                swapPoints(points, distances, less++, i++);
+            }
+            else if (distances[i] > pivot)
+            {
+                swapPoints(points, distances, i, --greater);
+            }
+            else
+            {
+                i++;
+            }
+        }
+        if (k < less)
+        {
+            high = less;
+        }
+        else if (k >= greater)
+        {
+            low = greater;
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+
+/**
+ * build the vantage point tree of points into nodes, in preorder.
+ * @param count: the number of nodes used so far, updated.
+ * @param distances: space for n distances.
+ * @return: the index of the root of the sub tree of points.
+ */
+size_t buildVantage(VectorIndex *index, VantageNode *nodes, size_t *count, const Vector **points, double *distances,
+                    size_t n)
+{
+    index->seed = index->seed * 1103515245u + 12345u;
+    size_t chosen = (index->seed >> 8) % n;
+    const Vector *vantage = points[chosen];
+    points[chosen] = points[0];
+    points[0] = vantage;
+    size_t node = (*count)++;
+    nodes[node] = (VantageNode) {vantage, 0, 0, 0, false};
+    if (n == 1)
+    {
+        return node;
+    }
+    for (size_t i = 1; i < n; ++i)
+    {
+        distances[i] = vectorDistance(vantage, points[i]);
+    }
+    // the median of the others is the last one inside, so the inside sub tree is never empty.
+    size_t median = (n - 2) / 2;
+    selectByDistance(points + 1, distances + 1, n - 1, median);
+    nodes[node].radius = distances[1 + median];
+    nodes[node].inside = buildVantage(index, nodes, count, points + 1, distances + 1, median + 1);
+    if (n - 2 - median > 0)
+    {
+        nodes[node].outside = buildVantage(index, nodes, count, points + 2 + median, distances + 2 + median,
+                                           n - 2 - median);
+    }
+    return node;
+}
+
+
+/**
+ * free the copies of the deleted vectors that are kept as vantage points.
+ */
+void freeDeletedCopies(VantageNode *nodes, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (nodes[i].deleted)
+        {
+            freeContiguousVector((void *) nodes[i].point);
+        }
+    }
+}
+
+
+/**
+ * the state of rebuildVectorIndex while it collects the vectors of the tree.
+ */
+typedef struct PointCollector
+{
+    const Vector **points;
+    size_t count;
+} PointCollector;
+
+
+/**
+ * ForEach function of rebuildVectorIndex: keep the vector.
+ */
+int collectPoint(const void *v, void *pCollector)
+{
+    PointCollector *collector = (PointCollector *) pCollector;
+    collector->points[collector->count++] = (const Vector *) v;
+    return true;
+}
+
+
+/**
+ * build the index again from the vectors of the tree, in O(n log n) distances.
+ * @param index: the index to build.
+ * @return: 0 on failure (the index is not changed), other on success.
+ */
+int rebuildVectorIndex(VectorIndex *index)
+{
+    if (index == NULL)
+    {
+        return false;
+    }
+    size_t n = index->tree->size, count = 0;
+    VantageNode *nodes = (VantageNode *) malloc((n == 0 ? 1 : n) * sizeof(VantageNode));
+    PointCollector collector = {(const Vector **) malloc((n == 0 ? 1 : n) * sizeof(Vector *)), 0};
+    double *distances = (double *) malloc((n == 0 ? 1 : n) * sizeof(double));
+    if (nodes == NULL || collector.points == NULL || distances == NULL ||
+        !forEachRBTree(index->tree, collectPoint, &collector))
+    {
+        free(nodes);
+        free(collector.points);
+        free(distances);
+        return false;
+    }
+    if (n > 0)
+    {
+        buildVantage(index, nodes, &count, collector.points, distances, n);
+    }
+    free(collector.points);
+    free(distances);
+    freeDeletedCopies(index->nodes, index->nodeCount);
+    free(index->nodes);
+    index->nodes = nodes;
+    index->nodeCount = count;
+    index->deletedCount = 0;
+    index->pendingCount = 0;
+    return true;
+}
+
+
+/**
+ * constructs a new index of the Vectors of a tree, in O(n log n) distances.
+ * @param tree: a tree of Vectors (see vectorCompare1By1), not owned by the index.
+ * @return: the new index, NULL on failure.
+ */
+VectorIndex *newVectorIndex(RBTree *tree)
+{
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    VectorIndex *index = (VectorIndex *) malloc(sizeof(VectorIndex));
+    if (index == NULL)
+    {
+        return NULL;
+    }
+    index->tree = tree;
+    index->nodes = NULL;
+    index->nodeCount = 0;
+    index->deletedCount = 0;
+    index->pending = NULL;
+    index->pendingCount = 0;
+    index->pendingCapacity = 0;
+    index->seed = 1;
+    if (!rebuildVectorIndex(index))
+    {
+        free(index);
+        return NULL;
+    }
+    return index;
+}
+
+
+/**
+ * add a Vector to the tree and to the pending vectors of the index, and rebuild the index if there are too many
+ * of them.
+ * @param index: the index to add the vector to.
+ * @param v: the vector to add, owned by the tree on success.
+ * @return: 0 on failure, other on success. (if the vector is already in the tree - failure).
+ */
+int insertToVectorIndex(VectorIndex *index, Vector *v)
+{
+    if (index == NULL || v == NULL)
+    {
+        return false;
+    }
+    if (index->pendingCount == index->pendingCapacity)
+    {
+        size_t capacity = index->pendingCapacity == 0 ? VECTOR_INDEX_MIN_PENDING : 2 * index->pendingCapacity;
+        const Vector **pending = (const Vector **) realloc((void *) index->pending, capacity * sizeof(Vector *));
+        if (pending == NULL)
+        {
+            return false;
+        }
+        index->pending = pending;
+        index->pendingCapacity = capacity;
+    }
+    if (!insertToRBTree(index->tree, v))
+    {
+        return false;
+    }
+    index->pending[index->pendingCount++] = v;
+    if (index->pendingCount > VECTOR_INDEX_MIN_PENDING &&
+        index->pendingCount * VECTOR_INDEX_PENDING_SHARE > index->nodeCount)
+    {
+        rebuildVectorIndex(index); // on failure the vectors stay pending, and the queries still find them.
+    }
+    return true;
+}
+
+
+/**
+ * find the node of a vector that is in the sub tree of node and was not deleted.
+ * @param found: set to the index of the node.
+ * @return: whether the vector was found.
+ */
+bool findVantage(const VectorIndex *index, size_t node, const Vector *v, size_t *found)
+{
+    const VantageNode *vantage = &index->nodes[node];
+    double distance = vectorDistance(v, vantage->point);
+    if (distance == 0 && !vantage->deleted && vectorCompare1By1(v, vantage->point) == 0)
+    {
+        *found = node;
+        return true;
+    }
+    return (vantage->inside != 0 && distance <= vantage->radius && findVantage(index, vantage->inside, v, found)) ||
+           (vantage->outside != 0 && distance >= vantage->radius && findVantage(index, vantage->outside, v, found));
+}
+
+
+/**
+ * remove a Vector from the tree (which frees it) and from the index: from the pending vectors, or by marking its
+ * node as deleted (with a copy of the vector, which still guides the search).
+ * @param index: the index to remove the vector from.
+ * @param v: the vector to remove.
+ * @return: 0 on failure, other on success. (if the vector is not in the tree - failure).
+ */
+int deleteFromVectorIndex(VectorIndex *index, Vector *v)
+{
+    if (index == NULL || v == NULL || !RBTreeContains(index->tree, v))
+    {
+        return false;
+    }
+    size_t i = 0, node = 0;
+    while (i < index->pendingCount && vectorCompare1By1(index->pending[i], v) != 0)
+    {
+        i++;
+    }
+    if (i < index->pendingCount)
+    {
+        index->pending[i] = index->pending[--index->pendingCount];
+    }
+    else if (index->nodeCount > 0 && findVantage(index, 0, v, &node))
+    {
+        Vector *copy = newContiguousVector(v->len);
+        if (copy == NULL)
+        {
+            return false;
+        }
+        memcpy(copy->vector, v->vector, (size_t) v->len * sizeof(double));
+        index->nodes[node].point = copy;
+        index->nodes[node].deleted = true;
+        index->deletedCount++;
+    }
+    deleteFromRBTree(index->tree, v);
+    if (index->deletedCount * VECTOR_INDEX_DELETED_SHARE > index->nodeCount)
+    {
+        rebuildVectorIndex(index);
+    }
+    return true;
+}
+
+
+/**
+ * the nearest vectors found so far by knnQuery: a max heap by distance, in the arrays of the caller.
+ */
+typedef struct NeighborHeap
+{
+    const Vector **neighbors;
+    double *distances;
+    size_t count, k;
+} NeighborHeap;
+
+
+/**
+ * swap two entries of the heap.
+ */
+void swapNeighbors(NeighborHeap *heap, size_t a, size_t b)
+{
+    const Vector *neighbor = heap->neighbors[a];
+    heap->neighbors[a] = heap->neighbors[b];
+    heap->neighbors[b] = neighbor;
+    double distance = heap->distances[a];
+    heap->distances[a] = heap->distances[b];
+    heap->distances[b] = distance;
+}
+
+
+/**
+ * move the entry at position i of the heap down to its place.
+ */
+void siftNeighborDown(NeighborHeap *heap, size_t i)
+{
+    while (2 * i + 1 < heap->count)
+    {
+        size_t child = 2 * i + 1;
+        if (child + 1 < heap->count && heap->distances[child + 1] > heap->distances[child])
+        {
+            child++;
+        }
+        if (heap->distances[child] <= heap->distances[i])
+        {
+            return;
+        }
+        swapNeighbors(heap, i, child);
+        i = child;
+    }
+}
+
+
+/**
+ * keep a vector if it is nearer than the farthest of the k nearest found so far.
+ */
+void offerNeighbor(NeighborHeap *heap, const Vector *v, double distance)
+{
+    if (heap->count < heap->k)
+    {
+        size_t i = heap->count++;
+        heap->neighbors[i] = v;
+        heap->distances[i] = distance;
+        while (i > 0 && heap->distances[(i - 1) / 2] < heap->distances[i])
+        {
+            swapNeighbors(heap, i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    }
+    else if (distance < heap->distances[0])
+    {
+        heap->neighbors[0] = v;
+        heap->distances[0] = distance;
+        siftNeighborDown(heap, 0);
+    }
+}
+
+
+/**
+ * search the sub tree of node for vectors nearer than the k-th nearest found so far. the child on the side of v
+ * is searched first, and each child only if the ball of the current k-th distance around v reaches its side.
+ */
+void searchNearest(const VectorIndex *index, size_t node, const Vector *v, NeighborHeap *heap)
+{
+    const VantageNode *vantage = &index->nodes[node];
+    double distance = vectorDistance(v, vantage->point);
+    if (!vantage->deleted)
+    {
+        offerNeighbor(heap, vantage->point, distance);
+    }
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        bool inside = (pass == 0) == (distance <= vantage->radius);
+        size_t child = inside ? vantage->inside : vantage->outside;
+        double reach = heap->count < heap->k ? INFINITY : heap->distances[0];
+        if (child != 0 && (inside ? distance - reach <= vantage->radius : distance + reach >= vantage->radius))
+        {
+            searchNearest(index, child, v, heap);
+        }
+    }
+}
+
+
+/**
+ * find the k vectors of the tree that are nearest to v.
+ * @param index: the index to search.
+ * @param v: the vector to search around.
+ * @param k: the number of vectors to find.
+ * @param neighbors: set to the nearest vectors by ascending distance, an array of at least k.
+ * @param distances: set to the distances of the neighbors from v, an array of at least k.
+ * @return: the number of vectors found (less than k if the tree is smaller).
+ */
+size_t knnQuery(const VectorIndex *index, const Vector *v, size_t k, const Vector **neighbors, double *distances)
+{
+    if (index == NULL || v == NULL || neighbors == NULL || distances == NULL || k == 0)
+    {
+        return 0;
+    }
+    NeighborHeap heap = {neighbors, distances, 0, k};
+    for (size_t i = 0; i < index->pendingCount; ++i)
+    {
+        offerNeighbor(&heap, index->pending[i], vectorDistance(v, index->pending[i]));
+    }
+    if (index->nodeCount > 0)
+    {
+        searchNearest(index, 0, v, &heap);
+    }
+    size_t found = heap.count;
+    while (heap.count > 1) // heap sort, the farthest to the end.
+    {
+        swapNeighbors(&heap, 0, --heap.count);
+        siftNeighborDown(&heap, 0);
+    }
+    return found;
+}
+
+
+/**
+ * activate func on the vectors of the sub tree of node whose distance from v is at most r.
+ * @return: false if func failed, true otherwise.
+ */
+bool searchRadius(const VectorIndex *index, size_t node, const Vector *v, double r, forEachFunc func, void *args)
+{
+    const VantageNode *vantage = &index->nodes[node];
+    double distance = vectorDistance(v, vantage->point);
+    if (!vantage->deleted && distance <= r && !func(vantage->point, args))
+    {
+        return false;
+    }
+    if (vantage->inside != 0 && distance - r <= vantage->radius &&
+        !searchRadius(index, vantage->inside, v, r, func, args))
+    {
+        return false;
+    }
+    return vantage->outside == 0 || distance + r < vantage->radius ||
+           searchRadius(index, vantage->outside, v, r, func, args);
+}
+
+
+/**
+ * Activate a function on each vector of the tree whose distance from v is at most r, in no particular order.
+ * if one of the activations of the function returns 0, the process stops.
+ * @param index: the index to search.
+ * @param v: the vector to search around.
+ * @param r: the largest distance from v.
+ * @param func: the function to activate on the vectors.
+ * @param args: more optional arguments to the function.
+ * @return: 0 on failure, other on success.
+ */
+int radiusQuery(const VectorIndex *index, const Vector *v, double r, forEachFunc func, void *args)
+{
+    if (index == NULL || v == NULL || func == NULL)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < index->pendingCount; ++i)
+    {
+        if (vectorDistance(v, index->pending[i]) <= r && !func(index->pending[i], args))
+        {
+            return false;
+        }
+    }
+    return index->nodeCount == 0 || searchRadius(index, 0, v, r, func, args);
+}
+
+
+/**
+ * free the index (not the tree).
+ * @param index: pointer to the index to free.
+ */
+void freeVectorIndex(VectorIndex **index)
+{
+    if (index == NULL || (*index) == NULL)
+    {
+        return;
+    }
+    freeDeletedCopies((*index)->nodes, (*index)->nodeCount);
+    free((*index)->nodes);
+    free((void *) (*index)->pending);
+    free(*index);
+    (*index) = NULL;
+}
@@ -0,0 +1,103 @@
+#ifndef RBTREE_VECTORINDEX_H
+#define RBTREE_VECTORINDEX_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "RBTree.h"
+#include "Structs.h"
+
+/**
+ * the index is rebuilt when the vectors inserted since the last build are more than 1 / VECTOR_INDEX_PENDING_SHARE
+ * of the indexed ones (and more than VECTOR_INDEX_MIN_PENDING), or when the deleted ones are more than
+ * 1 / VECTOR_INDEX_DELETED_SHARE of them.
+ */
+#define VECTOR_INDEX_PENDING_SHARE 8
+#define VECTOR_INDEX_MIN_PENDING 64
+#define VECTOR_INDEX_DELETED_SHARE 4
+
+/*
+ * a node of the vantage point tree: the vectors at distance up to radius from its point are in the sub tree of
+ * inside, the ones at distance radius or more are in the sub tree of outside.
+ */
+typedef struct VantageNode
+{
+	const Vector *point;
+	double radius;
+	size_t inside, outside; // indices of the children in the nodes array, 0 if there is none.
+	bool deleted; // the vector was deleted from the tree, point is a copy owned by the index.
+} VantageNode;
+
+/**
+ * a spatial index of the Vectors of an RBTree by their L2 distance (a vector that is shorter than another is
+ * taken as padded with zeros), for nearest neighbour and radius queries. the vectors are kept in a vantage point
+ * tree, built in O(n log n) distances, whose queries skip the sub trees that the triangle inequality rules out.
+ * inserts go to a list of pending vectors that the queries scan, and deletes mark their node (which still guides
+ * the search); the tree is rebuilt from the RBTree when there are too many of either (see
+ * VECTOR_INDEX_PENDING_SHARE). the items of the RBTree must be changed only through the index.
+ */
+typedef struct VectorIndex
+{
+	RBTree *tree;
+	VantageNode *nodes; // nodes[0] is the root.
+	size_t nodeCount;
+	size_t deletedCount;
+	const Vector **pending;
+	size_t pendingCount, pendingCapacity;
+	unsigned int seed; // chooses the vantage points.
+} VectorIndex;
+
+/**
+ * @return: the L2 distance between two vectors, the shorter one padded with zeros.
+ */
+double vectorDistance(const Vector *a, const Vector *b);
+
+/**
+ * constructs a new index of the Vectors of a tree, in O(n log n) distances.
+ * @param tree: a tree of Vectors (see vectorCompare1By1), not owned by the index.
+ * @return: the new index, NULL on failure.
+ */
+VectorIndex *newVectorIndex(RBTree *tree);
+
+/**
+ * add a Vector to the tree and to the index.
+ * @return: 0 on failure, other on success. (if the vector is already in the tree - failure).
+ */
+int insertToVectorIndex(VectorIndex *index, Vector *v);
+
+/**
+ * remove a Vector from the tree (which frees it) and from the index.
+ * @return: 0 on failure, other on success. (if the vector is not in the tree - failure).
+ */
+int deleteFromVectorIndex(VectorIndex *index, Vector *v);
+
+/**
+ * find the k vectors of the tree that are nearest to v.
+ * @param index: the index to search.
+ * @param v: the vector to search around.
+ * @param k: the number of vectors to find.
+ * @param neighbors: set to the nearest vectors by ascending distance, an array of at least k.
+ * @param distances: set to the distances of the neighbors from v, an array of at least k.
+ * @return: the number of vectors found (less than k if the tree is smaller).
+ */
+size_t knnQuery(const VectorIndex *index, const Vector *v, size_t k, const Vector **neighbors, double *distances);
+
+/**
+ * Activate a function on each vector of the tree whose distance from v is at most r, in no particular order.
+ * if one of the activations of the function returns 0, the process stops.
+ * @return: 0 on failure, other on success.
+ */
+int radiusQuery(const VectorIndex *index, const Vector *v, double r, forEachFunc func, void *args);
+
+/**
+ * build the index again from the vectors of the tree, in O(n log n) distances.
+ * @return: 0 on failure (the index is not changed), other on success.
+ */
+int rebuildVectorIndex(VectorIndex *index);
+
+/**
+ * free the index (not the tree).
+ * @param index: pointer to the index to free.
+ */
+void freeVectorIndex(VectorIndex **index);
+
+#endif //RBTREE_VECTORINDEX_H
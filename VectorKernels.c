@@ -0,0 +1,256 @@
+#include <stdbool.h>
+#include "VectorKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * pointer to a firstDifference kernel.
+ */
+typedef size_t (*FirstDifferenceKernel)(const double *a, const double *b, size_t n);
+
+/**
+ * pointer to a sumOfSquares kernel.
+ */
+typedef long double (*SumOfSquaresKernel)(const double *v, size_t n);
+
+/**
+ * the kernels chosen for this CPU, NULL until the first call.
+ */
+FirstDifferenceKernel firstDifferenceKernel = NULL;
+SumOfSquaresKernel sumOfSquaresKernel = NULL;
+const char *kernelsName = "scalar";
+
+
+/**
+ * firstDifference with a plain loop, one element at a time.
+ */
+size_t firstDifferenceScalar(const double *a, const double *b, size_t n)
+{
+    size_t i = 0;
+    while (i < n && a[i] == b[i])
+    {
+        i++;
+    }
+    return i;
+}
+
+
+/**
+ * sumOfSquares with a plain loop in long double, one element at a time.
+ */
+long double sumOfSquaresScalar(const double *v, size_t n)
+{
+    long double sum = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        sum += v[i] * v[i];
+    }
+    return sum;
+}
+
+
+#ifdef VECTOR_KERNELS_X86
+/**
+ * firstDifference with SSE2, 2 elements at a time.
+ */
+__attribute__((target("sse2")))
+size_t firstDifferenceSse2(const double *a, const double *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        int mask = _mm_movemask_pd(_mm_cmpneq_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        if (mask != 0)
+        {
+            return i + (size_t) __builtin_ctz((unsigned int) mask);
+        }
+    }
+    return i + firstDifferenceScalar(a + i, b + i, n - i);
+}
+
+
+/**
+ * sumOfSquares with SSE2, with two accumulators of 2 elements.
+ */
+__attribute__((target("sse2")))
+long double sumOfSquaresSse2(const double *v, size_t n)
+{
+    __m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128d x0 = _mm_loadu_pd(v + i), x1 = _mm_loadu_pd(v + i + 2);
+        sum0 = _mm_add_pd(sum0, _mm_mul_pd(x0, x0));
+        sum1 = _mm_add_pd(sum1, _mm_mul_pd(x1, x1));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(sum0, sum1));
+    return (long double) lanes[0] + lanes[1] + sumOfSquaresScalar(v + i, n - i);
+}
+
+
+/**
+ * firstDifference with AVX2, 8 elements at a time.
+ */
+__attribute__((target("avx2")))
+size_t firstDifferenceAvx2(const double *a, const double *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256d low = _mm256_cmp_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _CMP_NEQ_UQ);
+        __m256d high = _mm256_cmp_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), _CMP_NEQ_UQ);
+        int mask = _mm256_movemask_pd(low) | (_mm256_movemask_pd(high) << 4);
+        if (mask != 0)
+        {
+            return i + (size_t) __builtin_ctz((unsigned int) mask);
+        }
+    }
+    return i + firstDifferenceSse2(a + i, b + i, n - i);
+}
+
+
+/**
+ * sumOfSquares with AVX2, with two accumulators of 4 elements.
+ */
+__attribute__((target("avx2,fma")))
+long double sumOfSquaresAvx2(const double *v, size_t n)
+{
+    __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256d x0 = _mm256_loadu_pd(v + i), x1 = _mm256_loadu_pd(v + i + 4);
+        sum0 = _mm256_fmadd_pd(x0, x0, sum0);
+        sum1 = _mm256_fmadd_pd(x1, x1, sum1);
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(sum0, sum1));
+    return (long double) lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumOfSquaresScalar(v + i, n - i);
+}
+
+
+/**
+ * firstDifference with AVX-512, 16 elements at a time.
+ */
+__attribute__((target("avx512f")))
+size_t firstDifferenceAvx512(const double *a, const double *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        unsigned int low = _mm512_cmp_pd_mask(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), _CMP_NEQ_UQ);
+        unsigned int high = _mm512_cmp_pd_mask(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), _CMP_NEQ_UQ);
+        unsigned int mask = low | (high << 8);
+        if (mask != 0)
+        {
+            return i + (size_t) __builtin_ctz(mask);
+        }
+    }
+    return i + firstDifferenceAvx2(a + i, b + i, n - i);
+}
+
+
+/**
+ * sumOfSquares with AVX-512, with two accumulators of 8 elements.
+ */
+__attribute__((target("avx512f")))
+long double sumOfSquaresAvx512(const double *v, size_t n)
+{
+    __m512d sum0 = _mm512_setzero_pd(), sum1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512d x0 = _mm512_loadu_pd(v + i), x1 = _mm512_loadu_pd(v + i + 8);
+        sum0 = _mm512_fmadd_pd(x0, x0, sum0);
+        sum1 = _mm512_fmadd_pd(x1, x1, sum1);
+    }
+    return (long double) _mm512_reduce_add_pd(_mm512_add_pd(sum0, sum1)) + sumOfSquaresScalar(v + i, n - i);
+}
+#endif
+
+
+/**
+ * choose the kernels for the CPU the program runs on. threads that call it together choose the same ones.
+ */
+void chooseKernels(void)
+{
+    FirstDifferenceKernel compare = firstDifferenceScalar;
+    SumOfSquaresKernel norm = sumOfSquaresScalar;
+    const char *name = "scalar";
+#ifdef VECTOR_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        compare = firstDifferenceAvx512;
+        norm = sumOfSquaresAvx512;
+        name = "avx512";
+    }
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        compare = firstDifferenceAvx2;
+        norm = sumOfSquaresAvx2;
+        name = "avx2";
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        compare = firstDifferenceSse2;
+        norm = sumOfSquaresSse2;
+        name = "sse2";
+    }
+#endif
+    __atomic_store_n(&kernelsName, name, __ATOMIC_RELAXED);
+    __atomic_store_n(&sumOfSquaresKernel, norm, __ATOMIC_RELAXED);
+    __atomic_store_n(&firstDifferenceKernel, compare, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * find the first element where a and b differ (as by !=, so a NaN differs from everything).
+ * @param a, b: arrays of at least n elements.
+ * @param n: number of elements to compare.
+ * @return: the index of the first element that differs, n if there is none.
+ */
+size_t firstDifference(const double *a, const double *b, size_t n)
+{
+    FirstDifferenceKernel kernel = __atomic_load_n(&firstDifferenceKernel, __ATOMIC_RELAXED);
+    if (kernel == NULL)
+    {
+        chooseKernels();
+        kernel = __atomic_load_n(&firstDifferenceKernel, __ATOMIC_RELAXED);
+    }
+    return kernel(a, b, n);
+}
+
+
+/**
+ * @param v: an array of at least n elements.
+ * @param n: number of elements.
+ * @return: the sum of the squares of the elements.
+ */
+long double sumOfSquares(const double *v, size_t n)
+{
+    SumOfSquaresKernel kernel = __atomic_load_n(&sumOfSquaresKernel, __ATOMIC_RELAXED);
+    if (kernel == NULL)
+    {
+        chooseKernels();
+        kernel = __atomic_load_n(&sumOfSquaresKernel, __ATOMIC_RELAXED);
+    }
+    return kernel(v, n);
+}
+
+
+/**
+ * @return: the name of the instruction set the kernels use on this CPU.
+ */
+const char *vectorKernelsName(void)
+{
+    if (__atomic_load_n(&firstDifferenceKernel, __ATOMIC_ACQUIRE) == NULL)
+    {
+        chooseKernels();
+    }
+    return __atomic_load_n(&kernelsName, __ATOMIC_RELAXED);
+}
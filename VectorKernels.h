@@ -0,0 +1,41 @@
+#ifndef RBTREE_VECTORKERNELS_H
+#define RBTREE_VECTORKERNELS_H
+
+#include <stddef.h>
+
+// the loops over the elements of a Vector, vectorized with SSE2, AVX2 or AVX-512 on x86 (chosen at runtime by
+// the features of the CPU) and plain loops elsewhere. the vectorized compare gives exactly the result of the
+// plain one; the vectorized sum of squares adds in a different order, so it may differ in the last bits.
+
+/**
+ * find the first element where a and b differ (as by !=, so a NaN differs from everything).
+ * @param a, b: arrays of at least n elements.
+ * @param n: number of elements to compare.
+ * @return: the index of the first element that differs, n if there is none.
+ */
+size_t firstDifference(const double *a, const double *b, size_t n);
+
+/**
+ * @param v: an array of at least n elements.
+ * @param n: number of elements.
+ * @return: the sum of the squares of the elements.
+ */
+long double sumOfSquares(const double *v, size_t n);
+
+/**
+ * firstDifference with a plain loop, one element at a time.
+ */
+size_t firstDifferenceScalar(const double *a, const double *b, size_t n);
+
+/**
+ * sumOfSquares with a plain loop in long double, one element at a time.
+ */
+long double sumOfSquaresScalar(const double *v, size_t n);
+
+/**
+ * @return: the name of the instruction set the kernels use on this CPU ("avx512", "avx2", "sse2" or
+ * "scalar").
+ */
+const char *vectorKernelsName(void);
+
+#endif //RBTREE_VECTORKERNELS_H